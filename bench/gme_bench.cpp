@@ -0,0 +1,522 @@
+// Renders every track of a corpus of music files at several sample rates and
+// reports speed, memory use, and a hash of the output, one tab-separated line
+// per track and rate.
+//
+// usage: gme_bench [options] <file or directory> ...
+//   -s secs    seconds to render of each track (default 30)
+//   -r rates   comma-separated sample rates (default 32000,44100,48000,96000)
+//   -t count   render at most count tracks of each file (default all)
+//   -f msec    limit emulation frames to msec with gme_set_frame_length()
+//   -q levels  comma-separated synthesis qualities for gme_set_quality(), where
+//              0 = fast and 1 = full (default 1)
+//   -e depth   enable effects with gme_set_stereo_depth( depth ), for measuring
+//              their cost and memory use
+//   -i level   SPC/SFM interpolation level, where -2 = nearest, -1 = linear,
+//              0 = gaussian (default), 1 = cubic, and 2 = sinc
+//   -k msec    seek to msec with gme_seek() before rendering, for checking
+//              that output after a seek matches
+//   -w file    write output hashes to file
+//   -c file    compare output hashes with those in file, and exit with status 1
+//              if any differ
+//   -p         add time spent in each stage (library must be built with
+//              GME_PROFILE)
+//
+// Synthesis quality is chosen at run time with -q, so "-q 0,1" shows the speed
+// difference between levels. GME_SPC_FAST_RESAMPLER, GME_VGM_FAST_RESAMPLER, and
+// BLIP_BUFFER_FAST are compile-time options, so build the library and gme_bench
+// with the same flags for each configuration to be measured. The config column
+// shows the flags gme_bench was built with.
+
+// Game_Music_Emu $vers
+
+#include "gme.h"
+#include "blargg_config.h"
+#include "Spc_Emu.h"
+#include "Spc_Sfm.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+	#include <windows.h>
+	#include <psapi.h>
+#else
+	#include <dirent.h>
+	#include <sys/stat.h>
+	#include <sys/resource.h>
+#endif
+
+#if defined (__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+	#include <malloc.h>
+	#define HAVE_MALLINFO2 1
+#endif
+
+/* This module is free software; you can redistribute it and/or modify it
+under the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation; either version 2.1 of the License, or (at your
+option) any later version. This module is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General
+Public License for more details. You should have received a copy of the GNU
+Lesser General Public License along with this module; if not, write to the
+Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+02110-1301 USA */
+
+using std::string;
+using std::vector;
+
+static const char* build_config()
+{
+	return ""
+	#if GME_SPC_FAST_RESAMPLER
+		"spc_fast "
+	#endif
+	#if GME_VGM_FAST_RESAMPLER
+		"vgm_fast "
+	#endif
+	#if BLIP_BUFFER_FAST
+		"blip_fast "
+	#endif
+		"";
+}
+
+// Peak resident set size of process, in kilobytes, or -1 if unknown
+static long peak_rss_kb()
+{
+	#ifdef _WIN32
+		PROCESS_MEMORY_COUNTERS pmc;
+		if ( GetProcessMemoryInfo( GetCurrentProcess(), &pmc, sizeof pmc ) )
+			return (long) (pmc.PeakWorkingSetSize / 1024);
+		return -1;
+	#else
+		struct rusage usage;
+		if ( getrusage( RUSAGE_SELF, &usage ) )
+			return -1;
+		#ifdef __APPLE__
+			return (long) (usage.ru_maxrss / 1024); // bytes on Mac OS
+		#else
+			return (long) usage.ru_maxrss;
+		#endif
+	#endif
+}
+
+// Bytes currently allocated from heap, or -1 if unknown
+static long heap_in_use()
+{
+	#if HAVE_MALLINFO2
+		struct mallinfo2 info = mallinfo2();
+		return (long) (info.uordblks + info.hblkhd); // large blocks are mmap()ed
+	#else
+		return -1;
+	#endif
+}
+
+static double now_sec()
+{
+	return std::chrono::duration<double>(
+			std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+// FNV-1a of samples, as little-endian 16-bit values
+static unsigned long hash_samples( unsigned long hash, short const in [], int count )
+{
+	for ( int i = 0; i < count; i++ )
+	{
+		hash = ((hash ^ (in [i] & 0xFF)) * 16777619) & 0xFFFFFFFF;
+		hash = ((hash ^ (in [i] >> 8 & 0xFF)) * 16777619) & 0xFFFFFFFF;
+	}
+	return hash;
+}
+
+static bool is_dir( const char path [] )
+{
+	#ifdef _WIN32
+		DWORD attr = GetFileAttributesA( path );
+		return attr != INVALID_FILE_ATTRIBUTES && (attr & FILE_ATTRIBUTE_DIRECTORY);
+	#else
+		struct stat st;
+		return !stat( path, &st ) && S_ISDIR( st.st_mode );
+	#endif
+}
+
+// Adds music files in dir and its subdirectories to out
+static void find_files( string const& dir, vector<string>& out )
+{
+	vector<string> names;
+	#ifdef _WIN32
+		WIN32_FIND_DATAA fd;
+		HANDLE h = FindFirstFileA( (dir + "\\*").c_str(), &fd );
+		if ( h == INVALID_HANDLE_VALUE )
+			return;
+		do
+			names.push_back( fd.cFileName );
+		while ( FindNextFileA( h, &fd ) );
+		FindClose( h );
+		char const sep = '\\';
+	#else
+		DIR* d = opendir( dir.c_str() );
+		if ( !d )
+			return;
+		while ( struct dirent* e = readdir( d ) )
+			names.push_back( e->d_name );
+		closedir( d );
+		char const sep = '/';
+	#endif
+
+	// sort so that output order doesn't depend on file system
+	std::sort( names.begin(), names.end() );
+	for ( size_t i = 0; i < names.size(); i++ )
+	{
+		if ( names [i] [0] == '.' )
+			continue;
+
+		string path = dir + sep + names [i];
+		if ( is_dir( path.c_str() ) )
+		{
+			find_files( path, out );
+		}
+		else
+		{
+			gme_type_t type = 0;
+			if ( !gme_identify_file( path.c_str(), &type ) && type )
+				out.push_back( path );
+		}
+	}
+}
+
+struct options_t
+{
+	int seconds;
+	int max_tracks;
+	int frame_length;
+	double stereo_depth; // negative if effects aren't enabled
+	int interpolation;
+	int seek_msec; // 0 to start at beginning
+	bool profile;
+	vector<int> rates;
+	vector<int> qualities;
+};
+
+typedef std::map<string,string> hashes_t;
+
+// Full quality keys have no quality field, so they match hash files written
+// before it was added. Likewise for stereo depth, interpolation, and seek.
+static string hash_key( string const& path, int track, int rate, int seconds, int quality,
+		double stereo_depth, int interpolation, int seek_msec )
+{
+	char str [96];
+	sprintf( str, "\t%d\t%d\t%d", track, rate, seconds );
+	if ( quality != gme_quality_full )
+		sprintf( str + strlen( str ), "\tq%d", quality );
+	if ( stereo_depth >= 0 )
+		sprintf( str + strlen( str ), "\te%g", stereo_depth );
+	if ( interpolation )
+		sprintf( str + strlen( str ), "\ti%d", interpolation );
+	if ( seek_msec )
+		sprintf( str + strlen( str ), "\tk%d", seek_msec );
+	return path + str;
+}
+
+// Hash file has one "hash<TAB>path<TAB>track<TAB>rate<TAB>seconds[<TAB>qN][<TAB>eD][<TAB>iN][<TAB>kN]"
+// line per track, where qN is present for qualities other than full, eD when
+// effects are enabled, iN for interpolation other than gaussian, and kN when
+// rendering starts after a seek
+static bool read_hashes( const char path [], hashes_t& out )
+{
+	FILE* in = fopen( path, "r" );
+	if ( !in )
+		return false;
+
+	char line [4096];
+	while ( fgets( line, sizeof line, in ) )
+	{
+		line [strcspn( line, "\r\n" )] = 0;
+		char* tab = strchr( line, '\t' );
+		if ( tab )
+			out [tab + 1] = string( line, tab );
+	}
+	fclose( in );
+	return true;
+}
+
+struct totals_t
+{
+	int renders;
+	int errors;
+	int mismatches;
+	int missing;
+};
+
+// Sets SPC DSP interpolation level, which is only available through the C++
+// interface. Other types are unaffected.
+static void set_interpolation( gme_t* emu, int level )
+{
+	gme_type_t type = gme_type( emu );
+	if ( type == gme_spc_type )
+		static_cast<Spc_Emu*>( emu )->interpolation_level( level );
+	else if ( type == gme_sfm_type )
+		static_cast<Sfm_Emu*>( emu )->interpolation_level( level );
+}
+
+// Renders track of file at rate and quality and writes one line of results to stdout
+static void bench_track( string const& path, int track, int rate, int quality,
+		options_t const& opt, hashes_t const* expected, FILE* hashes_out, totals_t& totals )
+{
+	long heap_before = heap_in_use();
+
+	gme_t* emu = NULL;
+	gme_err_t err = gme_open_file( path.c_str(), &emu, rate );
+	if ( !err )
+	{
+		// don't let silence end track early, so that every track renders same
+		// amount of sound
+		gme_ignore_silence( emu, 1 );
+		gme_set_quality( emu, quality );
+		gme_set_frame_length( emu, opt.frame_length );
+		if ( opt.stereo_depth >= 0 )
+			gme_set_stereo_depth( emu, opt.stereo_depth );
+		set_interpolation( emu, opt.interpolation );
+		err = gme_start_track( emu, track );
+		if ( !err && opt.seek_msec )
+			err = gme_seek( emu, opt.seek_msec );
+	}
+	if ( err )
+	{
+		totals.errors++;
+		fprintf( stderr, "%s: track %d: %s\n", path.c_str(), track + 1, err );
+		gme_delete( emu );
+		return;
+	}
+	long instance_bytes = (heap_before < 0 ? -1 : heap_in_use() - heap_before);
+
+	enum { buf_size = 2048 };
+	short buf [buf_size];
+	long remain = (long) opt.seconds * rate * 2;
+	unsigned long hash = 2166136261UL;
+	gme_reset_profile( emu );
+	double start = now_sec();
+	while ( remain > 0 && !err )
+	{
+		int n = (remain < buf_size ? (int) remain : (int) buf_size);
+		err = gme_play( emu, n, buf );
+		hash = hash_samples( hash, buf, n );
+		remain -= n;
+	}
+	double elapsed = now_sec() - start;
+	if ( err )
+	{
+		totals.errors++;
+		fprintf( stderr, "%s: track %d: %s\n", path.c_str(), track + 1, err );
+	}
+
+	char hash_str [16];
+	sprintf( hash_str, "%08lx", hash );
+	string key = hash_key( path, track + 1, rate, opt.seconds, quality, opt.stereo_depth,
+			opt.interpolation, opt.seek_msec );
+
+	const char* match = "-";
+	if ( expected )
+	{
+		hashes_t::const_iterator it = expected->find( key );
+		if ( it == expected->end() )
+		{
+			match = "missing";
+			totals.missing++;
+		}
+		else if ( it->second != hash_str )
+		{
+			match = "DIFFERENT";
+			totals.mismatches++;
+			fprintf( stderr, "%s: track %d at %d Hz: output differs\n",
+					path.c_str(), track + 1, rate );
+		}
+		else
+		{
+			match = "same";
+		}
+	}
+
+	if ( hashes_out )
+		fprintf( hashes_out, "%s\t%s\n", hash_str, key.c_str() );
+
+	gme_type_t type = gme_type( emu );
+	printf( "%s\t%s\t%d\t%d\t%d\t%d\t%.4f\t%.2f\t%ld\t%ld\t%s\t%s",
+			path.c_str(), gme_type_extension( type ), track + 1, rate, quality, opt.seconds,
+			elapsed, (elapsed > 0 ? opt.seconds / elapsed : 0.0),
+			instance_bytes, peak_rss_kb(), hash_str, match );
+
+	if ( opt.profile )
+	{
+		gme_profile_t profile;
+		bool have_profile = !gme_get_profile( emu, &profile );
+		for ( int i = 0; i < gme_profile_stage_count; i++ )
+			printf( "\t%.0f", have_profile ? profile.stages [i].nsec / 1000 : -1.0 );
+	}
+	printf( "\n" );
+	fflush( stdout );
+
+	totals.renders++;
+	gme_delete( emu );
+}
+
+static void bench_file( string const& path, options_t const& opt, hashes_t const* expected,
+		FILE* hashes_out, totals_t& totals )
+{
+	gme_t* info = NULL;
+	gme_err_t err = gme_open_file( path.c_str(), &info, gme_info_only );
+	if ( err )
+	{
+		totals.errors++;
+		fprintf( stderr, "%s: %s\n", path.c_str(), err );
+		return;
+	}
+	int track_count = gme_track_count( info );
+	gme_delete( info );
+
+	if ( opt.max_tracks && track_count > opt.max_tracks )
+		track_count = opt.max_tracks;
+
+	for ( int track = 0; track < track_count; track++ )
+		for ( size_t i = 0; i < opt.rates.size(); i++ )
+			for ( size_t q = 0; q < opt.qualities.size(); q++ )
+				bench_track( path, track, opt.rates [i], opt.qualities [q], opt,
+						expected, hashes_out, totals );
+}
+
+// Appends comma-separated integers in str to out
+static void parse_list( const char str [], vector<int>& out )
+{
+	for ( const char* p = str; *p; )
+	{
+		out.push_back( atoi( p ) );
+		p += strcspn( p, "," );
+		if ( *p )
+			p++;
+	}
+}
+
+static void usage()
+{
+	fprintf( stderr,
+		"usage: gme_bench [-s secs] [-r rates] [-q levels] [-e depth] [-i level]\n"
+		"                 [-k msec] [-f msec] [-t tracks] [-w hashes] [-c hashes] [-p] <file or directory> ...\n" );
+	exit( EXIT_FAILURE );
+}
+
+int main( int argc, char** argv )
+{
+	options_t opt;
+	opt.seconds    = 30;
+	opt.max_tracks = 0;
+	opt.frame_length = 0;
+	opt.stereo_depth = -1.0;
+	opt.interpolation = 0;
+	opt.seek_msec = 0;
+	opt.profile    = false;
+	const char* write_path   = NULL;
+	const char* compare_path = NULL;
+
+	vector<string> files;
+	for ( int i = 1; i < argc; i++ )
+	{
+		const char* arg = argv [i];
+		if ( arg [0] == '-' && arg [1] && !arg [2] )
+		{
+			if ( arg [1] == 'p' )
+			{
+				opt.profile = true;
+				continue;
+			}
+
+			if ( ++i >= argc )
+				usage();
+			const char* value = argv [i];
+			switch ( arg [1] )
+			{
+			case 's': opt.seconds    = atoi( value ); break;
+			case 't': opt.max_tracks = atoi( value ); break;
+			case 'f': opt.frame_length = atoi( value ); break;
+			case 'w': write_path     = value; break;
+			case 'c': compare_path   = value; break;
+			case 'r': parse_list( value, opt.rates ); break;
+			case 'q': parse_list( value, opt.qualities ); break;
+			case 'e': opt.stereo_depth = atof( value ); break;
+			case 'i': opt.interpolation = atoi( value ); break;
+			case 'k': opt.seek_msec = atoi( value ); break;
+			default:
+				usage();
+			}
+		}
+		else if ( is_dir( arg ) )
+		{
+			find_files( arg, files );
+		}
+		else
+		{
+			files.push_back( arg );
+		}
+	}
+
+	if ( opt.rates.empty() )
+	{
+		static int const default_rates [] = { 32000, 44100, 48000, 96000 };
+		opt.rates.assign( default_rates, default_rates + 4 );
+	}
+	if ( opt.qualities.empty() )
+		opt.qualities.push_back( gme_quality_full );
+	if ( files.empty() || opt.seconds <= 0 )
+		usage();
+
+	hashes_t expected;
+	if ( compare_path && !read_hashes( compare_path, expected ) )
+	{
+		fprintf( stderr, "Couldn't read %s\n", compare_path );
+		return EXIT_FAILURE;
+	}
+
+	FILE* hashes_out = NULL;
+	if ( write_path && !(hashes_out = fopen( write_path, "w" )) )
+	{
+		fprintf( stderr, "Couldn't write %s\n", write_path );
+		return EXIT_FAILURE;
+	}
+
+	printf( "# config: %s\n", *build_config() ? build_config() : "default" );
+	if ( opt.stereo_depth >= 0 )
+		printf( "# stereo depth: %g\n", opt.stereo_depth );
+	if ( opt.interpolation )
+		printf( "# spc interpolation: %d\n", opt.interpolation );
+	if ( opt.seek_msec )
+		printf( "# seek: %d msec\n", opt.seek_msec );
+	printf( "file\ttype\ttrack\trate\tquality\tseconds\trender_sec\trealtime_factor"
+			"\tinstance_bytes\tpeak_rss_kb\thash\tmatch" );
+	if ( opt.profile )
+	{
+		static const char* const stage_names [gme_profile_stage_count] = {
+			"emulate_us", "buffer_us", "effects_us", "resample_us", "filter_us", "track_us"
+		};
+		for ( int i = 0; i < gme_profile_stage_count; i++ )
+			printf( "\t%s", stage_names [i] );
+	}
+	printf( "\n" );
+
+	totals_t totals = { 0, 0, 0, 0 };
+	for ( size_t i = 0; i < files.size(); i++ )
+		bench_file( files [i], opt, (compare_path ? &expected : NULL), hashes_out, totals );
+
+	if ( hashes_out )
+		fclose( hashes_out );
+
+	fprintf( stderr, "%d renders, %d errors", totals.renders, totals.errors );
+	if ( compare_path )
+		fprintf( stderr, ", %d different, %d missing", totals.mismatches, totals.missing );
+	fprintf( stderr, "\n" );
+
+	return (totals.mismatches || totals.errors) ? EXIT_FAILURE : 0;
+}
@@ -2,6 +2,8 @@
 
 #include "Ay_Apu.h"
 
+#include "State_Copier.h"
+
 /* Copyright (C) 2006-2008 Shay Green. This module is free software; you
 can redistribute it and/or modify it under the terms of the GNU Lesser
 General Public License as published by the Free Software Foundation; either
@@ -123,6 +125,31 @@ void Ay_Apu::reset()
 	write_data_( 13, 0 );
 }
 
+void Ay_Apu::copy_state( State_Copier& copier )
+{
+	for ( int i = 0; i < osc_count; i++ )
+	{
+		osc_t& osc = oscs [i];
+		copier.copy( osc.period );
+		copier.copy( osc.delay );
+		copier.copy( osc.last_amp );
+		copier.copy( osc.phase );
+	}
+	copier.copy( last_time );
+	copier.copy( addr_ );
+	copier.copy( regs );
+	copier.copy( noise_delay );
+	copier.copy( noise_lfsr );
+	copier.copy( env_delay );
+	int env_mode = (int) (env_wave - env_modes [0]) / (int) sizeof env_modes [0];
+	copier.copy( env_mode );
+	if ( (unsigned) env_mode >= 8 )
+		copier.set_error( BLARGG_ERR( BLARGG_ERR_FILE_CORRUPT, "state" ) );
+	else
+		env_wave = env_modes [env_mode];
+	copier.copy( env_pos );
+}
+
 int Ay_Apu::read()
 {
 	static byte const masks [reg_count] = { 
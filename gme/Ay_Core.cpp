@@ -2,6 +2,8 @@
 
 #include "Ay_Core.h"
 
+#include "State_Copier.h"
+
 /* Copyright (C) 2006-2009 Shay Green. This module is free software; you
 can redistribute it and/or modify it under the terms of the GNU Lesser
 General Public License as published by the Free Software Foundation; either
@@ -134,6 +136,22 @@ int Ay_Core::cpu_in( addr_t addr )
 	return 0xFF;
 }
 
+void Ay_Core::copy_state( State_Copier& copier )
+{
+	copier.add_block( &mem_, sizeof mem_ );
+	cpu.copy_state( copier );
+	copier.copy( mem_ );
+	copier.copy( beeper_delta );
+	copier.copy( last_beeper );
+	copier.copy( beeper_mask );
+	copier.copy( play_addr );
+	copier.copy( next_play );
+	copier.copy( cpc_latch );
+	copier.copy( spectrum_mode );
+	copier.copy( cpc_mode );
+	apu_.copy_state( copier );
+}
+
 void Ay_Core::end_frame( time_t* end )
 {
 	cpu.set_time( 0 );
@@ -39,6 +39,9 @@ public:
 	// emulated. Until Spectrum/CPC mode is determined, *end is HALVED.
 	void end_frame( time_t* end );
 	
+	// Saves/loads CPU, memory, and sound chip state. Must be called between frames.
+	void copy_state( State_Copier& );
+	
 	// Called when CPC hardware is first accessed. AY file format doesn't specify
 	// which sound hardware is used, so it must be determined during playback
 	// based on which sound port is first used.
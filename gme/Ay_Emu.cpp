@@ -2,6 +2,8 @@
 
 #include "Ay_Emu.h"
 
+#include "State_Copier.h"
+
 #include "blargg_endian.h"
 
 /* Copyright (C) 2006-2009 Shay Green. This module is free software; you
@@ -319,7 +321,7 @@ blargg_err_t Ay_Emu::start_track_( int track )
 	
 	// start at spectrum speed
 	change_clock_rate( spectrum_clock );
-	set_tempo( tempo() );
+	set_tempo_( tempo() );
 	
 	Ay_Core::registers_t r = { };
 	r.sp = get_be16( more_data );
@@ -333,6 +335,23 @@ blargg_err_t Ay_Emu::start_track_( int track )
 	return blargg_ok;
 }
 
+blargg_err_t Ay_Emu::copy_state_( State_Copier& copier )
+{
+	copier.tag( BLARGG_4CHAR('A','Y','s',' ') );
+	core.copy_state( copier );
+	
+	// CPC mode changes clock rate
+	int rate = clock_rate();
+	copier.copy( rate );
+	if ( copier.loading() && rate != clock_rate() )
+	{
+		change_clock_rate( rate );
+		set_tempo_( tempo() );
+	}
+	
+	return copy_buffer_state( copier );
+}
+
 blargg_err_t Ay_Emu::run_clocks( blip_time_t& duration, int )
 {
 	core.end_frame( &duration );
@@ -342,7 +361,7 @@ blargg_err_t Ay_Emu::run_clocks( blip_time_t& duration, int )
 inline void Ay_Emu::enable_cpc()
 {
 	change_clock_rate( cpc_clock );
-	set_tempo( tempo() );
+	set_tempo_( tempo() );
 }
 
 void Ay_Emu::enable_cpc_( void* data )
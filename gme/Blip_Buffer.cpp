@@ -2,6 +2,7 @@
 
 #include "Blip_Buffer.h"
 
+#include "State_Copier.h"
 #include <math.h>
 
 /* Copyright (C) 2003-2008 Shay Green. This module is free software; you
@@ -139,6 +140,13 @@ blip_time_t Blip_Buffer::count_clocks( int count ) const
 	return (blip_time_t) ((time - offset_ + factor_ - 1) / factor_);
 }
 
+void Blip_Buffer::sync_time( Blip_Buffer const& other )
+{
+	assert( !offset_ && !reader_accum_ ); // must be cleared
+	assert( factor_ == other.factor_ && buffer_size_ == other.buffer_size_ );
+	offset_ = other.offset_;
+}
+
 void Blip_Buffer::remove_samples( int count )
 {
 	if ( count )
@@ -238,6 +246,20 @@ void Blip_Buffer::load_state( blip_buffer_state_t const& in )
 	memcpy( buffer_, in.buf, sizeof in.buf );
 }
 
+void Blip_Buffer::copy_state( State_Copier& copier )
+{
+	if ( copier.loading() )
+		clear();
+	
+	copier.copy( offset_ );
+	copier.copy( reader_accum_ );
+	copier.copy( modified_ );
+	
+	// unread samples and tails of last deltas
+	copier.copy_var( buffer_, (samples_avail() + blip_buffer_extra_) * sizeof *buffer_,
+			(buffer_size_ + blip_buffer_extra_) * sizeof *buffer_ );
+}
+
 
 //// Blip_Synth_
 
@@ -268,6 +290,7 @@ Blip_Synth_::Blip_Synth_( short p [], int w ) :
 	buf          = NULL;
 	last_amp     = 0;
 	delta_factor = 0;
+	fast_delta_factor = 0;
 }
 
 #undef PI
@@ -473,6 +496,8 @@ void Blip_Synth_::rescale_kernel( int shift )
 
 void Blip_Synth_::volume_unit( double new_unit )
 {
+	fast_delta_factor = int (new_unit * (1 << blip_sample_bits) + 0.5);
+	
 	if ( volume_unit_ != new_unit )
 	{
 		// use default eq if it hasn't been set yet
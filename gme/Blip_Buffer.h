@@ -9,7 +9,11 @@
 
 typedef int blip_time_t;                    // Source clocks in current time frame
 typedef BOOST::int16_t blip_sample_t;       // 16-bit signed output sample
+typedef int blip_wide_sample_t;             // Same scale, but not clamped to 16 bits
 int const blip_default_length = 1000 / 4;   // Default Blip_Buffer length (1/4 second)
+int const blip_synth_fast = 0;              // Linear interpolation, faster but allows aliasing
+int const blip_synth_full = 1;              // Full band-limited synthesis (default)
+class State_Copier;
 
 
 //// Sample buffer for band-limited synthesis
@@ -48,6 +52,7 @@ public:
 	
 	// Sets high-pass filter frequency, from 0 to 20000 Hz, where higher values reduce bass more
 	void bass_freq( int frequency );
+	
 
 	int length() const;         // Length of buffer in milliseconds
 	int sample_rate() const;    // Current output sample rate
@@ -69,6 +74,11 @@ public:
 	
 	// Mixes n samples into buffer
 	void mix_samples( const blip_sample_t in [], int n );
+	
+	// Sets time of cleared buffer to that of another with same sample rate, clock
+	// rate, and length, so that it has as many (silent) samples available and can
+	// be ended and read along with it from now on
+	void sync_time( Blip_Buffer const& );
 
 // Resampled time (sorry, poor documentation right now)
 	
@@ -94,6 +104,10 @@ public:
 	// settings during same run of program; states can NOT be stored on disk.
 	// Clears buffer before loading state.
 	void load_state( const blip_buffer_state_t& in );
+	
+	// Saves/loads state along with any unread samples, so unlike save_state()
+	// samples_avail() doesn't need to be 0. Same restrictions as load_state().
+	void copy_state( State_Copier& );
 
 private:
 	// noncopyable
@@ -125,7 +139,7 @@ public:
 	void volume( double v )                     { impl.volume_unit( 1.0 / range * v ); }
 	
 	// Configures low-pass filter
-	void treble_eq( const blip_eq_t& eq )       { impl.treble_eq( eq ); }
+	void treble_eq( const blip_eq_t& eq );
 	
 	// Gets/sets default Blip_Buffer
 	Blip_Buffer* output() const                 { return impl.buf; }
@@ -166,8 +180,16 @@ private:
 	// Left halves of first difference of step response for each possible phase
 	coeff_t phases [quality / 2 * blip_res];
 public:
-	Blip_Synth() : impl( phases, quality ) { }
+	Blip_Synth() : impl( phases, quality ), kernel( &full_kernel ) { }
+private:
+	static void full_kernel( Blip_Synth const&, blip_resampled_time_t, int delta, Blip_Buffer* );
+	
+	// Kernel for synthesis quality of last treble_eq()
+	typedef void (*kernel_t)( Blip_Synth const&, blip_resampled_time_t, int delta, Blip_Buffer* );
+	kernel_t kernel;
 #endif
+	// Linear interpolation, used for blip_synth_fast
+	static void fast_kernel( Blip_Synth const&, blip_resampled_time_t, int delta, Blip_Buffer* );
 };
 
 
@@ -176,6 +198,7 @@ public:
 class blip_eq_t {
 	double treble, kaiser;
 	int rolloff_freq, sample_rate, cutoff_freq;
+	int synth_quality_;
 public:
 	// Logarithmic rolloff to treble dB at half sampling rate. Negative values reduce
 	// treble, small positive values (0 to 5.0) increase treble.
@@ -185,6 +208,11 @@ public:
 	blip_eq_t( double treble, int rolloff_freq, int sample_rate, int cutoff_freq = 0,
 			double kaiser = 5.2 );
 	
+	// Synthesis quality of Blip_Synths this is applied to, blip_synth_fast or
+	// blip_synth_full (default). Has no effect if BLIP_BUFFER_FAST is defined.
+	void synth_quality( int q )                 { synth_quality_ = q; }
+	int synth_quality() const                   { return synth_quality_; }
+	
 	// Generate center point and right half of impulse response
 	virtual void generate( float out [], int count ) const;
 	virtual ~blip_eq_t() { }
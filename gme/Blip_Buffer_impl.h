@@ -31,6 +31,7 @@ class Blip_Buffer;
 #endif
 
 int const blip_res           = 1 << BLIP_PHASE_BITS;
+int const blip_fast_phase_bits = 8; // linear interpolation of blip_synth_fast
 int const blip_buffer_extra_ = BLIP_MAX_QUALITY + 2;
 
 class Blip_Buffer_ {
@@ -104,6 +105,8 @@ public:
 	int last_amp;
 	Blip_Buffer* buf;
 	
+	int fast_delta_factor; // for blip_synth_fast
+	
 	void volume_unit( double );
 	void treble_eq( blip_eq_t const& );
 	Blip_Synth_( short phases [], int width );
@@ -4,6 +4,10 @@
 #ifndef BLIP_BUFFER_IMPL2_H
 #define BLIP_BUFFER_IMPL2_H
 
+#if BLARGG_SSE2
+	#include <emmintrin.h>
+#endif
+
 //// Compatibility
 
 BLARGG_DEPRECATED( int const blip_low_quality  =  8; )
@@ -79,6 +83,38 @@ int const blip_reader_idx_factor = sizeof (Blip_Buffer::delta_t);
 #define BLIP_CLAMP( sample, out )\
 	{ if ( BLIP_CLAMP_( (sample) ) ) (out) = ((sample) >> 31) ^ 0x7FFF; }
 
+// Stores sample to out, clamping only if out is a blip_sample_t
+inline void blip_store( blip_sample_t& out, int s )         { BLIP_CLAMP( s, s ); out = (blip_sample_t) s; }
+inline void blip_store( blip_wide_sample_t& out, int s )    { out = s; }
+
+#if BLARGG_SSE2
+	// Stores lanes 0 and 1 of s like blip_store(). Packing with saturation
+	// matches BLIP_CLAMP.
+	inline void blip_store_pair( blip_sample_t out [], __m128i s )
+	{
+		s = _mm_packs_epi32( s, s );
+		out [0] = (blip_sample_t) _mm_extract_epi16( s, 0 );
+		out [1] = (blip_sample_t) _mm_extract_epi16( s, 1 );
+	}
+	
+	inline void blip_store_pair( blip_wide_sample_t out [], __m128i s )
+	{
+		_mm_storel_epi64( (__m128i*) out, s );
+	}
+	
+	// Stores all lanes of lo, then all lanes of hi
+	inline void blip_store_pairs( blip_sample_t out [], __m128i lo, __m128i hi )
+	{
+		_mm_storeu_si128( (__m128i*) out, _mm_packs_epi32( lo, hi ) );
+	}
+	
+	inline void blip_store_pairs( blip_wide_sample_t out [], __m128i lo, __m128i hi )
+	{
+		_mm_storeu_si128( (__m128i*) out,     lo );
+		_mm_storeu_si128( (__m128i*) out + 1, hi );
+	}
+#endif
+
 
 //// Blip_Synth
 
@@ -91,31 +127,29 @@ int const blip_reader_idx_factor = sizeof (Blip_Buffer::delta_t);
 	((T*) (BLIP_SH_AND_MUL( off, sh, -1, sizeof (T) ) + (char*) (ptr)))
 
 template<int quality,int range>
-inline void Blip_Synth<quality,range>::offset_resampled( blip_resampled_time_t time,
-		int delta, Blip_Buffer* blip_buf ) const
+inline void Blip_Synth<quality,range>::fast_kernel( Blip_Synth const& synth,
+		blip_resampled_time_t time, int delta, Blip_Buffer* blip_buf )
 {
+	Blip_Buffer::delta_t* BLARGG_RESTRICT buf = blip_buf->delta_at( time );
+	
 #if BLIP_BUFFER_FAST
-	int const half_width = 1;
+	delta *= synth.impl.delta_factor;
 #else
-	int const half_width = quality / 2;
+	delta *= synth.impl.fast_delta_factor;
+	
+	// center step where full_kernel does, so changing quality doesn't shift timing
+	--buf;
 #endif
 	
-	Blip_Buffer::delta_t* BLARGG_RESTRICT buf = blip_buf->delta_at( time );
+	int const phase_shift = BLIP_BUFFER_ACCURACY - blip_fast_phase_bits;
+	int const phase = (int) BLIP_SH_AND_MUL( time, phase_shift, (1 << blip_fast_phase_bits) - 1, 1 );
 	
-	delta *= impl.delta_factor;
-
-	int const phase_shift = BLIP_BUFFER_ACCURACY - BLIP_PHASE_BITS;
-	int const phase = (half_width & (half_width - 1)) ?
-		(int) BLIP_SH_AND_MUL( time, phase_shift, blip_res - 1, sizeof (coeff_t) ) * half_width :
-		(int) BLIP_SH_AND_MUL( time, phase_shift, blip_res - 1, sizeof (coeff_t) * half_width );
-	
-#if BLIP_BUFFER_FAST
 	int left = buf [0] + delta;
 	
 	// Kind of crappy, but doing shift after multiply results in overflow.
 	// Alternate way of delaying multiply by delta_factor results in worse
 	// sub-sample resolution.
-	int right = (delta >> BLIP_PHASE_BITS) * phase;
+	int right = (delta >> blip_fast_phase_bits) * phase;
 	#if BLIP_BUFFER_NOINTERP
 		// TODO: remove? (just a hack to see how it sounds)
 		right = 0;
@@ -125,12 +159,28 @@ inline void Blip_Synth<quality,range>::offset_resampled( blip_resampled_time_t t
 	
 	buf [0] = left;
 	buf [1] = right;
-#else
+}
+
+#if !BLIP_BUFFER_FAST
+
+template<int quality,int range>
+inline void Blip_Synth<quality,range>::full_kernel( Blip_Synth const& synth,
+		blip_resampled_time_t time, int delta, Blip_Buffer* blip_buf )
+{
+	int const half_width = quality / 2;
+	
+	Blip_Buffer::delta_t* BLARGG_RESTRICT buf = blip_buf->delta_at( time );
+	
+	delta *= synth.impl.delta_factor;
+
+	int const phase_shift = BLIP_BUFFER_ACCURACY - BLIP_PHASE_BITS;
+	int const phase = (half_width & (half_width - 1)) ?
+		(int) BLIP_SH_AND_MUL( time, phase_shift, blip_res - 1, sizeof (coeff_t) ) * half_width :
+		(int) BLIP_SH_AND_MUL( time, phase_shift, blip_res - 1, sizeof (coeff_t) * half_width );
 	
 	int const fwd = -quality / 2;
-	int const rev = fwd + quality - 2;
 	
-	coeff_t const* BLARGG_RESTRICT imp = (coeff_t const*) ((char const*) phases + phase);
+	coeff_t const* BLARGG_RESTRICT imp = (coeff_t const*) ((char const*) synth.phases + phase);
 	int const phase2 = phase + phase - (blip_res - 1) * half_width * sizeof (coeff_t);
 	
 	#define BLIP_MID_IMP imp = (coeff_t const*) ((char const*) imp - phase2);
@@ -165,7 +215,50 @@ inline void Blip_Synth<quality,range>::offset_resampled( blip_resampled_time_t t
 	
 	// Unrolled versions for qualities 8, 12, and 16
 	
-	#if BLIP_X86
+	#if BLARGG_SSE2
+		// Left half of kernel is at imp, and right half is mirrored at imp - phase2.
+		// Kernel is added to buf four samples at a time.
+		coeff_t const* BLARGG_RESTRICT rimp = (coeff_t const*) ((char const*) imp - phase2);
+		
+		__m128i const d = _mm_set1_epi32( delta );
+		
+		// Four 16-bit coefficients at p, in reverse order
+		#define BLIP_SSE2_REV( p ) \
+			_mm_shufflelo_epi16( _mm_loadl_epi64( (__m128i const*) (p) ), 0x1B )
+		
+		// Sign-extends four 16-bit coefficients, multiplies them by delta, and adds
+		// them to four samples. SSE2 lacks a 32-bit multiply, so even and odd are
+		// done separately.
+		#define BLIP_SSE2_ADD( out, in ) {\
+			__m128i c  = _mm_srai_epi32( _mm_unpacklo_epi16( in, in ), 16 );\
+			__m128i p0 = _mm_mul_epu32( c, d );\
+			__m128i p1 = _mm_mul_epu32( _mm_srli_epi64( c, 32 ), d );\
+			__m128i p  = _mm_unpacklo_epi32( _mm_shuffle_epi32( p0, 0x08 ), _mm_shuffle_epi32( p1, 0x08 ) );\
+			__m128i* o = (__m128i*) (buf + fwd + (out));\
+			_mm_storeu_si128( o, _mm_add_epi32( _mm_loadu_si128( o ), p ) );\
+		}
+		
+		BLIP_SSE2_ADD( 0, _mm_loadl_epi64( (__m128i const*) imp ) )
+		if ( quality == 12 )
+		{
+			// imp [4], imp [5], rimp [5], rimp [4]
+			__m128i li = _mm_srli_si128( _mm_loadl_epi64( (__m128i const*) (imp  + 2) ), 4 );
+			__m128i ri = _mm_srli_si128( _mm_loadl_epi64( (__m128i const*) (rimp + 2) ), 4 );
+			BLIP_SSE2_ADD( 4, _mm_unpacklo_epi32( li, _mm_shufflelo_epi16( ri, 0xE1 ) ) )
+		}
+		if ( quality == 16 )
+		{
+			BLIP_SSE2_ADD( 4, _mm_loadl_epi64( (__m128i const*) (imp + 4) ) )
+			BLIP_SSE2_ADD( 8, BLIP_SSE2_REV( rimp + 4 ) )
+		}
+		BLIP_SSE2_ADD( quality - 4, BLIP_SSE2_REV( rimp ) )
+		
+		#undef BLIP_SSE2_REV
+		#undef BLIP_SSE2_ADD
+	
+	#elif BLIP_X86
+		int const rev = fwd + quality - 2;
+		
 		// This gives better code for x86
 		#define BLIP_ADD( out, in ) \
 			buf [out] += imp [in] * delta
@@ -191,6 +284,8 @@ inline void Blip_Synth<quality,range>::offset_resampled( blip_resampled_time_t t
 		BLIP_REV( 0 )
 	
 	#else
+		int const rev = fwd + quality - 2;
+		
 		// Help RISC processors and simplistic compilers by reading ahead of writes
 		#define BLIP_FWD( i ) {\
 			int t0 =          i0 * delta + buf [fwd     + i];\
@@ -230,10 +325,31 @@ inline void Blip_Synth<quality,range>::offset_resampled( blip_resampled_time_t t
 		buf [rev    ] = t0;
 		buf [rev + 1] = t1;
 	#endif
-	
+}
+
+#endif
+
+template<int quality,int range>
+inline void Blip_Synth<quality,range>::offset_resampled( blip_resampled_time_t time,
+		int delta, Blip_Buffer* blip_buf ) const
+{
+#if BLIP_BUFFER_FAST
+	fast_kernel( *this, time, delta, blip_buf );
+#else
+	kernel( *this, time, delta, blip_buf );
 #endif
 }
 
+template<int quality,int range>
+void Blip_Synth<quality,range>::treble_eq( blip_eq_t const& eq )
+{
+	impl.treble_eq( eq );
+	#if !BLIP_BUFFER_FAST
+		assert( eq.synth_quality() == blip_synth_fast || eq.synth_quality() == blip_synth_full );
+		kernel = (eq.synth_quality() ? &full_kernel : &fast_kernel);
+	#endif
+}
+
 template<int quality,int range>
 #if BLIP_BUFFER_FAST
 	inline
@@ -258,9 +374,11 @@ void Blip_Synth<quality,range>::update( blip_time_t t, int amp )
 //// blip_eq_t
 
 inline blip_eq_t::blip_eq_t( double t ) :
-		treble( t ), kaiser( 5.2 ), rolloff_freq( 0 ), sample_rate( 44100 ), cutoff_freq( 0 ) { }
+		treble( t ), kaiser( 5.2 ), rolloff_freq( 0 ), sample_rate( 44100 ), cutoff_freq( 0 ),
+		synth_quality_( blip_synth_full ) { }
 inline blip_eq_t::blip_eq_t( double t, int rf, int sr, int cf, double k ) :
-		treble( t ), kaiser( k ), rolloff_freq( rf ), sample_rate( sr ), cutoff_freq( cf ) { }
+		treble( t ), kaiser( k ), rolloff_freq( rf ), sample_rate( sr ), cutoff_freq( cf ),
+		synth_quality_( blip_synth_full ) { }
 
 
 //// Blip_Buffer
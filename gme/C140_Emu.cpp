@@ -3,6 +3,8 @@
 #include "C140_Emu.h"
 #include "c140.h"
 
+#include "State_Copier.h"
+
 C140_Emu::C140_Emu() { chip = 0; }
 
 C140_Emu::~C140_Emu()
@@ -75,3 +77,10 @@ void C140_Emu::run( int pair_count, sample_t* out )
 		pair_count -= todo;
 	}
 }
+
+void C140_Emu::copy_state( State_Copier& copier )
+{
+	int kept [C140_STATE_KEPT];
+	int kept_count = c140_state_kept( chip, kept );
+	copier.copy_with_ptrs( chip, c140_state_size(), NULL, 0, kept, kept_count );
+}
@@ -0,0 +1,183 @@
+// Game_Music_Emu $vers. http://www.slack.net/~ant/
+
+#include "Chip_Resampler.h"
+
+#include "State_Copier.h"
+
+/* Copyright (C) 2008 Shay Green. This module is free software; you
+can redistribute it and/or modify it under the terms of the GNU Lesser
+General Public License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version. This
+module is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+details. You should have received a copy of the GNU Lesser General Public
+License along with this module; if not, write to the Free Software Foundation,
+Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA */
+
+#include "blargg_source.h"
+
+Chip_Bus::Chip_Bus()
+{
+	last_time             = 0;
+	out_                  = NULL;
+	rate_                 = 0;
+	sample_buf_size       = 0;
+	oversamples_per_frame = 0;
+	inputs                = NULL;
+	in_begin              = 0;
+	in_end                = 0;
+}
+
+blargg_err_t Chip_Bus::set_rate( double oversample )
+{
+	rate_ = oversample;
+	RETURN_ERR( resampler.set_rate( oversample ) );
+
+	double rate = resampler.rate();
+	int pairs = (int) (rate >= 1.0 ? 64.0 * rate : 64.0 / rate);
+	RETURN_ERR( sample_buf.resize( (pairs + (pairs >> 2)) * 2 ) );
+	sample_buf_size = pairs * 2;
+	oversamples_per_frame = int (pairs * rate) * 2 + 2;
+
+	int resampler_size = oversamples_per_frame + (oversamples_per_frame >> 2);
+	RETURN_ERR( mix_buf.resize( resampler_size ) );
+	RETURN_ERR( chip_buf.resize( resampler_size ) );
+	
+	// room for several frames, so that moving unread input is rare
+	RETURN_ERR( in_buf.resize( resampler_size * 4 ) );
+	clear();
+	return blargg_ok;
+}
+
+void Chip_Bus::add( Chip_Bus_Input& in )
+{
+	assert( !in.bus );
+	in.bus  = this;
+	in.next = inputs;
+	inputs  = &in;
+}
+
+void Chip_Bus::clear()
+{
+	in_begin = 0;
+	in_end   = 0;
+	resampler.clear();
+}
+
+void Chip_Bus::copy_state( State_Copier& copier )
+{
+	// unread input is saved from beginning of buffer
+	int count = in_end - in_begin;
+	memmove( in_buf.begin(), in_buf.begin() + in_begin, count * sizeof in_buf [0] );
+	in_begin = 0;
+	in_end   = count;
+	
+	copier.copy( in_end );
+	copier.copy_var( in_buf.begin(), in_end * sizeof in_buf [0], in_buf.size() * sizeof in_buf [0] );
+	if ( (unsigned) in_end > in_buf.size() )
+		in_end = 0;
+	resampler.copy_state( copier );
+}
+
+// Runs all chips for count samples, mixes them with their gains, and writes
+// sum to out. Each chip sample is read once after the chip writes it.
+void Chip_Bus::mix_chips( short out [], int count )
+{
+	Chip_Bus_Input const* in = inputs;
+	int const unity = 1 << gain_bits;
+	
+	if ( !in->next )
+	{
+		// only chip writes directly to out
+		memset( out, 0, count * sizeof *out );
+		in->run( in->emu, count >> 1, out );
+		int const gain = in->muted ? 0 : in->gain;
+		if ( gain != unity )
+		{
+			for ( int i = 0; i < count; i++ )
+			{
+				int s = (out [i] * gain) >> gain_bits;
+				if ( (short) s != s )
+					s = 0x7FFF ^ (s >> 31);
+				out [i] = (short) s;
+			}
+		}
+		return;
+	}
+	
+	int* BLARGG_RESTRICT mix = mix_buf.begin();
+	short* BLARGG_RESTRICT chip = chip_buf.begin();
+	for ( bool first = true; in; in = in->next, first = false )
+	{
+		memset( chip, 0, count * sizeof *chip );
+		in->run( in->emu, count >> 1, chip );
+		int const gain = in->muted ? 0 : in->gain;
+		if ( first )
+		{
+			for ( int i = 0; i < count; i++ )
+				mix [i] = (chip [i] * gain) >> gain_bits;
+		}
+		else if ( in->next )
+		{
+			for ( int i = 0; i < count; i++ )
+				mix [i] += (chip [i] * gain) >> gain_bits;
+		}
+		else
+		{
+			// last chip also clamps sum into out
+			for ( int i = 0; i < count; i++ )
+			{
+				int s = mix [i] + ((chip [i] * gain) >> gain_bits);
+				if ( (short) s != s )
+					s = 0x7FFF ^ (s >> 31);
+				out [i] = (short) s;
+			}
+		}
+	}
+}
+
+void Chip_Bus::mix_samples( short out [], int count ) const
+{
+	short const* in = sample_buf.begin();
+	for ( int i = 0; i < count * 2; i++ )
+	{
+		int s = in [i] + out [i];
+		if ( (short) s != s )
+			s = 0x7FFF ^ (s >> 31);
+		out [i] = (short) s;
+	}
+}
+
+int Chip_Bus::run_until( int time )
+{
+	int count = time - last_time;
+	if ( count <= 0 )
+		return true;
+	last_time = time;
+
+	while ( count > 0 )
+	{
+		// top up input to one frame's worth
+		int new_count = oversamples_per_frame - (in_end - in_begin);
+		if ( in_end + new_count > (int) in_buf.size() )
+		{
+			memmove( in_buf.begin(), in_buf.begin() + in_begin, (in_end - in_begin) * sizeof in_buf [0] );
+			in_end -= in_begin;
+			in_begin = 0;
+		}
+		mix_chips( in_buf.begin() + in_end, new_count );
+		in_end += new_count;
+		
+		int used = in_end - in_begin;
+		int n = resampler.resample( sample_buf.begin(), min( count * 2, sample_buf_size ),
+				in_buf.begin() + in_begin, &used ) >> 1;
+		in_begin += used;
+		if ( !n )
+			break;
+		mix_samples( out_, n );
+		out_ += n * 2;
+		count -= n;
+	}
+	return true;
+}
@@ -1,4 +1,5 @@
-// Fir_Resampler chip emulator container that mixes into the output buffer
+// Fir_Resampler mixing bus for chip emulators that share a sample rate, and
+// chip emulator container that mixes into one
 
 // Game_Music_Emu $vers
 #ifndef CHIP_RESAMPLER_H
@@ -7,141 +8,115 @@
 #include "blargg_source.h"
 
 #include "Fir_Resampler.h"
+class State_Copier;
+class Chip_Bus;
 typedef Fir_Resampler_Norm Chip_Resampler_Downsampler;
 
-int const resampler_extra = 0; //34;
+// Chip emulator's connection to a Chip_Bus
+struct Chip_Bus_Input {
+	Chip_Bus* bus;          // NULL until added to bus
+	Chip_Bus_Input* next;   // next input of same bus
+	double rate;            // chip samples per output sample
+	int gain;               // 1 << Chip_Bus::gain_bits is unity
+	bool muted;             // chip still runs, but adds nothing to bus
+	bool own_bus;           // rate can change, so input can't share bus
+
+	// Adds pairs stereo samples from emu to out
+	void* emu;
+	void (*run)( void* emu, int pairs, short out [] );
+};
 
-template<class Emu>
-class Chip_Resampler_Emu : public Emu {
-	int last_time;
-	short* out;
-	typedef short dsample_t;
-	enum { disabled_time = -1 };
+// Runs chips at same rate into one 32-bit mix, then resamples and adds it to
+// output buffer. Sum is clamped only once, rather than once for each chip.
+class Chip_Bus {
+public:
 	enum { gain_bits = 14 };
-	blargg_vector<dsample_t> sample_buf;
-	int sample_buf_size;
-	int oversamples_per_frame;
-	int buf_pos;
-	int buffered;
-	int resampler_size;
-	int gain_;
 
-	Chip_Resampler_Downsampler resampler;
+	// Sets input/output rate ratio and clears bus
+	blargg_err_t set_rate( double );
 
-	void mix_samples( short * buf, int count )
-	{
-        dsample_t * inptr = sample_buf.begin();
-		for ( unsigned i = 0; i < count * 2; i++ )
-		{
-			int sample = inptr[i];
-			sample += buf[i];
-			if ((short)sample != sample) sample = 0x7FFF ^ (sample >> 31);
-			buf[i] = sample;
-		}
-	}
+	// Ratio passed to set_rate()
+	double rate() const                 { return rate_; }
+
+	// Adds chip to bus
+	void add( Chip_Bus_Input& );
+
+	// Clears buffered samples
+	void clear();
+
+	// Starts new frame that adds to out
+	void begin_frame( short out [] )    { out_ = out; last_time = 0; }
+
+	// Runs chips and adds their samples to output up to time, in output pairs
+	int run_until( int time );
+
+	// Saves/loads buffered samples
+	void copy_state( State_Copier& );
 
+// Implementation
 public:
-	Chip_Resampler_Emu()      { last_time = disabled_time; out = NULL; }
-	blargg_err_t setup( double oversample, double rolloff, double gain )
-	{
-		gain_ = (int) ((1 << gain_bits) * gain);
-		RETURN_ERR( resampler.set_rate( oversample ) );
-		return reset_resampler();
-	}
+	Chip_Bus();
 
-	blargg_err_t reset()
-	{
-		Emu::reset();
-		resampler.clear();
-		return blargg_ok;
-	}
+private:
+	int last_time;
+	short* out_;
+	double rate_;
+	int sample_buf_size;
+	int oversamples_per_frame;
+	Chip_Bus_Input* inputs;
+	blargg_vector<short> sample_buf;
+	blargg_vector<int> mix_buf;
+	blargg_vector<short> chip_buf;
+	Chip_Resampler_Downsampler resampler;
 
-	blargg_err_t reset_resampler()
-	{
-		unsigned int pairs;
-		double rate = resampler.rate();
-		if ( rate >= 1.0 ) pairs = 64.0 * rate;
-		else pairs = 64.0 / rate;
-		RETURN_ERR( sample_buf.resize( (pairs + (pairs >> 2)) * 2 ) );
-		resize( pairs );
-		resampler_size = oversamples_per_frame + (oversamples_per_frame >> 2);
-		RETURN_ERR( resampler.resize_buffer( resampler_size ) );
-		return blargg_ok;
-	}
+	// Chip samples not yet resampled are in_buf [in_begin] to in_buf [in_end].
+	// They're moved to beginning only when end of in_buf is reached.
+	blargg_vector<short> in_buf;
+	int in_begin;
+	int in_end;
 
-	void resize( int pairs )
-	{
-		int new_sample_buf_size = pairs * 2;
-		//new_sample_buf_size = new_sample_buf_size / 4 * 4; // TODO: needed only for 3:2 downsampler
-		if ( sample_buf_size != new_sample_buf_size )
-		{
-			if ( (unsigned) new_sample_buf_size > sample_buf.size() )
-			{
-				check( false );
-				return;
-			}
-			sample_buf_size = new_sample_buf_size;
-			oversamples_per_frame = int (pairs * resampler.rate()) * 2 + 2;
-			clear();
-		}
-	}
+	void mix_chips( short out [], int count );
+	void mix_samples( short out [], int count ) const;
+};
+
+template<class Emu>
+class Chip_Resampler_Emu : public Emu {
+	bool enabled_;
+	static void run_( void* emu, int pairs, short out [] ) { ((Chip_Resampler_Emu*) emu)->Emu::run( pairs, out ); }
+public:
+	// Connection to bus, set up by Chip_Bus::add()
+	Chip_Bus_Input input;
 
-	void clear()
+	Chip_Resampler_Emu()
 	{
-		buf_pos = buffered = 0;
-		resampler.clear();
+		enabled_      = false;
+		input.bus     = NULL;
+		input.next    = NULL;
+		input.muted   = false;
+		input.own_bus = false;
+		input.emu     = this;
+		input.run     = &run_;
 	}
 
-	void enable( bool b = true )    { last_time = b ? 0 : disabled_time; }
-	bool enabled() const            { return last_time != disabled_time; }
-	void begin_frame( short* buf )  { out = buf; last_time = 0; }
-
-	int run_until( int time )
+	// Sets rate ratio and gain to be used when chip is added to a bus. If already
+	// added, changes rate of bus, which must be its own.
+	blargg_err_t setup( double oversample, double rolloff, double gain )
 	{
-		int count = time - last_time;
-		while ( count > 0 )
+		input.rate = oversample;
+		input.gain = (int) ((1 << Chip_Bus::gain_bits) * gain);
+		if ( input.bus )
 		{
-			if ( last_time < 0 )
-				return false;
-			last_time = time;
-			if ( buffered )
-			{
-				int samples_to_copy = buffered;
-				if ( samples_to_copy > count ) samples_to_copy = count;
-				memcpy( out, sample_buf.begin(), samples_to_copy * sizeof(short) * 2 );
-				memcpy( sample_buf.begin(), sample_buf.begin() + samples_to_copy * 2, ( buffered - samples_to_copy ) * 2 * sizeof(short) );
-				buffered -= samples_to_copy;
-				count -= samples_to_copy;
-				continue;
-			}
-			int sample_count = oversamples_per_frame - resampler.written() + resampler_extra;
-			memset( resampler.buffer(), 0, sample_count * sizeof(*resampler.buffer()) );
-			Emu::run( sample_count >> 1, resampler.buffer() );
-			for ( unsigned i = 0; i < sample_count; i++ )
-			{
-                dsample_t * ptr = resampler.buffer() + i;
-				*ptr = ( *ptr * gain_ ) >> gain_bits;
-			}
-			short* p = out;
-			resampler.write( sample_count );
-			sample_count = resampler.read( sample_buf.begin(), count * 2 > sample_buf_size ? sample_buf_size : count * 2 ) >> 1;
-			if ( sample_count > count )
-			{
-				out += count * Emu::out_chan_count;
-				mix_samples( p, count );
-				memmove( sample_buf.begin(), sample_buf.begin() + count * 2, (sample_count - count) * 2 * sizeof(short) );
-				buffered = sample_count - count;
-				return true;
-			}
-			else if (!sample_count) return true;
-			out += sample_count * Emu::out_chan_count;
-			mix_samples( p, sample_count );
-			count -= sample_count;
+			assert( input.own_bus );
+			return input.bus->set_rate( oversample );
 		}
-		return true;
+		return blargg_ok;
 	}
-};
 
+	void enable( bool b = true )    { enabled_ = b; }
+	bool enabled() const            { return enabled_; }
 
+	// Runs bus this chip is on up to time
+	int run_until( int time )       { return enabled_ && input.bus->run_until( time ); }
+};
 
 #endif
@@ -3,6 +3,8 @@
 #include "Classic_Emu.h"
 
 #include "Multi_Buffer.h"
+#include "Voice_Buffer.h"
+#include "State_Copier.h"
 
 /* Copyright (C) 2003-2008 Shay Green. This module is free software; you
 can redistribute it and/or modify it under the terms of the GNU Lesser
@@ -22,6 +24,7 @@ Classic_Emu::Classic_Emu()
 	buf           = NULL;
 	stereo_buffer = NULL;
 	voice_types   = NULL;
+	skipping      = false;
 	
 	// avoid inconsistency in our duplicated constants
 	assert( (int) wave_type  == (int) Multi_Buffer::wave_type );
@@ -34,16 +37,26 @@ Classic_Emu::~Classic_Emu()
 	delete stereo_buffer;
 	delete effects_buffer_;
 	effects_buffer_ = NULL;
+	delete voice_buffer_;
+	voice_buffer_ = NULL;
 }
 
 void Classic_Emu::set_equalizer_( equalizer_t const& eq )
 {
 	Music_Emu::set_equalizer_( eq );
-	update_eq( eq.treble );
+	blip_eq_t treble( eq.treble );
+	treble.synth_quality( quality() );
+	update_eq( treble );
 	if ( buf )
 		buf->bass_freq( (int) equalizer().bass );
 }
 	
+void Classic_Emu::set_quality_( int )
+{
+	// synths get quality along with treble
+	set_equalizer_( equalizer() );
+}
+
 blargg_err_t Classic_Emu::set_sample_rate_( int rate )
 {
 	if ( !buf )
@@ -97,13 +110,41 @@ blargg_err_t Classic_Emu::start_track_( int track )
 }
 
 blargg_err_t Classic_Emu::play_( int count, sample_t out [] )
+{
+	return play_samples( count, out );
+}
+
+// Buffer mixes at 32 bits, so wide output is just left unclamped
+blargg_err_t Classic_Emu::play_wide_( int count, wide_sample_t out [] )
+{
+	return play_samples( count, out );
+}
+
+static inline int read_buf( Multi_Buffer* buf, blip_sample_t out [], int count )
+{
+	return buf->read_samples( out, count );
+}
+
+static inline int read_buf( Multi_Buffer* buf, blip_wide_sample_t out [], int count )
+{
+	return buf->read_samples_wide( out, count );
+}
+
+template<class T>
+blargg_err_t Classic_Emu::play_samples( int count, T out [] )
 {
 	// read from buffer, then refill buffer and repeat if necessary
 	int remain = count;
 	while ( remain )
 	{
-		buf->disable_immediate_removal();
-		remain -= buf->read_samples( &out [count - remain], remain );
+		{
+			GME_PROFILE_STAGE( buffer );
+			buf->disable_immediate_removal();
+			if ( skipping )
+				remain -= buf->skip_samples( remain );
+			else
+				remain -= read_buf( buf, &out [count - remain], remain );
+		}
 		if ( remain )
 		{
 			if ( buf_changed_count != buf->channels_changed_count() )
@@ -114,11 +155,53 @@ blargg_err_t Classic_Emu::play_( int count, sample_t out [] )
 			
 			// TODO: use more accurate length calculation
 			int msec = buf->length();
+			if ( frame_length() && frame_length() < msec )
+				msec = frame_length();
 			blip_time_t clocks_emulated = msec * clock_rate_ / 1000 - 100;
-			RETURN_ERR( run_clocks( clocks_emulated, msec ) );
+			{
+				GME_PROFILE_STAGE( emulate );
+				RETURN_ERR( run_clocks( clocks_emulated, msec ) );
+			}
 			assert( clocks_emulated );
+			GME_PROFILE_STAGE( buffer );
 			buf->end_frame( clocks_emulated );
 		}
 	}
 	return blargg_ok;
 }
+
+blargg_err_t Classic_Emu::separate_voices_()
+{
+	voice_buffer_ = BLARGG_NEW Voice_Buffer;
+	CHECK_ALLOC( voice_buffer_ );
+	set_buffer( voice_buffer_ );
+	return blargg_ok;
+}
+
+// Each voice is routed to its own buffers in voice_buffer_, so it's just a
+// matter of reading them out as they're mixed
+blargg_err_t Classic_Emu::set_voice_out_( sample_t* const out [] )
+{
+	if ( !voice_buffer_ || buf != voice_buffer_ )
+		return BLARGG_ERR( BLARGG_ERR_CALLER, "emulator not created for voice output" );
+	
+	voice_buffer_->set_channel_out( out );
+	return blargg_ok;
+}
+
+blargg_err_t Classic_Emu::skip_( int count )
+{
+	// Skipped samples are discarded, so buffer only needs to end up in the
+	// same state as if they'd been read. Emulation is unchanged, so output
+	// after skip is the same as when they are read.
+	skipping = true;
+	blargg_err_t err = Music_Emu::skip_( count );
+	skipping = false;
+	return err;
+}
+
+blargg_err_t Classic_Emu::copy_buffer_state( State_Copier& copier )
+{
+	buf->copy_state( copier );
+	return copier.error();
+}
@@ -27,6 +27,10 @@ protected:
 	// Changes clock rate of Blip_Buffers (experimental)
 	void change_clock_rate( int );
 	
+	// Saves/loads state of Blip_Buffers. Must be called at end of copy_state_()
+	// override.
+	blargg_err_t copy_buffer_state( State_Copier& );
+	
 // Overrides should do the indicated task
 	
 	// Set Blip_Buffer(s) voice outputs to, or mute voice if pointer is NULL
@@ -54,7 +58,12 @@ protected:
 	virtual blargg_err_t set_sample_rate_( int sample_rate );
 	virtual void mute_voices_( int );
 	virtual void set_equalizer_( equalizer_t const& );
+	virtual void set_quality_( int );
 	virtual blargg_err_t play_( int, sample_t [] );
+	virtual blargg_err_t play_wide_( int, wide_sample_t [] );
+	virtual blargg_err_t skip_( int );
+	virtual blargg_err_t separate_voices_();
+	virtual blargg_err_t set_voice_out_( sample_t* const [] );
 
 private:
 	Multi_Buffer* buf;
@@ -62,6 +71,8 @@ private:
 	int clock_rate_;
 	unsigned buf_changed_count;
 	int const* voice_types;
+	bool skipping;
+	template<class T> blargg_err_t play_samples( int, T [] );
 };
 
 inline void Classic_Emu::set_buffer( Multi_Buffer* new_buf )
@@ -2,6 +2,8 @@
 
 #include "Downsampler.h"
 
+#include "State_Copier.h"
+
 /* Copyright (C) 2004-2008 Shay Green. This module is free software; you
 can redistribute it and/or modify it under the terms of the GNU Lesser
 General Public License as published by the Free Software Foundation; either
@@ -24,6 +26,11 @@ void Downsampler::clear_()
 	Resampler::clear_();
 }
 
+void Downsampler::copy_state_( State_Copier& copier )
+{
+	copier.copy( pos );
+}
+
 Downsampler::Downsampler()
 {
 	clear();
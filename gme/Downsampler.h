@@ -13,6 +13,7 @@ public:
 protected:
 	virtual blargg_err_t set_rate_( double );
 	virtual void clear_();
+	virtual void copy_state_( State_Copier& );
 	virtual sample_t const* resample_( sample_t**, sample_t const*, sample_t const [], int );
 
 private:
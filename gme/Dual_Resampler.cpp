@@ -2,6 +2,9 @@
 
 #include "Dual_Resampler.h"
 
+#include "State_Copier.h"
+#include "Gme_Profiler.h"
+
 /* Copyright (C) 2003-2008 Shay Green. This module is free software; you
 can redistribute it and/or modify it under the terms of the GNU Lesser
 General Public License as published by the Free Software Foundation; either
@@ -20,17 +23,50 @@ int const resampler_extra = 34;
 
 int const stereo = 2;
 
-Dual_Resampler::Dual_Resampler() { }
+Dual_Resampler::Dual_Resampler()
+{
+	voices      = NULL;
+	voice_count = 0;
+	voice_out   = NULL;
+}
 
-Dual_Resampler::~Dual_Resampler() { }
+Dual_Resampler::~Dual_Resampler()
+{
+	delete [] voices;
+}
+
+blargg_err_t Dual_Resampler::separate_voices( int count )
+{
+	delete [] voices;
+	voice_count = 0;
+	CHECK_ALLOC( voices = BLARGG_NEW voice_t [count] );
+	voice_count = count;
+	return blargg_ok;
+}
+
+blargg_err_t Dual_Resampler::setup( double oversample, double rolloff, double gain )
+{
+	gain_ = (int) ((1 << gain_bits) * gain);
+	for ( int i = 0; i < voice_count; i++ )
+		RETURN_ERR( voices [i].resampler.set_rate( oversample ) );
+	return resampler.set_rate( oversample );
+}
 
 blargg_err_t Dual_Resampler::reset( int pairs )
 {
 	// expand allocations a bit
 	RETURN_ERR( sample_buf.resize( (pairs + (pairs >> 2)) * 2 ) );
+	if ( voices )
+	{
+		for ( int i = 0; i < voice_count; i++ )
+			RETURN_ERR( voices [i].buf.resize( sample_buf.size() ) );
+		RETURN_ERR( stereo_voice_buf.resize( sample_buf.size() ) );
+	}
 	resize( pairs );
 	resampler_size = oversamples_per_frame + (oversamples_per_frame >> 2);
 	RETURN_ERR( resampler.resize_buffer( resampler_size ) );
+	for ( int i = 0; i < voice_count; i++ )
+		RETURN_ERR( voices [i].resampler.resize_buffer( resampler_size ) );
 	resampler.clear();
 	return blargg_ok;
 }
@@ -56,11 +92,34 @@ void Dual_Resampler::clear()
 {
 	buf_pos = buffered = 0;
 	resampler.clear();
+	for ( int i = 0; i < voice_count; i++ )
+		voices [i].resampler.clear();
+}
+
+void Dual_Resampler::copy_state( State_Copier& copier )
+{
+	copier.copy( buf_pos );
+	copier.copy( buffered );
+	copier.copy_var( sample_buf.begin(), buffered * sizeof (dsample_t),
+			sample_buf.size() * sizeof (dsample_t) );
+	resampler.copy_state( copier );
+	if ( voices )
+	{
+		for ( int i = 0; i < voice_count; i++ )
+		{
+			copier.copy_var( voices [i].buf.begin(), buffered * sizeof (dsample_t),
+					voices [i].buf.size() * sizeof (dsample_t) );
+			voices [i].resampler.copy_state( copier );
+		}
+		copier.copy_var( stereo_voice_buf.begin(), buffered * sizeof (dsample_t),
+				stereo_voice_buf.size() * sizeof (dsample_t) );
+	}
 }
 
 
 int Dual_Resampler::play_frame_( Stereo_Buffer& stereo_buf, dsample_t out [], Stereo_Buffer** secondary_buf_set, int secondary_buf_set_count )
 {
+	GME_PROFILE_STAGE( buffer );
 	int pair_count = sample_buf_size >> 1;
 	blip_time_t blip_time = stereo_buf.center()->count_clocks( pair_count );
     int sample_count = oversamples_per_frame - resampler.written() + resampler_extra;
@@ -85,7 +144,22 @@ int Dual_Resampler::play_frame_( Stereo_Buffer& stereo_buf, dsample_t out [], St
 	
 	int count = resampler.read( sample_buf.begin(), sample_buf_size );
 	
-    mix_samples( stereo_buf, out, count, secondary_buf_set, secondary_buf_set_count );
+	if ( voices )
+	{
+		for ( int i = 0; i < voice_count; i++ )
+		{
+			Dual_Resampler_Downsampler& r = voices [i].resampler;
+			r.write( new_count );
+			int n = r.read( voices [i].buf.begin(), sample_buf_size );
+			assert( n == count );
+			(void) n;
+		}
+		mix_voices( stereo_buf, out, count, secondary_buf_set, secondary_buf_set_count );
+	}
+	else
+	{
+		mix_samples( stereo_buf, out, count, secondary_buf_set, secondary_buf_set_count );
+	}
 
 	pair_count = count >> 1;
 	stereo_buf.left()->remove_samples( pair_count );
@@ -106,44 +180,52 @@ int Dual_Resampler::play_frame_( Stereo_Buffer& stereo_buf, dsample_t out [], St
 	return count;
 }
 
+// Copies count buffered samples to out [pos], and voices to voice_out [i] [pos]
+void Dual_Resampler::read_buffered( dsample_t out [], int pos, int count )
+{
+	memcpy( &out [pos], &sample_buf [buf_pos], count * sizeof *out );
+	if ( voice_out )
+	{
+		for ( int i = 0; i <= voice_count; i++ )
+		{
+			if ( voice_out [i] )
+			{
+				dsample_t const* in = (i < voice_count ? voices [i].buf : stereo_voice_buf).begin();
+				memcpy( &voice_out [i] [pos], &in [buf_pos], count * sizeof *out );
+			}
+		}
+	}
+	buf_pos += count;
+}
+
 void Dual_Resampler::dual_play( int count, dsample_t out [], Stereo_Buffer& stereo_buf, Stereo_Buffer** secondary_buf_set, int secondary_buf_set_count )
 {
+	int pos = 0;
+	
 	// empty extra buffer
 	int remain = buffered - buf_pos;
 	if ( remain )
 	{
 		if ( remain > count )
 			remain = count;
-		count -= remain;
-		memcpy( out, &sample_buf [buf_pos], remain * sizeof *out );
-		out += remain;
-		buf_pos += remain;
+		read_buffered( out, pos, remain );
+		pos += remain;
 	}
 	
-	// entire frames
-	while ( count >= sample_buf_size )
+	// entire frames, unless voices need to go through their own buffers
+	while ( !voices && count - pos >= sample_buf_size )
 	{
-        buf_pos = buffered = play_frame_( stereo_buf, out, secondary_buf_set, secondary_buf_set_count );
-		out += buffered;
-		count -= buffered;
+        buf_pos = buffered = play_frame_( stereo_buf, &out [pos], secondary_buf_set, secondary_buf_set_count );
+		pos += buffered;
 	}
 
-	while (count > 0)
+	while ( pos < count )
 	{
         buffered = play_frame_( stereo_buf, sample_buf.begin(), secondary_buf_set, secondary_buf_set_count );
-		if ( buffered >= count )
-		{
-			buf_pos = count;
-			memcpy( out, sample_buf.begin(), count * sizeof *out );
-			out += count;
-			count = 0;
-		}
-		else
-		{
-			memcpy( out, sample_buf.begin(), buffered * sizeof *out );
-			out += buffered;
-			count -= buffered;
-		}
+		buf_pos = 0;
+		int n = min( buffered, count - pos );
+		read_buffered( out, pos, n );
+		pos += n;
 	}
 }
 
@@ -158,13 +240,47 @@ void Dual_Resampler::mix_samples( Stereo_Buffer& stereo_buf, dsample_t out_ [],
     if ( secondary_buf_set && secondary_buf_set_count )
     {
         for ( int i = 0; i < secondary_buf_set_count; i++ )
-        {
-            Stereo_Buffer * second_buf = secondary_buf_set[i];
-            if ( ((Tracked_Blip_Buffer*)second_buf->left())->non_silent() | ((Tracked_Blip_Buffer*)second_buf->right())->non_silent() )
-                mix_extra_stereo( *second_buf, out_, count );
-            else
-                mix_extra_mono( *second_buf, out_, count );
-        }
+            mix_extra( *secondary_buf_set[i], out_, count );
+	}
+}
+
+void Dual_Resampler::mix_extra( Stereo_Buffer& stereo_buf, dsample_t out [], int count )
+{
+	if ( ((Tracked_Blip_Buffer*)stereo_buf.left())->non_silent() | ((Tracked_Blip_Buffer*)stereo_buf.right())->non_silent() )
+		mix_extra_stereo( stereo_buf, out, count );
+	else
+		mix_extra_mono( stereo_buf, out, count );
+}
+
+// Same as mix_samples(), but Stereo_Buffer sound is mixed alone into
+// stereo_voice_buf first, then added to the resampled mix. Each resampled
+// voice gets the same gain as the mix.
+void Dual_Resampler::mix_voices( Stereo_Buffer& stereo_buf, dsample_t out [], int count, Stereo_Buffer** secondary_buf_set, int secondary_buf_set_count )
+{
+	dsample_t* BLARGG_RESTRICT stereo_voice = stereo_voice_buf.begin();
+	memset( stereo_voice, 0, count * sizeof *stereo_voice );
+	mix_extra( stereo_buf, stereo_voice, count );
+	for ( int i = 0; i < secondary_buf_set_count; i++ )
+		mix_extra( *secondary_buf_set [i], stereo_voice, count );
+	
+	int const gain = gain_;
+	dsample_t const* in = sample_buf.begin();
+	for ( int n = 0; n < count; n++ )
+	{
+		int s = (in [n] * gain >> gain_bits) + stereo_voice [n];
+		BLIP_CLAMP( s, s );
+		out [n] = (dsample_t) s;
+	}
+	
+	for ( int i = 0; i < voice_count; i++ )
+	{
+		dsample_t* BLARGG_RESTRICT v = voices [i].buf.begin();
+		for ( int n = 0; n < count; n++ )
+		{
+			int s = v [n] * gain >> gain_bits;
+			BLIP_CLAMP( s, s );
+			v [n] = (dsample_t) s;
+		}
 	}
 }
 
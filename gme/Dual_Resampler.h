@@ -5,6 +5,7 @@
 #define DUAL_RESAMPLER_H
 
 #include "Multi_Buffer.h"
+class State_Copier;
 
 #if GME_VGM_FAST_RESAMPLER
 	#include "Downsampler.h"
@@ -24,9 +25,23 @@ public:
 	void resize( int pairs_per_frame );
 	void clear();
 	
+	// Saves/loads buffered samples and resampler state
+	void copy_state( State_Copier& );
+	
     void dual_play( int count, dsample_t out [], Stereo_Buffer&, Stereo_Buffer** secondary_buf_set = NULL, int secondary_buf_set_count = 0 );
 	
 	blargg_callback<int (*)( void*, blip_time_t, int, dsample_t* )> set_callback;
+	
+	// Keeps count voices of oversampled input separate, each resampled on its
+	// own, in addition to their mix. Must be called before setup().
+	blargg_err_t separate_voices( int count );
+	
+	// Where callback writes voice i's samples, as many as it writes for the mix
+	dsample_t* voice_buffer( int i )    { return voices [i].resampler.buffer(); }
+	
+	// Makes dual_play() also write voice i to out [i] and the Stereo_Buffer
+	// sound to out [count], skipping NULL ones, or stop if out is NULL
+	void set_voice_out( dsample_t* const out [] ) { voice_out = out; }
 
 // Implementation
 public:
@@ -44,6 +59,21 @@ private:
 	int gain_;
 	
 	Dual_Resampler_Downsampler resampler;
+	
+	// Resampled voices of current frame, then Stereo_Buffer sound alone
+	struct voice_t
+	{
+		Dual_Resampler_Downsampler resampler;
+		blargg_vector<dsample_t> buf;
+	};
+	voice_t* voices;                // NULL unless voices are kept separate
+	int voice_count;
+	blargg_vector<dsample_t> stereo_voice_buf;
+	dsample_t* const* voice_out;    // NULL if voice output isn't wanted
+	
+	void read_buffered( dsample_t out [], int pos, int count );
+	void mix_voices( Stereo_Buffer&, dsample_t [], int, Stereo_Buffer**, int );
+	void mix_extra( Stereo_Buffer&, dsample_t [], int );
     void mix_samples( Stereo_Buffer&, dsample_t [], int, Stereo_Buffer**, int );
 	void mix_mono( Stereo_Buffer&, dsample_t [], int );
 	void mix_stereo( Stereo_Buffer&, dsample_t [], int );
@@ -52,10 +82,4 @@ private:
     int play_frame_( Stereo_Buffer&, dsample_t [], Stereo_Buffer**, int );
 };
 
-inline blargg_err_t Dual_Resampler::setup( double oversample, double rolloff, double gain )
-{
-	gain_ = (int) ((1 << gain_bits) * gain);
-	return resampler.set_rate( oversample );
-}
-
 #endif
@@ -2,6 +2,9 @@
 
 #include "Effects_Buffer.h"
 
+#include "State_Copier.h"
+#include "Gme_Profiler.h"
+
 /* Copyright (C) 2006-2007 Shay Green. This module is free software; you
 can redistribute it and/or modify it under the terms of the GNU Lesser
 General Public License as published by the Free Software Foundation; either
@@ -25,6 +28,12 @@ int const fixed_shift = 12;
 
 int const max_read = 2560; // determines minimum delay
 
+#if BLARGG_SSE2
+	int const max_mix = 512; // mix_effects() keeps dry mix on stack
+#else
+	int const max_mix = max_read;
+#endif
+
 Effects_Buffer::Effects_Buffer( int max_bufs, int echo_size_ ) : Multi_Buffer( stereo )
 {
 	echo_size   = max( max_read * (int) stereo, echo_size_ & ~1 );
@@ -32,6 +41,7 @@ Effects_Buffer::Effects_Buffer( int max_bufs, int echo_size_ ) : Multi_Buffer( s
 	bass_freq_  = 90;
 	bufs        = NULL;
 	bufs_size   = 0;
+	bufs_used   = 0;
 	bufs_max    = max( max_bufs, (int) extra_chans );
 	no_echo     = true;
 	no_effects  = true;
@@ -79,27 +89,44 @@ void Effects_Buffer::delete_bufs()
 		bufs = NULL;
 	}
 	bufs_size = 0;
+	bufs_used = 0;
+}
+
+// Gives memory to next unused buffer and puts it in sync with the others
+blargg_err_t Effects_Buffer::add_buf()
+{
+	assert( bufs_used < bufs_size );
+	buf_t& b = bufs [bufs_used];
+	RETURN_ERR( b.set_sample_rate( sample_rate(), length() ) );
+	b.clock_rate( clock_rate_ );
+	b.bass_freq( bass_freq_ );
+	if ( bufs_used )
+		b.sync_time( bufs [0] );
+	bufs_used++;
+	return blargg_ok;
 }
 
 blargg_err_t Effects_Buffer::set_sample_rate( int rate, int msec )
 {
-	// extra to allow farther past-the-end pointers
 	mixer.samples_read = 0;
-	RETURN_ERR( echo.resize( echo_size + stereo ) );
+	
+	// keep in sync with buffers added later
+	for ( int i = bufs_used; --i >= 0; )
+		RETURN_ERR( bufs [i].set_sample_rate( rate, msec ) );
 	return Multi_Buffer::set_sample_rate( rate, msec );
 }
 
 void Effects_Buffer::clock_rate( int rate )
 {
 	clock_rate_ = rate;
-	for ( int i = bufs_size; --i >= 0; )
+	for ( int i = bufs_used; --i >= 0; )
 		bufs [i].clock_rate( clock_rate_ );
 }
 
 void Effects_Buffer::bass_freq( int freq )
 {
 	bass_freq_ = freq;
-	for ( int i = bufs_size; --i >= 0; )
+	for ( int i = bufs_used; --i >= 0; )
 		bufs [i].bass_freq( bass_freq_ );
 }
 
@@ -113,10 +140,10 @@ blargg_err_t Effects_Buffer::set_channel_count( int count, int const types [] )
 	
 	RETURN_ERR( chans.resize( count + extra_chans ) );
 	
+	// others are only given memory once assign_buffers() needs them
 	RETURN_ERR( new_bufs( min( bufs_max, count + extra_chans ) ) );
-	
-	for ( int i = bufs_size; --i >= 0; )
-		RETURN_ERR( bufs [i].set_sample_rate( sample_rate(), length() ) );
+	for ( int i = 0; i < 3; i++ ) // mixer always uses first three
+		RETURN_ERR( add_buf() );
 	
 	for ( int i = chans.size(); --i >= 0; )
 	{
@@ -130,8 +157,6 @@ blargg_err_t Effects_Buffer::set_channel_count( int count, int const types [] )
 	chans [2].cfg.echo = true;
 	chans [3].cfg.echo = true;
 	
-	clock_rate( clock_rate_ );
-	bass_freq( bass_freq_ );
 	apply_config();
 	clear();
 	
@@ -151,11 +176,68 @@ void Effects_Buffer::clear()
 	s.low_pass [1] = 0;
 	mixer.samples_read = 0;
 	
-	for ( int i = bufs_size; --i >= 0; )
+	for ( int i = bufs_used; --i >= 0; )
 		bufs [i].clear();
 	clear_echo();
 }
 
+void Effects_Buffer::copy_state( State_Copier& copier )
+{
+	copier.tag( BLARGG_4CHAR('E','F','F','b') );
+	
+	// only buffers that have been used are saved
+	int count = bufs_used;
+	copier.copy( count );
+	if ( (unsigned) count > (unsigned) bufs_size )
+	{
+		copier.set_error( BLARGG_ERR( BLARGG_ERR_FILE_CORRUPT, "state" ) );
+		count = bufs_used;
+	}
+	while ( bufs_used < count )
+	{
+		blargg_err_t err = add_buf();
+		if ( err )
+		{
+			copier.set_error( err );
+			count = bufs_used;
+		}
+	}
+	
+	copier.copy( mixer.samples_read );
+	for ( int i = 0; i < count; i++ )
+		bufs [i].copy_state( copier );
+	
+	// any others were silent when saved
+	for ( int i = count; i < bufs_used; i++ )
+	{
+		bufs [i].clear();
+		bufs [i].sync_time( bufs [0] );
+	}
+	
+	// echo is only meaningful while enabled, and might not be when loading
+	copier.copy( echo_pos );
+	if ( (unsigned) echo_pos >= (unsigned) echo_size )
+		copier.set_error( BLARGG_ERR( BLARGG_ERR_FILE_CORRUPT, "state" ) );
+	copier.copy( s.low_pass );
+	int echo_count = (no_echo || no_effects ? 0 : (int) echo.size());
+	copier.copy( echo_count );
+	if ( copier.loading() && echo_count && !echo.size() )
+	{
+		blargg_err_t err = echo.resize( echo_size + stereo );
+		if ( err )
+			copier.set_error( err );
+	}
+	copier.copy_var( echo.begin(), echo_count * sizeof echo [0],
+			(echo_size + stereo) * sizeof echo [0] );
+	if ( copier.loading() && (echo_count == 0) != (no_echo || no_effects) )
+	{
+		echo_pos       = 0;
+		s.low_pass [0] = 0;
+		s.low_pass [1] = 0;
+		clear_echo();
+	}
+}
+
 Effects_Buffer::channel_t Effects_Buffer::channel( int i )
 {
 	i += extra_chans;
@@ -290,16 +372,6 @@ void Effects_Buffer::apply_config()
 			ch.vol [0] = -ch.vol [0];
 	}
 	
-	assign_buffers();
-	
-	// set side channels
-	for ( i = chans.size(); --i >= 0; )
-	{
-		chan_t& ch = chans [i];
-		ch.channel.left  = chans [ch.cfg.echo*2  ].channel.center;
-		ch.channel.right = chans [ch.cfg.echo*2+1].channel.center;
-	}
-	
 	bool old_echo = !no_echo && !no_effects;
 	
 	// determine whether effects and echo are needed at all
@@ -326,6 +398,17 @@ void Effects_Buffer::apply_config()
 	if ( !config_.enabled )
 		no_effects = true;
 	
+	// echo is only given memory once effects are used; effects stay
+	// disabled if it can't be
+	if ( !no_effects && !echo.size() )
+	{
+		// extra to allow farther past-the-end pointers
+		if ( echo.resize( echo_size + stereo ) )
+			no_effects = true;
+		else
+			clear_echo();
+	}
+	
 	if ( no_effects )
 	{
 		for ( i = chans.size(); --i >= 0; )
@@ -336,6 +419,18 @@ void Effects_Buffer::apply_config()
 			ch.channel.right  = &bufs [1];
 		}
 	}
+	else
+	{
+		assign_buffers();
+		
+		// set side channels
+		for ( i = chans.size(); --i >= 0; )
+		{
+			chan_t& ch = chans [i];
+			ch.channel.left  = chans [ch.cfg.echo*2  ].channel.center;
+			ch.channel.right = chans [ch.cfg.echo*2+1].channel.center;
+		}
+	}
 	
 	mixer.bufs [0] = &bufs [0];
 	mixer.bufs [1] = &bufs [1];
@@ -373,7 +468,9 @@ void Effects_Buffer::assign_buffers()
 		
 		if ( b >= buf_count )
 		{
-			if ( buf_count < bufs_max )
+			// a buffer is only given memory when first needed, so memory
+			// usage depends on number of distinct configurations
+			if ( buf_count < bufs_used || (buf_count < bufs_size && !add_buf()) )
 			{
 				bufs [b].vol [0] = ch.vol [0];
 				bufs [b].vol [1] = ch.vol [1];
@@ -429,11 +526,22 @@ void Effects_Buffer::assign_buffers()
 
 void Effects_Buffer::end_frame( blip_time_t time )
 {
-	for ( int i = bufs_size; --i >= 0; )
+	for ( int i = bufs_used; --i >= 0; )
 		bufs [i].end_frame( time );
 }
 
 int Effects_Buffer::read_samples( blip_sample_t out [], int out_size )
+{
+	return read_samples_( out, out_size );
+}
+
+int Effects_Buffer::read_samples_wide( blip_wide_sample_t out [], int out_size )
+{
+	return read_samples_( out, out_size );
+}
+
+template<class T>
+int Effects_Buffer::read_samples_( T out [], int out_size )
 {
 	out_size = min( out_size, samples_avail() );
 	
@@ -447,11 +555,12 @@ int Effects_Buffer::read_samples( blip_sample_t out [], int out_size )
 		}
 		else
 		{
+			GME_PROFILE_STAGE( effects );
 			int pairs_remain = pair_count;
 			do
 			{
-				// mix at most max_read pairs at a time
-				int count = max_read;
+				// mix at most max_mix pairs at a time
+				int count = max_mix;
 				if ( count > pairs_remain )
 					count = pairs_remain;
 				
@@ -477,34 +586,365 @@ int Effects_Buffer::read_samples( blip_sample_t out [], int out_size )
 		}
 		
 		if ( samples_avail() <= 0 || immediate_removal() )
+			remove_read_samples();
+	}
+	return out_size;
+}
+
+int Effects_Buffer::skip_samples( int out_size )
+{
+	// effects have state of their own, so they must be run as usual
+	if ( !no_effects )
+		return Multi_Buffer::skip_samples( out_size );
+	
+	out_size = min( out_size, samples_avail() );
+	
+	int pair_count = int (out_size >> 1);
+	require( pair_count * stereo == out_size ); // must skip an even number of samples
+	if ( pair_count )
+	{
+		mixer.skip_pairs( pair_count );
+		
+		if ( samples_avail() <= 0 || immediate_removal() )
+			remove_read_samples();
+	}
+	return out_size;
+}
+
+void Effects_Buffer::remove_read_samples()
+{
+	for ( int i = bufs_used; --i >= 0; )
+	{
+		buf_t& b = bufs [i];
+		// TODO: might miss non-silence settling since it checks END of last read
+		if ( b.non_silent() )
+			b.remove_samples( mixer.samples_read );
+		else
+			b.remove_silence( mixer.samples_read );
+	}
+	mixer.samples_read = 0;
+}
+
+// Runs low-pass and feedback for both channels of echo together, since each is
+// a chain of dependent multiplies
+void Effects_Buffer::run_echo( int pair_count )
+{
+	typedef fixed_t stereo_fixed_t [stereo];
+	
+	fixed_t const feedback = s.feedback;
+	fixed_t const treble   = s.treble;
+	fixed_t low_pass_0 = s.low_pass [0];
+	fixed_t low_pass_1 = s.low_pass [1];
+	
+	stereo_fixed_t* const echo_end = (stereo_fixed_t*) &echo [echo_size];
+	stereo_fixed_t const* BLARGG_RESTRICT in_pos = (stereo_fixed_t*) &echo [echo_pos];
+	stereo_fixed_t* out_pos [stereo];
+	for ( int i = stereo; --i >= 0; )
+	{
+		int out_offset = echo_pos + s.delay [i];
+		if ( out_offset >= echo_size )
+			out_offset -= echo_size;
+		assert( out_offset < echo_size );
+		out_pos [i] = (stereo_fixed_t*) &echo [out_offset];
+	}
+	
+	// break into up to four chunks to avoid having to handle wrap-around
+	// in middle of core loop
+	int remain = pair_count;
+	do
+	{
+		stereo_fixed_t const* pos = in_pos;
+		if ( pos < out_pos [0] )
+			pos = out_pos [0];
+		if ( pos < out_pos [1] )
+			pos = out_pos [1];
+		int count = echo_end - pos;
+		if ( count > remain )
+			count = remain;
+		remain -= count;
+		
+		in_pos += count;
+		stereo_fixed_t* BLARGG_RESTRICT out_0 = (out_pos [0] += count);
+		stereo_fixed_t* BLARGG_RESTRICT out_1 = (out_pos [1] += count);
+		int offset = -count;
+		do
+		{
+			low_pass_0 += FROM_FIXED( in_pos [offset] [0] - low_pass_0 ) * treble;
+			low_pass_1 += FROM_FIXED( in_pos [offset] [1] - low_pass_1 ) * treble;
+			out_0 [offset] [0] = FROM_FIXED( low_pass_0 ) * feedback;
+			out_1 [offset] [1] = FROM_FIXED( low_pass_1 ) * feedback;
+		}
+		while ( ++offset );
+		
+		if ( in_pos >= echo_end )
+			in_pos -= echo_size / stereo;
+		for ( int i = stereo; --i >= 0; )
+			if ( out_pos [i] >= echo_end )
+				out_pos [i] -= echo_size / stereo;
+	}
+	while ( remain );
+	
+	s.low_pass [0] = low_pass_0;
+	s.low_pass [1] = low_pass_1;
+}
+
+#if BLARGG_SSE2
+
+#define SHUFFLE_LANES( a, b, imm ) _mm_castps_si128( \
+		_mm_shuffle_ps( _mm_castsi128_ps( a ), _mm_castsi128_ps( b ), imm ) )
+
+// Advances integrators in acc by one sample and sets lanes 0 and 2 of l and r
+// to left and right sums of lanes 0 and 1, and of lanes 2 and 3. SSE2 lacks a
+// 32-bit multiply, so even and odd lanes are done separately.
+#define MIX_LANES_STEP( l, r, d ) \
+{\
+	__m128i s = _mm_srai_epi32( acc, Blip_Buffer::delta_bits );\
+	acc = _mm_sub_epi32( acc, _mm_sra_epi32( acc, bass ) );\
+	acc = _mm_add_epi32( acc, d );\
+	__m128i odd = _mm_srli_epi64( s, 32 );\
+	l = _mm_add_epi32( _mm_mul_epu32( s, vol_l ), _mm_mul_epu32( odd, vol_l_odd ) );\
+	r = _mm_add_epi32( _mm_mul_epu32( s, vol_r ), _mm_mul_epu32( odd, vol_r_odd ) );\
+}
+
+// Adds sums of two samples' lanes 0 and 1 to out_0, and lanes 2 and 3 to out_1
+#define MIX_LANES_OUT( l0, r0, l1, r1 ) \
+{\
+	__m128i x0 = SHUFFLE_LANES( l0, r0, _MM_SHUFFLE( 2, 0, 2, 0 ) );\
+	__m128i x1 = SHUFFLE_LANES( l1, r1, _MM_SHUFFLE( 2, 0, 2, 0 ) );\
+	__m128i* o0 = (__m128i*) out_0;\
+	__m128i* o1 = (__m128i*) out_1;\
+	_mm_storeu_si128( o0, _mm_add_epi32( _mm_loadu_si128( o0 ),\
+			SHUFFLE_LANES( x0, x1, _MM_SHUFFLE( 2, 0, 2, 0 ) ) ) );\
+	_mm_storeu_si128( o1, _mm_add_epi32( _mm_loadu_si128( o1 ),\
+			SHUFFLE_LANES( x0, x1, _MM_SHUFFLE( 3, 1, 3, 1 ) ) ) );\
+	out_0 += 2 * Effects_Buffer::stereo;\
+	out_1 += 2 * Effects_Buffer::stereo;\
+}
+
+// Runs integrators of four buffers in parallel lanes, for count samples, and
+// adds their output times vol [0] and vol [1] to out_0 and out_1 as pairs
+static void mix_lanes_( Blip_Buffer::delta_t const* in [4], __m128i& acc_io, __m128i bass,
+		__m128i const vol [2], Effects_Buffer::fixed_t* out_0,
+		Effects_Buffer::fixed_t* out_1, int count )
+{
+	__m128i const vol_l = vol [0];
+	__m128i const vol_r = vol [1];
+	__m128i const vol_l_odd = _mm_srli_epi64( vol_l, 32 );
+	__m128i const vol_r_odd = _mm_srli_epi64( vol_r, 32 );
+	Blip_Buffer::delta_t const* in_0 = in [0];
+	Blip_Buffer::delta_t const* in_1 = in [1];
+	Blip_Buffer::delta_t const* in_2 = in [2];
+	Blip_Buffer::delta_t const* in_3 = in [3];
+	__m128i acc = acc_io;
+	
+	for ( int n = count >> 2; n; --n )
+	{
+		__m128i a = _mm_loadu_si128( (__m128i const*) in_0 );
+		__m128i b = _mm_loadu_si128( (__m128i const*) in_1 );
+		__m128i c = _mm_loadu_si128( (__m128i const*) in_2 );
+		__m128i d = _mm_loadu_si128( (__m128i const*) in_3 );
+		in_0 += 4;
+		in_1 += 4;
+		in_2 += 4;
+		in_3 += 4;
+		
+		// transpose into one vector of four buffers' deltas per sample
+		__m128i ab = _mm_unpacklo_epi32( a, b );
+		__m128i cd = _mm_unpacklo_epi32( c, d );
+		a = _mm_unpackhi_epi32( a, b );
+		c = _mm_unpackhi_epi32( c, d );
+		
+		__m128i l0, r0, l1, r1;
+		MIX_LANES_STEP( l0, r0, _mm_unpacklo_epi64( ab, cd ) )
+		MIX_LANES_STEP( l1, r1, _mm_unpackhi_epi64( ab, cd ) )
+		MIX_LANES_OUT( l0, r0, l1, r1 )
+		MIX_LANES_STEP( l0, r0, _mm_unpacklo_epi64( a, c ) )
+		MIX_LANES_STEP( l1, r1, _mm_unpackhi_epi64( a, c ) )
+		MIX_LANES_OUT( l0, r0, l1, r1 )
+	}
+	
+	for ( int n = count & 3; n; --n )
+	{
+		__m128i l, r;
+		MIX_LANES_STEP( l, r, _mm_setr_epi32( *in_0++, *in_1++, *in_2++, *in_3++ ) )
+		
+		// left and right of lanes 0 and 1, then of lanes 2 and 3
+		__m128i x = _mm_shuffle_epi32( SHUFFLE_LANES( l, r, _MM_SHUFFLE( 2, 0, 2, 0 ) ),
+				_MM_SHUFFLE( 3, 1, 2, 0 ) );
+		__m128i* o0 = (__m128i*) out_0;
+		__m128i* o1 = (__m128i*) out_1;
+		_mm_storel_epi64( o0, _mm_add_epi32( _mm_loadl_epi64( o0 ), x ) );
+		_mm_storel_epi64( o1, _mm_add_epi32( _mm_loadl_epi64( o1 ),
+				_mm_unpackhi_epi64( x, x ) ) );
+		out_0 += Effects_Buffer::stereo;
+		out_1 += Effects_Buffer::stereo;
+	}
+	
+	in [0] = in_0;
+	in [1] = in_1;
+	in [2] = in_2;
+	in [3] = in_3;
+	acc_io = acc;
+}
+
+#undef MIX_LANES_OUT
+#undef MIX_LANES_STEP
+#undef SHUFFLE_LANES
+
+// Mixes up to four buffers in lanes, where NULL is an unused lane. Buffers in
+// lanes 0 and 1 go to echo if pair_echo [0] is set, otherwise dry, and
+// similarly for lanes 2 and 3 and pair_echo [1].
+void Effects_Buffer::mix_lanes( buf_t* const lane [4], bool const pair_echo [2],
+		fixed_t dry [], int pair_count )
+{
+	Blip_Buffer::delta_t const* in [4];
+	int acc [4];
+	fixed_t vol [stereo] [4];
+	for ( int i = 0; i < 4; i++ )
+	{
+		// unused lane reads from another buffer and has no volume
+		buf_t* b = (lane [i] ? lane [i] : lane [0]);
+		in  [i] = b->read_pos() + mixer.samples_read;
+		acc [i] = b->integrator();
+		vol [0] [i] = (lane [i] ? b->vol [0] : 0);
+		vol [1] [i] = (lane [i] ? b->vol [1] : 0);
+	}
+	
+	// all buffers have same bass frequency
+	__m128i const bass = _mm_cvtsi32_si128( lane [0]->highpass_shift() );
+	__m128i sum = _mm_loadu_si128( (__m128i const*) acc );
+	__m128i const vols [stereo] = {
+		_mm_loadu_si128( (__m128i const*) vol [0] ),
+		_mm_loadu_si128( (__m128i const*) vol [1] )
+	};
+	
+	// echo might wrap around, so mix up to that point first
+	int count = (unsigned) (echo_size - echo_pos) / stereo;
+	if ( count > pair_count )
+		count = pair_count;
+	fixed_t* out_echo = &echo [echo_pos];
+	int remain = pair_count;
+	do
+	{
+		remain -= count;
+		mix_lanes_( in, sum, bass, vols,
+				(pair_echo [0] ? out_echo : dry),
+				(pair_echo [1] ? out_echo : dry), count );
+		
+		dry += count * stereo;
+		out_echo = echo.begin();
+		count = remain;
+	}
+	while ( remain );
+	
+	_mm_storeu_si128( (__m128i*) acc, sum );
+	for ( int i = 4; --i >= 0; )
+		if ( lane [i] )
+			lane [i]->set_integrator( acc [i] );
+}
+
+template<class T>
+void Effects_Buffer::mix_effects( T out [], int pair_count )
+{
+	// Buffers without echo are mixed into dry rather than echo, so all can be
+	// mixed before echo is run. Each pair of lanes goes to the same place.
+	fixed_t dry [max_mix * stereo];
+	memset( dry, 0, pair_count * stereo * sizeof dry [0] );
+	
+	buf_t* const bufs_end = bufs + bufs_used;
+	buf_t* lane [4];
+	bool pair_echo [2];
+	int lane_count = 0;
+	for ( int echo_phase = 1; echo_phase >= 0; echo_phase-- )
+	{
+		for ( buf_t* buf = bufs; buf < bufs_end; buf++ )
 		{
-			for ( int i = bufs_size; --i >= 0; )
+			if ( buf->non_silent() && buf->echo == (echo_phase != 0) )
 			{
-				buf_t& b = bufs [i];
-				// TODO: might miss non-silence settling since it checks END of last read
-				if ( b.non_silent() )
-					b.remove_samples( mixer.samples_read );
-				else
-					b.remove_silence( mixer.samples_read );
+				pair_echo [lane_count >> 1] = (echo_phase != 0);
+				lane [lane_count++] = buf;
+				if ( lane_count == 4 )
+				{
+					mix_lanes( lane, pair_echo, dry, pair_count );
+					lane_count = 0;
+				}
 			}
-			mixer.samples_read = 0;
+		}
+		
+		// don't let a pair of lanes have both kinds
+		if ( lane_count & 1 )
+			lane [lane_count++] = NULL;
+		if ( lane_count == 4 )
+		{
+			mix_lanes( lane, pair_echo, dry, pair_count );
+			lane_count = 0;
 		}
 	}
-	return out_size;
+	if ( lane_count )
+	{
+		lane [2] = NULL;
+		lane [3] = NULL;
+		pair_echo [1] = false;
+		mix_lanes( lane, pair_echo, dry, pair_count );
+	}
+	
+	if ( !no_echo )
+		run_echo( pair_count );
+	
+	// add dry to echo, then clamp to 16 bits, unless output is wide
+	fixed_t const* in = &echo [echo_pos];
+	fixed_t const* dry_in = dry;
+	int count = (unsigned) (echo_size - echo_pos) / (unsigned) stereo;
+	int remain = pair_count;
+	if ( count > remain )
+		count = remain;
+	do
+	{
+		remain -= count;
+		for ( int n = count >> 2; n; --n )
+		{
+			__m128i lo = _mm_add_epi32( _mm_loadu_si128( (__m128i const*) in ),
+					_mm_loadu_si128( (__m128i const*) dry_in ) );
+			__m128i hi = _mm_add_epi32( _mm_loadu_si128( (__m128i const*) in + 1 ),
+					_mm_loadu_si128( (__m128i const*) dry_in + 1 ) );
+			blip_store_pairs( out, _mm_srai_epi32( lo, fixed_shift ),
+					_mm_srai_epi32( hi, fixed_shift ) );
+			in     += 4 * stereo;
+			dry_in += 4 * stereo;
+			out    += 4 * stereo;
+		}
+		
+		for ( int n = count & 3; n; --n )
+		{
+			__m128i s = _mm_add_epi32( _mm_loadl_epi64( (__m128i const*) in ),
+					_mm_loadl_epi64( (__m128i const*) dry_in ) );
+			blip_store_pair( out, _mm_srai_epi32( s, fixed_shift ) );
+			in     += stereo;
+			dry_in += stereo;
+			out    += stereo;
+		}
+		
+		in = echo.begin();
+		count = remain;
+	}
+	while ( remain );
 }
 
-void Effects_Buffer::mix_effects( blip_sample_t out_ [], int pair_count )
+#else
+
+template<class T>
+void Effects_Buffer::mix_effects( T out_ [], int pair_count )
 {
 	typedef fixed_t stereo_fixed_t [stereo];
 	
-	// add channels with echo, do echo, add channels without echo, then convert to 16-bit and output
+	// add channels with echo, do echo, add channels without echo, then convert to output
 	int echo_phase = 1;
 	do
 	{
 		// mix any modified buffers
 		{
 			buf_t* buf = bufs;
-			int bufs_remain = bufs_size;
+			int bufs_remain = bufs_used;
 			do
 			{
 				if ( buf->non_silent() && buf->echo == echo_phase )
@@ -551,63 +991,14 @@ void Effects_Buffer::mix_effects( blip_sample_t out_ [], int pair_count )
 		
 		// add echo
 		if ( echo_phase && !no_echo )
-		{
-			fixed_t const feedback = s.feedback;
-			fixed_t const treble   = s.treble;
-			
-			int i = 1;
-			do
-			{
-				fixed_t low_pass = s.low_pass [i];
-				
-				fixed_t* echo_end = &echo [echo_size + i];
-				fixed_t const* BLARGG_RESTRICT in_pos = &echo [echo_pos + i];
-				int out_offset = echo_pos + i + s.delay [i];
-				if ( out_offset >= echo_size )
-					out_offset -= echo_size;
-				assert( out_offset < echo_size );
-				fixed_t* BLARGG_RESTRICT out_pos = &echo [out_offset];
-				
-				// break into up to three chunks to avoid having to handle wrap-around
-				// in middle of core loop
-				int remain = pair_count;
-				do
-				{
-					fixed_t const* pos = in_pos;
-					if ( pos < out_pos )
-						pos = out_pos;
-					int count = (unsigned) ((char*) echo_end - (char const*) pos) /
-							(unsigned) (stereo * sizeof (fixed_t));
-					if ( count > remain )
-						count = remain;
-					remain -= count;
-					
-					in_pos  += count * stereo;
-					out_pos += count * stereo;
-					int offset = -count;
-					do
-					{
-						low_pass += FROM_FIXED( in_pos [offset * stereo] - low_pass ) * treble;
-						out_pos [offset * stereo] = FROM_FIXED( low_pass ) * feedback;
-					}
-					while ( ++offset );
-					
-					if (  in_pos >= echo_end )  in_pos -= echo_size;
-					if ( out_pos >= echo_end ) out_pos -= echo_size;
-				}
-				while ( remain );
-				
-				s.low_pass [i] = low_pass;
-			}
-			while ( --i >= 0 );
-		}
+			run_echo( pair_count );
 	}
 	while ( --echo_phase >= 0 );
 	
-	// clamp to 16 bits
+	// clamp to 16 bits, unless output is wide
 	{
 		stereo_fixed_t const* BLARGG_RESTRICT in = (stereo_fixed_t*) &echo [echo_pos];
-		typedef blip_sample_t stereo_blip_sample_t [stereo];
+		typedef T stereo_blip_sample_t [stereo];
 		stereo_blip_sample_t* BLARGG_RESTRICT out = (stereo_blip_sample_t*) out_;
 		int count = (unsigned) (echo_size - echo_pos) / (unsigned) stereo;
 		int remain = pair_count;
@@ -621,14 +1012,8 @@ void Effects_Buffer::mix_effects( blip_sample_t out_ [], int pair_count )
 			int offset = -count;
 			do
 			{
-				fixed_t in_0 = FROM_FIXED( in [offset] [0] );
-				fixed_t in_1 = FROM_FIXED( in [offset] [1] );
-				
-				BLIP_CLAMP( in_0, in_0 );
-				out [offset] [0] = (blip_sample_t) in_0;
-				
-				BLIP_CLAMP( in_1, in_1 );
-				out [offset] [1] = (blip_sample_t) in_1;
+				blip_store( out [offset] [0], FROM_FIXED( in [offset] [0] ) );
+				blip_store( out [offset] [1], FROM_FIXED( in [offset] [1] ) );
 			}
 			while ( ++offset );
 			
@@ -638,3 +1023,5 @@ void Effects_Buffer::mix_effects( blip_sample_t out_ [], int pair_count )
 		while ( remain );
 	}
 }
+
+#endif
@@ -11,7 +11,9 @@
 class Effects_Buffer : public Multi_Buffer {
 public:
 	// To reduce memory usage, fewer buffers can be used (with a best-fit
-	// approach if there are too few), and maximum echo delay can be reduced
+	// approach if there are too few), and maximum echo delay can be reduced.
+	// Buffers are only given memory as distinct channel configurations need
+	// them, and echo only once effects are enabled.
 	Effects_Buffer( int max_bufs = 32, int echo_size = 24 * 1024 );
 	
 	struct pan_vol_t
@@ -64,7 +66,10 @@ public:
 	channel_t channel( int );
 	void end_frame( blip_time_t );
 	int read_samples( blip_sample_t [], int );
+	int read_samples_wide( blip_wide_sample_t [], int );
+	int skip_samples( int );
 	int samples_avail() const { return (bufs [0].samples_avail() - mixer.samples_read) * 2; }
+	void copy_state( State_Copier& );
 	enum { stereo = 2 };
 	typedef int fixed_t;
 
@@ -100,6 +105,7 @@ private:
 	buf_t* bufs;
 	int bufs_size;
 	int bufs_max; // bufs_size <= bufs_max, to limit memory usage
+	int bufs_used; // bufs [0] to bufs [bufs_used-1] have memory and are kept in sync
 	Stereo_Mixer mixer;
 	
 	struct {
@@ -116,8 +122,15 @@ private:
 	bool no_echo;
 	
 	void assign_buffers();
+	blargg_err_t add_buf();
 	void clear_echo();
-	void mix_effects( blip_sample_t out [], int pair_count );
+	void run_echo( int pair_count );
+	template<class T> int read_samples_( T [], int );
+	void remove_read_samples();
+	template<class T> void mix_effects( T out [], int pair_count );
+#if BLARGG_SSE2
+	void mix_lanes( buf_t* const [4], bool const pair_echo [2], fixed_t dry [], int pair_count );
+#endif
 	blargg_err_t new_bufs( int size );
 	void delete_bufs();
 };
@@ -2,6 +2,7 @@
 
 #include "Fir_Resampler.h"
 
+#include "State_Copier.h"
 #include <math.h>
 
 /* Copyright (C) 2004-2008 Shay Green. This module is free software; you
@@ -62,30 +63,51 @@ void Fir_Resampler_::clear_()
 	Resampler::clear_();
 }
 
-blargg_err_t Fir_Resampler_::set_rate_( double new_factor )
+void Fir_Resampler_::copy_state_( State_Copier& copier )
 {
-	double const rolloff = 0.999;
-	double const gain = 1.0;
+	// impulse positions depend on width
+	int width = width_;
+	copier.copy( width );
+	if ( width != width_ )
+	{
+		copier.set_error( BLARGG_ERR( BLARGG_ERR_CALLER, "state is for different resampling quality" ) );
+		return;
+	}
 	
-	// determine number of sub-phases that yield lowest error
-	double ratio_ = 0.0;
+	int offset = (int) (imp - impulses);
+	copier.copy( offset );
+	imp = impulses + offset;
+}
+
+// Determines number of sub-phases that yield lowest error, and ratio they give
+static int find_res( double new_factor, double* ratio_out )
+{
 	int res = -1;
+	double least_error = 2;
+	double pos = 0;
+	for ( int r = 1; r <= Fir_Resampler_::max_res; r++ )
 	{
-		double least_error = 2;
-		double pos = 0;
-		for ( int r = 1; r <= max_res; r++ )
+		pos += new_factor;
+		double nearest = floor( pos + 0.5 );
+		double error = fabs( pos - nearest );
+		if ( error < least_error )
 		{
-			pos += new_factor;
-			double nearest = floor( pos + 0.5 );
-			double error = fabs( pos - nearest );
-			if ( error < least_error )
-			{
-				res = r;
-				ratio_ = nearest / res;
-				least_error = error;
-			}
+			res = r;
+			*ratio_out = nearest / res;
+			least_error = error;
 		}
 	}
+	return res;
+}
+
+blargg_err_t Fir_Resampler_::set_rate_( double new_factor )
+{
+	require( impulses && width_ );
+	double const rolloff = 0.999;
+	double const gain = 1.0;
+	
+	double ratio_ = 0.0;
+	int const res = find_res( new_factor, &ratio_ );
 	RETURN_ERR( Resampler::set_rate_( ratio_ ) );
 	
 	// how much of input is used for each output sample
@@ -121,3 +143,20 @@ blargg_err_t Fir_Resampler_::set_rate_( double new_factor )
 	
 	return blargg_ok;
 }
+
+void Fir_Resampler_Dynamic::set_width( int width )
+{
+	require( width <= max_width );
+	int const min_width = (width < 4 ? 4 : width);
+	width_ = min_width / 4 * 4 + 2;
+	imp    = NULL;
+}
+
+// Only allocates impulses for the sub-phases the rate needs
+blargg_err_t Fir_Resampler_Dynamic::set_rate_( double new_factor )
+{
+	double ratio;
+	RETURN_ERR( impulses_.resize( find_res( new_factor, &ratio ) * (width_ + 2) ) );
+	impulses = impulses_.begin();
+	return Fir_Resampler_::set_rate_( new_factor );
+}
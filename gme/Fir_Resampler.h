@@ -6,6 +6,10 @@
 
 #include "Resampler.h"
 
+#if BLARGG_SSE2
+	#include <emmintrin.h>
+#endif
+
 template<int width>
 class Fir_Resampler;
 
@@ -16,18 +20,27 @@ typedef Fir_Resampler<24> Fir_Resampler_Good;
 
 // Implementation
 class Fir_Resampler_ : public Resampler {
+public:
+	// Most sub-phases of impulse used to approximate rate
+	enum { max_res = 32 };
+
 protected:
 	virtual blargg_err_t set_rate_( double );
 	virtual void clear_();
+	virtual void copy_state_( State_Copier& );
 
 protected:
 	enum { stereo = 2 };
-	enum { max_res = 32 }; // TODO: eliminate and keep impulses on freestore?
 	sample_t const* imp;
-	int const width_;
+	int width_;
 	sample_t* impulses;
 	
 	Fir_Resampler_( int width, sample_t [] );
+	
+	// Resampling loop shared by all widths. Uses fixed_width points, or width_
+	// if fixed_width is 0.
+	template<int fixed_width>
+	sample_t const* resample_fir( sample_t**, sample_t const*, sample_t const [], int );
 };
 
 // Width is number of points in FIR. More points give better quality and
@@ -36,19 +49,47 @@ template<int width>
 class Fir_Resampler : public Fir_Resampler_ {
 	enum { min_width = (width < 4 ? 4 : width) };
 	enum { adj_width = min_width / 4 * 4 + 2 };
-	enum { write_offset = adj_width * stereo };
 	short impulses [max_res * (adj_width + 2)];
 public:
 	Fir_Resampler() : Fir_Resampler_( adj_width, impulses ) { }
 
 protected:
-	virtual sample_t const* resample_( sample_t**, sample_t const*, sample_t const [], int );
+	virtual sample_t const* resample_( sample_t** out, sample_t const* out_end,
+			sample_t const in [], int in_size )
+	{
+		return resample_fir<adj_width>( out, out_end, in, in_size );
+	}
 };
 
-template<int width>
-Resampler::sample_t const* Fir_Resampler<width>::resample_( sample_t** out_,
+// Same as Fir_Resampler, but width is set at run-time and impulses are
+// allocated for only as many sub-phases as the rate needs. Somewhat slower.
+class Fir_Resampler_Dynamic : public Fir_Resampler_ {
+public:
+	// Sets number of points in FIR, from 4 to max_width. Takes effect at next
+	// set_rate(), which must be called before resampling.
+	enum { max_width = 256 };
+	void set_width( int width );
+	
+	Fir_Resampler_Dynamic() : Fir_Resampler_( 0, NULL ) { }
+
+protected:
+	virtual blargg_err_t set_rate_( double );
+	virtual sample_t const* resample_( sample_t** out, sample_t const* out_end,
+			sample_t const in [], int in_size )
+	{
+		return resample_fir<0>( out, out_end, in, in_size );
+	}
+
+private:
+	blargg_vector<sample_t> impulses_;
+};
+
+template<int fixed_width>
+Resampler::sample_t const* Fir_Resampler_::resample_fir( sample_t** out_,
 		sample_t const* out_end, sample_t const in [], int in_size )
 {
+	int const adj_width = (fixed_width ? fixed_width : width_);
+	int const write_offset = adj_width * stereo;
 	in_size -= write_offset;
 	if ( in_size > 0 )
 	{
@@ -56,6 +97,51 @@ Resampler::sample_t const* Fir_Resampler<width>::resample_( sample_t** out_,
 		sample_t const* const in_end = in + in_size;
 		sample_t const* imp = this->imp;
 		
+	#if BLARGG_SSE2
+		// Four stereo input samples are reordered to LLRR LLRR and multiplied
+		// by impulse pairs duplicated to match, so each 32-bit lane sums two
+		// products of one channel. Same integer sums as code below.
+		do
+		{
+			if ( out >= out_end )
+				break;
+			
+			__m128i sum = _mm_setzero_si128();
+			for ( int n = 0; n < adj_width - 2; n += 4 )
+			{
+				__m128i i = _mm_loadu_si128( (__m128i const*) (in + n * stereo) );
+				i = _mm_shufflelo_epi16( i, _MM_SHUFFLE( 3, 1, 2, 0 ) );
+				i = _mm_shufflehi_epi16( i, _MM_SHUFFLE( 3, 1, 2, 0 ) );
+				__m128i k = _mm_loadl_epi64( (__m128i const*) (imp + n) );
+				k = _mm_unpacklo_epi32( k, k );
+				sum = _mm_add_epi32( sum, _mm_madd_epi16( i, k ) );
+			}
+			
+			// last two points
+			__m128i i = _mm_loadl_epi64( (__m128i const*) (in + (adj_width - 2) * stereo) );
+			i = _mm_shufflelo_epi16( i, _MM_SHUFFLE( 3, 1, 2, 0 ) );
+			__m128i k = _mm_cvtsi32_si128( *(int const*) (imp + adj_width - 2) );
+			k = _mm_unpacklo_epi32( k, k );
+			sum = _mm_add_epi32( sum, _mm_madd_epi16( i, k ) );
+			
+			// [L R L R] -> [L+L R+R]
+			sum = _mm_add_epi32( sum, _mm_shuffle_epi32( sum, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+			sum = _mm_srai_epi32( sum, 15 );
+			int l = _mm_cvtsi128_si32( sum );
+			int r = _mm_cvtsi128_si32( _mm_shuffle_epi32( sum, _MM_SHUFFLE( 1, 1, 1, 1 ) ) );
+			
+			// offsets are relative to where loop below leaves in and imp
+			in  += (adj_width - 2) * stereo;
+			imp += adj_width - 2;
+			in  = (sample_t const*) ((char const*) in  + imp [2]);
+			imp = (sample_t const*) ((char const*) imp + imp [3]);
+			
+			out [0] = sample_t (l);
+			out [1] = sample_t (r);
+			out += 2;
+		}
+		while ( in < in_end );
+	#else
 		do
 		{
 			// accumulate in extended precision
@@ -91,6 +177,7 @@ Resampler::sample_t const* Fir_Resampler<width>::resample_( sample_t** out_,
 			out += 2;
 		}
 		while ( in < in_end );
+	#endif
 		
 		this->imp = imp;
 		*out_ = out;
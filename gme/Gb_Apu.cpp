@@ -2,6 +2,8 @@
 
 #include "Gb_Apu.h"
 
+#include "State_Copier.h"
+
 //#include "gb_apu_logger.h"
 
 /* Copyright (C) 2003-2008 Shay Green. This module is free software; you
@@ -278,6 +280,51 @@ void Gb_Apu::silence_osc( Gb_Osc& o )
 	}
 }
 
+void Gb_Apu::copy_state( State_Copier& copier )
+{
+	copier.copy( regs );
+	copier.copy( last_time );
+	copier.copy( frame_time );
+	copier.copy( frame_phase );
+	
+	for ( int i = 0; i < osc_count; i++ )
+	{
+		Gb_Osc& o = *oscs [i];
+		copier.copy( o.mode );
+		copier.copy( o.last_amp );
+		copier.copy( o.delay );
+		copier.copy( o.length_ctr );
+		copier.copy( o.phase );
+		copier.copy( o.enabled );
+	}
+	
+	Gb_Env* const envs [3] = { &square1, &square2, &noise };
+	for ( int i = 0; i < 3; i++ )
+	{
+		copier.copy( envs [i]->env_delay );
+		copier.copy( envs [i]->volume );
+		copier.copy( envs [i]->env_enabled );
+	}
+	
+	copier.copy( square1.sweep_freq );
+	copier.copy( square1.sweep_delay );
+	copier.copy( square1.sweep_enabled );
+	copier.copy( square1.sweep_neg );
+	copier.copy( noise.divider );
+	copier.copy( wave.sample_buf );
+	copier.copy( wave.agb_mask );
+	
+	if ( copier.loading() )
+	{
+		// Update things derived from mode and registers, without the
+		// transitions that apply_stereo() would add
+		reduce_clicks( reduce_clicks_ );
+		apply_volume();
+		for ( int i = 0; i < osc_count; i++ )
+			oscs [i]->output = oscs [i]->outputs [calc_output( i )];
+	}
+}
+
 void Gb_Apu::apply_stereo()
 {
 	for ( int i = osc_count; --i >= 0; )
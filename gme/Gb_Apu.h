@@ -7,6 +7,7 @@
 #include "Gb_Oscs.h"
 
 struct gb_apu_state_t;
+class State_Copier;
 
 class Gb_Apu {
 public:
@@ -83,6 +84,9 @@ public:
 	
 	// Loads state. You should call reset() BEFORE this.
 	blargg_err_t load_state( gb_apu_state_t const& in );
+	
+	// Saves/loads exact emulation state in place, in a non-portable format
+	void copy_state( State_Copier& );
 
 private:
 	// noncopyable
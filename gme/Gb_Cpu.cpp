@@ -2,6 +2,7 @@
 
 #include "Gb_Cpu.h"
 
+#include "State_Copier.h"
 #include "blargg_endian.h"
 
 /* Copyright (C) 2003-2008 Shay Green. This module is free software; you
@@ -39,6 +40,19 @@ void Gb_Cpu::reset( void* unmapped )
 	blargg_verify_byte_order();
 }
 
+void Gb_Cpu::copy_state( State_Copier& copier )
+{
+	assert( cpu_state == &cpu_state_ );
+	copier.copy( r );
+	for ( int i = 0; i < page_count + 1; i++ )
+	{
+		byte* p = cpu_state_.code_map [i] + GB_CPU_OFFSET( i * page_size );
+		copier.copy_ptr( p );
+		set_code_page( i, p );
+	}
+	copier.copy( cpu_state_.time );
+}
+
 void Gb_Cpu::map_code( addr_t start, int size, void* data )
 {
 	// address range must begin and end on page boundaries
@@ -5,6 +5,7 @@
 #define GB_CPU_H
 
 #include "blargg_common.h"
+class State_Copier;
 
 class Gb_Cpu {
 public:
@@ -48,6 +49,10 @@ public:
 	
 	// Emulator reads this many bytes past end of a page
 	enum { cpu_padding = 8 };
+	
+	// Saves/loads registers, time, and memory map. Memory mapped must be within
+	// blocks already added to copier. Must not be called during emulation.
+	void copy_state( State_Copier& );
 
 	
 // Implementation
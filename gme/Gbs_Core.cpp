@@ -2,6 +2,7 @@
 
 #include "Gbs_Core.h"
 
+#include "State_Copier.h"
 #include "blargg_endian.h"
 
 /* Copyright (C) 2003-2009 Shay Green. This module is free software; you
@@ -189,6 +190,18 @@ blargg_err_t Gbs_Core::run_until( int end )
 	return blargg_ok;
 }
 
+void Gbs_Core::copy_state( State_Copier& copier )
+{
+	copier.add_block( ram, sizeof ram );
+	copier.add_block( rom.mem(), rom.mem_size() );
+	cpu.copy_state( copier );
+	copier.copy( ram );
+	copier.copy( end_time );
+	copier.copy( play_period_ );
+	copier.copy( next_play );
+	apu_.copy_state( copier );
+}
+
 blargg_err_t Gbs_Core::end_frame( int end )
 {
 	RETURN_ERR( run_until( end ) );
@@ -57,6 +57,9 @@ public:
 	// Clocks between calls to play routine
 	time_t play_period() const          { return play_period_; }
 	
+	// Saves/loads CPU, memory, and sound chip state. Must be called between frames.
+	void copy_state( State_Copier& );
+	
 protected:
 	typedef int addr_t;
 	
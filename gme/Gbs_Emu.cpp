@@ -2,6 +2,8 @@
 
 #include "Gbs_Emu.h"
 
+#include "State_Copier.h"
+
 /* Copyright (C) 2003-2009 Shay Green. This module is free software; you
 can redistribute it and/or modify it under the terms of the GNU Lesser
 General Public License as published by the Free Software Foundation; either
@@ -110,6 +112,8 @@ gme_type_t_ const gme_gbs_type [1] = {{ "Game Boy", 0, &new_gbs_emu, &new_gbs_fi
 blargg_err_t Gbs_Emu::load_( Data_Reader& in )
 {
 	RETURN_ERR( core_.load( in ) );
+	add_file_checksum( &header(), sizeof header() );
+	add_file_checksum( core_.rom_().begin(), core_.rom_().file_size() );
 	set_warning( core_.warning() );
 	set_track_count( header().track_count );
 	set_voice_count( Gb_Apu::osc_count );
@@ -155,6 +159,13 @@ blargg_err_t Gbs_Emu::start_track_( int track )
 	return Classic_Emu::start_track_( track );
 }
 
+blargg_err_t Gbs_Emu::copy_state_( State_Copier& copier )
+{
+	copier.tag( BLARGG_4CHAR('G','B','S','s') );
+	core_.copy_state( copier );
+	return copy_buffer_state( copier );
+}
+
 blargg_err_t Gbs_Emu::run_clocks( blip_time_t& duration, int )
 {
 	return core_.end_frame( duration );
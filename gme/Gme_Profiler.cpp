@@ -0,0 +1,102 @@
+// Game_Music_Emu $vers. http://www.slack.net/~ant/
+
+#include "Gme_Profiler.h"
+
+#if GME_PROFILE
+
+#include <chrono>
+
+/* Copyright (C) 2003-2008 Shay Green. This module is free software; you
+can redistribute it and/or modify it under the terms of the GNU Lesser
+General Public License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version. This
+module is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+details. You should have received a copy of the GNU Lesser General Public
+License along with this module; if not, write to the Free Software Foundation,
+Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA */
+
+#include "blargg_source.h"
+
+const char* const Gme_Profiler::stage_names [stage_count] = {
+	"emulate", "buffer", "effects", "resample", "filter", "track"
+};
+
+const char* const Gme_Profiler::chip_names [chip_count] = {
+	"SN76489", "YM2413", "YM2612", "YM2151", "SegaPCM", "RF5C68", "YM2203", "YM2608",
+	"YM2610", "YM3812", "YMF262", "YMZ280B", "RF5C164", "PWM", "AY8910", "GB DMG",
+	"OKIM6258", "OKIM6295", "K051649", "K054539", "HuC6280", "C140", "K053260", "QSound",
+	"DAC Control"
+};
+
+// Profiler that timings made by this thread are added to
+static thread_local Gme_Profiler* active_profiler;
+
+static BOOST::int64_t now_nsec()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+Gme_Profiler::Gme_Profiler()
+{
+	scope = NULL;
+	reset();
+}
+
+void Gme_Profiler::reset()
+{
+	memset( stages, 0, sizeof stages );
+	memset( chips,  0, sizeof chips  );
+}
+
+Gme_Profiler::Activator::Activator( Gme_Profiler* p )
+{
+	saved = active_profiler;
+	active_profiler = p;
+}
+
+Gme_Profiler::Activator::~Activator()
+{
+	active_profiler = saved;
+}
+
+inline void Gme_Profiler::Scope::begin( Gme_Profiler* p, counter_t* c )
+{
+	profiler = p;
+	counter  = c;
+	outer    = p->scope;
+	p->scope = this;
+	nested   = 0;
+	start    = now_nsec();
+}
+
+Gme_Profiler::Scope::Scope( stage_t s, bool active )
+{
+	profiler = NULL;
+	if ( active && active_profiler )
+		begin( active_profiler, &active_profiler->stages [s] );
+}
+
+Gme_Profiler::Scope::Scope( chip_t c, bool active )
+{
+	profiler = NULL;
+	if ( active && active_profiler )
+		begin( active_profiler, &active_profiler->chips [c] );
+}
+
+Gme_Profiler::Scope::~Scope()
+{
+	if ( profiler )
+	{
+		BOOST::int64_t elapsed = now_nsec() - start;
+		counter->nsec += elapsed - nested;
+		counter->calls++;
+		if ( outer )
+			outer->nested += elapsed;
+		profiler->scope = outer;
+	}
+}
+
+#endif
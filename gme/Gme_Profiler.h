@@ -0,0 +1,94 @@
+// Optional timing of each stage of sound generation, enabled by GME_PROFILE
+
+// Game_Music_Emu $vers
+#ifndef GME_PROFILER_H
+#define GME_PROFILER_H
+
+#include "blargg_common.h"
+
+#if GME_PROFILE
+
+class Gme_Profiler {
+public:
+	// Stages of sound generation. Must match gme_profile_stage_t in gme.h.
+	enum stage_t {
+		emulate,    // CPU and sound chip emulation, including synthesis
+		buffer,     // ending frames in and reading from Blip_Buffer, mixing
+		effects,    // echo and stereo of Effects_Buffer
+		resample,   // Fir_Resampler/Linear_Resampler
+		filter,     // SPC output filter
+		track,      // Track_Filter silence detection and fading, and anything else
+		stage_count
+	};
+
+	// Sound chips timed separately by Vgm_Core. Time spent in a chip is not
+	// included in the emulate stage.
+	enum chip_t {
+		sn76489, ym2413, ym2612, ym2151, segapcm, rf5c68, ym2203, ym2608,
+		ym2610, ym3812, ymf262, ymz280b, rf5c164, pwm, ay8910, gbdmg,
+		okim6258, okim6295, k051649, k054539, huc6280, c140, k053260, qsound,
+		dac_control,
+		chip_count
+	};
+
+	struct counter_t
+	{
+		BOOST::int64_t nsec; // time spent, not including nested stages/chips
+		long calls;          // number of times entered
+	};
+	counter_t stages [stage_count];
+	counter_t chips  [chip_count];
+
+	static const char* const stage_names [stage_count];
+	static const char* const chip_names  [chip_count];
+
+	// Clears counters
+	void reset();
+
+	// Makes profiler receive timings made by this thread during lifetime of object.
+	// Nested activation of same profiler has no effect.
+	class Activator {
+	public:
+		Activator( Gme_Profiler* );
+		~Activator();
+	private:
+		Gme_Profiler* saved;
+	};
+
+	// Times code from construction to destruction and adds it to counter in the
+	// active profiler, if any, minus time spent in any nested Scopes.
+	class Scope {
+	public:
+		Scope( stage_t, bool active = true );
+		Scope( chip_t, bool active = true );
+		~Scope();
+	private:
+		Gme_Profiler* profiler;
+		counter_t* counter;
+		Scope* outer;
+		BOOST::int64_t start;
+		BOOST::int64_t nested;
+		void begin( Gme_Profiler*, counter_t* );
+	};
+
+// Implementation
+public:
+	Gme_Profiler();
+
+private:
+	Scope* scope; // innermost running Scope
+};
+
+#define GME_PROFILE_STAGE( stage ) \
+	Gme_Profiler::Scope gme_profile_stage_( Gme_Profiler::stage )
+
+// Times chip if active is true
+#define GME_PROFILE_CHIP( chip, active ) \
+	Gme_Profiler::Scope gme_profile_chip_( Gme_Profiler::chip, active )
+
+#else
+	#define GME_PROFILE_STAGE( stage ) ((void) 0)
+	#define GME_PROFILE_CHIP( chip, active ) ((void) 0)
+#endif
+
+#endif
@@ -2,6 +2,7 @@
 
 #include "Gym_Emu.h"
 
+#include "State_Copier.h"
 #include "blargg_endian.h"
 
 /* Copyright (C) 2003-2008 Shay Green. This module is free software; you
@@ -174,9 +175,7 @@ gme_type_t_ const gme_gym_type [1] = {{ "Sega Genesis", 1, &new_gym_emu, &new_gy
 
 blargg_err_t Gym_Emu::set_sample_rate_( int sample_rate )
 {
-	blip_eq_t eq( -32, 8000, sample_rate );
-	apu.treble_eq( eq );
-	pcm_synth.treble_eq( eq );
+	update_eq( sample_rate );
 	
 	apu.volume( 0.135 * fm_gain * gain() );
 	
@@ -212,6 +211,20 @@ void Gym_Emu::set_tempo_( double t )
 	}
 }
 
+void Gym_Emu::update_eq( int sample_rate )
+{
+	blip_eq_t eq( -32, 8000, sample_rate );
+	eq.synth_quality( quality() );
+	apu.treble_eq( eq );
+	pcm_synth.treble_eq( eq );
+}
+
+void Gym_Emu::set_quality_( int )
+{
+	if ( sample_rate() )
+		update_eq( sample_rate() );
+}
+
 void Gym_Emu::mute_voices_( int mask )
 {
 	Music_Emu::mute_voices_( mask );
@@ -399,6 +412,7 @@ void Gym_Emu::parse_frame()
 
 inline int Gym_Emu::play_frame( blip_time_t blip_time, int sample_count, sample_t buf [] )
 {
+	GME_PROFILE_STAGE( emulate );
 	if ( !track_ended() )
 		parse_frame();
 	
@@ -421,6 +435,25 @@ blargg_err_t Gym_Emu::play_( int count, sample_t out [] )
 	return blargg_ok;
 }
 
+blargg_err_t Gym_Emu::copy_state_( State_Copier& copier )
+{
+	copier.tag( BLARGG_4CHAR('G','Y','M','s') );
+	copier.add_block( file_begin(), file_size() );
+	copier.add_block( &stereo_buf, sizeof stereo_buf );
+	copier.copy_ptr( pos );
+	copier.copy_ptr( loop_begin );
+	copier.copy( loop_remain );
+	copier.copy( pcm_amp );
+	copier.copy( prev_pcm_count );
+	copier.copy( pcm_enabled );
+	copier.copy_ptr( pcm_buf );
+	fm.copy_state( copier );
+	apu.copy_state( copier );
+	resampler.copy_state( copier );
+	stereo_buf.copy_state( copier );
+	return copier.error();
+}
+
 blargg_err_t Gym_Emu::hash_( Hash_Function& out ) const
 {
 	hash_gym_file( header(), log_begin(), file_end() - log_begin(), out );
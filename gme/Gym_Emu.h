@@ -53,6 +53,8 @@ protected:
 	virtual blargg_err_t play_( int count, sample_t [] );
 	virtual void mute_voices_( int );
 	virtual void set_tempo_( double );
+	virtual void set_quality_( int );
+	virtual blargg_err_t copy_state_( State_Copier& );
 
 private:
 	// Log
@@ -81,6 +83,7 @@ private:
 	byte const* log_begin() const { return file_begin() + log_offset; }
 	void parse_frame();
 	void run_pcm( byte const in [], int count );
+	void update_eq( int sample_rate );
 	int play_frame( blip_time_t blip_time, int sample_count, sample_t buf [] );
 	static int play_frame_( void*, blip_time_t, int, sample_t [] );
 };
@@ -2,6 +2,8 @@
 
 #include "Hes_Apu.h"
 
+#include "State_Copier.h"
+
 /* Copyright (C) 2006-2008 Shay Green. This module is free software; you
 can redistribute it and/or modify it under the terms of the GNU Lesser
 General Public License as published by the Free Software Foundation; either
@@ -348,6 +350,33 @@ void Hes_Apu::write_data( blip_time_t time, int addr, int data )
 	}
 }
 
+void Hes_Apu::copy_state( State_Copier& copier )
+{
+	copier.copy( latch );
+	copier.copy( balance );
+	for ( int i = 0; i < osc_count; i++ )
+	{
+		Osc& o = oscs [i];
+		copier.copy( o.wave );
+		copier.copy( o.delay );
+		copier.copy( o.period );
+		copier.copy( o.phase );
+		copier.copy( o.noise_delay );
+		copier.copy( o.noise );
+		copier.copy( o.lfsr );
+		copier.copy( o.control );
+		copier.copy( o.balance );
+		copier.copy( o.dac );
+		copier.copy( o.volume );
+		copier.copy( o.last_amp );
+		copier.copy( o.last_time );
+		
+		// volumes were copied as well, so this only selects outputs
+		if ( copier.loading() )
+			balance_changed( o );
+	}
+}
+
 void Hes_Apu::end_frame( blip_time_t end_time )
 {
 	for ( Osc* osc = &oscs [osc_count]; osc != oscs; )
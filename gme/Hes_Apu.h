@@ -6,6 +6,7 @@
 
 #include "blargg_common.h"
 #include "Blip_Buffer.h"
+class State_Copier;
 
 class Hes_Apu {
 public:
@@ -37,6 +38,9 @@ public:
 	// Sets overall volume, where 1.0 is normal
 	void volume( double v )                 { synth.volume( 1.8 / osc_count / amp_range * v ); }
 	
+	// Saves/loads exact emulation state in place
+	void copy_state( State_Copier& );
+	
 	// Registers are at io_addr to io_addr+io_size-1
 	enum { io_addr = 0x0800 };
 	enum { io_size = 10 };
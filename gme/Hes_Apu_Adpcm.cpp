@@ -2,6 +2,8 @@
 
 #include "Hes_Apu_Adpcm.h"
 
+#include "State_Copier.h"
+
 /* Copyright (C) 2006-2008 Shay Green. This module is free software; you
 can redistribute it and/or modify it under the terms of the GNU Lesser
 General Public License as published by the Free Software Foundation; either
@@ -246,6 +248,14 @@ int Hes_Apu_Adpcm::read_data( blip_time_t time, int addr )
 	return 0xFF;
 }
 
+void Hes_Apu_Adpcm::copy_state( State_Copier& copier )
+{
+	copier.copy( state );
+	copier.copy( last_time );
+	copier.copy( next_timer );
+	copier.copy( last_amp );
+}
+
 void Hes_Apu_Adpcm::end_frame( blip_time_t end_time )
 {
 	run_until( end_time );
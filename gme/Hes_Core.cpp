@@ -2,6 +2,8 @@
 
 #include "Hes_Core.h"
 
+#include "State_Copier.h"
+
 #include "blargg_endian.h"
 
 /* Copyright (C) 2006-2008 Shay Green. This module is free software; you
@@ -385,6 +387,23 @@ static void adjust_time( Hes_Core::time_t& time, Hes_Core::time_t delta )
 	}
 }
 
+void Hes_Core::copy_state( State_Copier& copier )
+{
+	copier.add_block( ram, sizeof ram );
+	copier.add_block( sgx, sizeof sgx );
+	copier.add_block( rom.mem(), rom.mem_size() );
+	cpu.copy_state( copier );
+	for ( int i = 0; i < Hes_Cpu::page_count + 1; i++ )
+		copier.copy_ptr( write_pages [i] );
+	copier.copy( ram );
+	copier.copy( sgx );
+	copier.copy( timer );
+	copier.copy( vdp );
+	copier.copy( irq );
+	apu_.copy_state( copier );
+	adpcm_.copy_state( copier );
+}
+
 blargg_err_t Hes_Core::end_frame( time_t duration )
 {
 	if ( run_cpu( duration ) )
@@ -55,6 +55,9 @@ public:
 	// Ends time frame at time t
 	typedef int time_t;
 	blargg_err_t end_frame( time_t );
+	
+	// Saves/loads CPU, memory, and sound chip state. Must be called between frames.
+	void copy_state( State_Copier& );
 
 // Implementation
 public:
@@ -4,6 +4,7 @@
 
 #include "blargg_endian.h"
 #include "Hes_Core.h"
+#include "State_Copier.h"
 
 //#include "hes_cpu_log.h"
 
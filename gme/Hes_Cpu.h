@@ -5,6 +5,7 @@
 #define HES_CPU_H
 
 #include "blargg_common.h"
+class State_Copier;
 
 class Hes_Cpu {
 public:
@@ -58,6 +59,10 @@ public:
 	// Can read this many bytes past end of a page
 	enum { cpu_padding = 8 };
 	
+	// Saves/loads registers, time, and memory map. Memory mapped must be within
+	// blocks already added to copier. Must not be called during emulation.
+	void copy_state( State_Copier& );
+	
 private:
 	// noncopyable
 	Hes_Cpu( const Hes_Cpu& );
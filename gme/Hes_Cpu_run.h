@@ -84,6 +84,23 @@ void Hes_Cpu::reset()
 	blargg_verify_byte_order();
 }
 
+void Hes_Cpu::copy_state( State_Copier& copier )
+{
+	assert( cpu_state == &cpu_state_ );
+	copier.copy( r );
+	copier.copy( mmr );
+	for ( int i = 0; i < page_count + 1; i++ )
+	{
+		byte const* p = cpu_state_.code_map [i] + HES_CPU_OFFSET( i * page_size );
+		copier.copy_ptr( p );
+		set_mmr( i, mmr [i], p );
+	}
+	copier.copy( cpu_state_.base );
+	copier.copy( cpu_state_.time );
+	copier.copy( irq_time_ );
+	copier.copy( end_time_ );
+}
+
 // Allows MWCW debugger to step through code properly
 #ifdef CPU_BEGIN
 	CPU_BEGIN
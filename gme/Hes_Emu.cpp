@@ -2,6 +2,8 @@
 
 #include "Hes_Emu.h"
 
+#include "State_Copier.h"
+
 #include "blargg_endian.h"
 
 /* Copyright (C) 2006-2008 Shay Green. This module is free software; you
@@ -137,6 +139,8 @@ gme_type_t_ const gme_hes_type [1] = {{ "PC Engine", 256, &new_hes_emu, &new_hes
 blargg_err_t Hes_Emu::load_( Data_Reader& in )
 {
 	RETURN_ERR( core.load( in ) );
+	add_file_checksum( &header(), sizeof header() );
+	add_file_checksum( core.data(), core.data_size() );
 	
 	static const char* const names [Hes_Apu::osc_count + Hes_Apu_Adpcm::osc_count] = {
 		"Wave 1", "Wave 2", "Wave 3", "Wave 4", "Multi 1", "Multi 2", "ADPCM"
@@ -180,6 +184,13 @@ blargg_err_t Hes_Emu::start_track_( int track )
 	return core.start_track( track );
 }
 
+blargg_err_t Hes_Emu::copy_state_( State_Copier& copier )
+{
+	copier.tag( BLARGG_4CHAR('H','E','S','s') );
+	core.copy_state( copier );
+	return copy_buffer_state( copier );
+}
+
 blargg_err_t Hes_Emu::run_clocks( blip_time_t& duration_, int )
 {
 	return core.end_frame( duration_ );
@@ -34,6 +34,7 @@ protected:
 	virtual void set_tempo_( double );
 	virtual void set_voice( int, Blip_Buffer*, Blip_Buffer*, Blip_Buffer* );
 	virtual void update_eq( blip_eq_t const& );
+	virtual blargg_err_t copy_state_( State_Copier& );
 
 private:
 	Hes_Core core;
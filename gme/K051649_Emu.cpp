@@ -3,6 +3,8 @@
 #include "K051649_Emu.h"
 #include "k051649.h"
 
+#include "State_Copier.h"
+
 K051649_Emu::K051649_Emu() { SCC = 0; }
 
 K051649_Emu::~K051649_Emu()
@@ -71,3 +73,10 @@ void K051649_Emu::run( int pair_count, sample_t* out )
 		pair_count -= todo;
 	}
 }
+
+void K051649_Emu::copy_state( State_Copier& copier )
+{
+	int kept [K051649_STATE_KEPT];
+	int kept_count = k051649_state_kept( SCC, kept );
+	copier.copy_with_ptrs( SCC, k051649_state_size(), NULL, 0, kept, kept_count );
+}
@@ -3,6 +3,8 @@
 #include "K053260_Emu.h"
 #include "k053260.h"
 
+#include "State_Copier.h"
+
 K053260_Emu::K053260_Emu() { chip = 0; }
 
 K053260_Emu::~K053260_Emu()
@@ -75,3 +77,10 @@ void K053260_Emu::run( int pair_count, sample_t* out )
 		pair_count -= todo;
 	}
 }
+
+void K053260_Emu::copy_state( State_Copier& copier )
+{
+	int kept [K053260_STATE_KEPT];
+	int kept_count = k053260_state_kept( chip, kept );
+	copier.copy_with_ptrs( chip, k053260_state_size(), NULL, 0, kept, kept_count );
+}
@@ -3,6 +3,8 @@
 #include "K054539_Emu.h"
 #include "k054539.h"
 
+#include "State_Copier.h"
+
 K054539_Emu::K054539_Emu() { chip = 0; }
 
 K054539_Emu::~K054539_Emu()
@@ -77,3 +79,17 @@ void K054539_Emu::run( int pair_count, sample_t* out )
 		pair_count -= todo;
 	}
 }
+
+void K054539_Emu::copy_state( State_Copier& copier )
+{
+	int kept [K054539_STATE_KEPT];
+	int kept_count = k054539_state_kept( chip, kept );
+	copier.copy_with_ptrs( chip, k054539_state_size(), NULL, 0, kept, kept_count );
+	
+	int ram_size;
+	UINT8* ram = k054539_state_ram( chip, &ram_size );
+	copier.copy( ram, ram_size );
+	
+	if ( copier.loading() )
+		k054539_state_loaded( chip );
+}
@@ -2,6 +2,7 @@
 
 #include "Kss_Core.h"
 
+#include "State_Copier.h"
 #include "blargg_endian.h"
 
 /* Copyright (C) 2006-2009 Shay Green. This module is free software; you
@@ -181,6 +182,18 @@ int Kss_Core::cpu_in( time_t, addr_t addr )
 	return 0xFF;
 }
 
+void Kss_Core::copy_state( State_Copier& copier )
+{
+	copier.add_block( ram, sizeof ram );
+	copier.add_block( unmapped_read, sizeof unmapped_read );
+	copier.add_block( unmapped_write, sizeof unmapped_write );
+	copier.add_block( rom.mem(), rom.mem_size() );
+	cpu.copy_state( copier );
+	copier.copy( ram );
+	copier.copy( next_play );
+	copier.copy( gain_updated );
+}
+
 blargg_err_t Kss_Core::end_frame( time_t end )
 {
 	while ( cpu.time() < end )
@@ -50,6 +50,9 @@ public:
 	blargg_err_t start_track( int );
 	
 	blargg_err_t end_frame( time_t );
+	
+	// Saves/loads CPU and memory state. Must be called between frames.
+	void copy_state( State_Copier& );
 
 protected:
 	typedef Z80_Cpu Kss_Cpu;
@@ -2,6 +2,8 @@
 
 #include "Kss_Emu.h"
 
+#include "State_Copier.h"
+
 #include "blargg_endian.h"
 
 /* Copyright (C) 2006-2009 Shay Green. This module is free software; you
@@ -167,7 +169,7 @@ void Kss_Emu::Core::update_gain_()
 	else
 	{
 		g *= 1.2;
-		if ( scc_accessed )
+		if ( scc_gain )
 			g *= 1.4;
 	}
 
@@ -188,6 +190,8 @@ static blargg_err_t new_opl_apu( Opl_Apu::type_t type, Opl_Apu** out )
 blargg_err_t Kss_Emu::load_( Data_Reader& in )
 {
 	RETURN_ERR( core.load( in ) );
+	add_file_checksum( &header(), sizeof header() );
+	add_file_checksum( core.rom_().begin(), core.rom_().file_size() );
 	set_warning( core.warning() );
 
 	set_track_count( get_le16( header().last_track ) + 1 );
@@ -343,6 +347,7 @@ blargg_err_t Kss_Emu::start_track_( int track )
 	#undef ACTION
 
 	core.scc_accessed = false;
+	core.scc_gain     = false;
 	core.update_gain_();
 
 	return core.start_track( track );
@@ -471,10 +476,30 @@ void Kss_Emu::Core::update_gain()
 	if ( scc_accessed )
 	{
 		dprintf( "SCC accessed\n" );
+		scc_gain = true;
 		update_gain_();
 	}
 }
 
+blargg_err_t Kss_Emu::copy_state_( State_Copier& copier )
+{
+	copier.tag( BLARGG_4CHAR('K','S','S','s') );
+	core.copy_state( copier );
+	copier.copy( core.scc_accessed );
+	copier.copy( core.scc_gain );
+	copier.copy( core.scc_enabled );
+	copier.copy( core.ay_latch );
+	
+	#define ACTION( apu ) IF_PTR( core.apu )->copy_state( copier )
+	FOR_EACH_APU( ACTION );
+	#undef ACTION
+	
+	if ( copier.loading() )
+		core.update_gain_(); // depends on scc_gain
+	
+	return copy_buffer_state( copier );
+}
+
 blargg_err_t Kss_Emu::run_clocks( blip_time_t& duration, int )
 {
 	RETURN_ERR( core.end_frame( duration ) );
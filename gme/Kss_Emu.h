@@ -36,6 +36,7 @@ protected:
 	virtual void set_tempo_( double );
 	virtual void set_voice( int, Blip_Buffer*, Blip_Buffer*, Blip_Buffer* );
 	virtual void update_eq( blip_eq_t const& );
+	virtual blargg_err_t copy_state_( State_Copier& );
 	virtual void unload();
 	
 private:
@@ -46,6 +47,7 @@ private:
 		
 		// detection of tunes that use SCC so they can be made louder
 		bool scc_accessed;
+		bool scc_gain; // gain was last updated after SCC was accessed
 		
 		enum { scc_enabled_true = 0xC000 };
 		unsigned scc_enabled; // 0 or 0xC000
@@ -2,6 +2,8 @@
 
 #include "Kss_Scc_Apu.h"
 
+#include "State_Copier.h"
+
 /* Copyright (C) 2006-2008 Shay Green. This module is free software; you
 can redistribute it and/or modify it under the terms of the GNU Lesser
 General Public License as published by the Free Software Foundation; either
@@ -49,6 +51,18 @@ Scc_Apu::Scc_Apu()
 	reset();
 }
 
+void Scc_Apu::copy_state( State_Copier& copier )
+{
+	for ( int i = 0; i < osc_count; i++ )
+	{
+		copier.copy( oscs [i].delay );
+		copier.copy( oscs [i].phase );
+		copier.copy( oscs [i].last_amp );
+	}
+	copier.copy( last_time );
+	copier.copy( regs );
+}
+
 void Scc_Apu::run_until( blip_time_t end_time )
 {
 	for ( int index = 0; index < osc_count; index++ )
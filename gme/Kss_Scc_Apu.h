@@ -6,6 +6,7 @@
 
 #include "blargg_common.h"
 #include "Blip_Buffer.h"
+class State_Copier;
 
 class Scc_Apu {
 public:
@@ -33,6 +34,9 @@ public:
 
 	// Set overall volume, where 1.0 is normal
 	void volume( double );
+	
+	// Saves/loads exact emulation state in place
+	void copy_state( State_Copier& );
 
 	// Set treble equalization
 	void treble_eq( blip_eq_t const& eq )   { synth.treble_eq( eq ); }
@@ -2,6 +2,8 @@
 
 #include "Multi_Buffer.h"
 
+#include "State_Copier.h"
+
 /* Copyright (C) 2003-2008 Shay Green. This module is free software; you
 can redistribute it and/or modify it under the terms of the GNU Lesser
 General Public License as published by the Free Software Foundation; either
@@ -32,6 +34,38 @@ Multi_Buffer::channel_t Multi_Buffer::channel( int /*index*/ )
 	return ch;
 }
 
+void Multi_Buffer::copy_state( State_Copier& copier )
+{
+	copier.set_error( BLARGG_ERR( BLARGG_ERR_LIMITATION, "state saving not supported by custom buffer" ) );
+}
+
+int Multi_Buffer::read_samples_wide( blip_wide_sample_t out [], int count )
+{
+	// read into beginning of out, then widen from end so that no sample is
+	// overwritten before it's read
+	blip_sample_t* in = (blip_sample_t*) out;
+	count = read_samples( in, count );
+	for ( int i = count; --i >= 0; )
+		out [i] = in [i];
+	return count;
+}
+
+int Multi_Buffer::skip_samples( int count )
+{
+	// Callers skip at most this many at a time, so each is a single read
+	// and buffer sees the same sequence of reads as when playing
+	blip_sample_t temp [2048];
+	int total = 0;
+	while ( total < count )
+	{
+		int n = read_samples( temp, min( count - total, (int) (sizeof temp / sizeof *temp) ) );
+		if ( !n )
+			break;
+		total += n;
+	}
+	return total;
+}
+
 // Silent_Buffer
 
 Silent_Buffer::Silent_Buffer() : Multi_Buffer( 1 ) // 0 channels would probably confuse
@@ -42,6 +76,11 @@ Silent_Buffer::Silent_Buffer() : Multi_Buffer( 1 ) // 0 channels would probably
 	chan.right  = NULL;
 }
 
+void Silent_Buffer::copy_state( State_Copier& copier )
+{
+	copier.tag( BLARGG_4CHAR('S','I','L','b') );
+}
+
 // Mono_Buffer
 
 Mono_Buffer::Mono_Buffer() : Multi_Buffer( 1 )
@@ -59,6 +98,12 @@ blargg_err_t Mono_Buffer::set_sample_rate( int rate, int msec )
 	return Multi_Buffer::set_sample_rate( buf.sample_rate(), buf.length() );
 }
 
+void Mono_Buffer::copy_state( State_Copier& copier )
+{
+	copier.tag( BLARGG_4CHAR('M','O','N','b') );
+	buf.copy_state( copier );
+}
+
 
 // Tracked_Blip_Buffer
 
@@ -117,6 +162,12 @@ void Tracked_Blip_Buffer::remove_all_samples()
 		remove_samples( avail );
 }
 
+void Tracked_Blip_Buffer::copy_state( State_Copier& copier )
+{
+	Blip_Buffer::copy_state( copier );
+	copier.copy( last_non_silence );
+}
+
 int Tracked_Blip_Buffer::read_samples( blip_sample_t out [], int count )
 {
 	count = Blip_Buffer::read_samples( out, count );
@@ -124,6 +175,25 @@ int Tracked_Blip_Buffer::read_samples( blip_sample_t out [], int count )
 	return count;
 }
 
+void Tracked_Blip_Buffer::skip_integrator( int offset, int count, int bass )
+{
+	// same integration as Stereo_Mixer, without output
+	delta_t const* in = read_pos() + offset;
+	int sum = integrator();
+	int i = 0;
+	for ( int n = min( count, last_non_silence - offset ); i < n; i++ )
+	{
+		sum -= sum >> bass;
+		sum += in [i];
+	}
+	
+	// rest of deltas are zero, so integrator only settles
+	for ( ; i < count && (sum >> bass); i++ )
+		sum -= sum >> bass;
+	
+	set_integrator( sum );
+}
+
 // Stereo_Buffer
 
 int const stereo = 2;
@@ -165,6 +235,14 @@ void Stereo_Buffer::clear()
 		bufs [i].clear();
 }
 
+void Stereo_Buffer::copy_state( State_Copier& copier )
+{
+	copier.tag( BLARGG_4CHAR('S','T','E','b') );
+	copier.copy( mixer.samples_read );
+	for ( int i = 0; i < bufs_size; i++ )
+		bufs [i].copy_state( copier );
+}
+
 void Stereo_Buffer::end_frame( blip_time_t time )
 {
 	for ( int i = bufs_size; --i >= 0; )
@@ -172,6 +250,17 @@ void Stereo_Buffer::end_frame( blip_time_t time )
 }
 
 int Stereo_Buffer::read_samples( blip_sample_t out [], int out_size )
+{
+	return read_samples_( out, out_size );
+}
+
+int Stereo_Buffer::read_samples_wide( blip_wide_sample_t out [], int out_size )
+{
+	return read_samples_( out, out_size );
+}
+
+template<class T>
+int Stereo_Buffer::read_samples_( T out [], int out_size )
 {
 	require( (out_size & 1) == 0 ); // must read an even number of samples
 	out_size = min( out_size, samples_avail() );
@@ -182,22 +271,41 @@ int Stereo_Buffer::read_samples( blip_sample_t out [], int out_size )
 		mixer.read_pairs( out, pair_count );
 		
 		if ( samples_avail() <= 0 || immediate_removal() )
-		{
-			for ( int i = bufs_size; --i >= 0; )
-			{
-				buf_t& b = bufs [i];
-				// TODO: might miss non-silence settling since it checks END of last read
-				if ( !b.non_silent() )
-					b.remove_silence( mixer.samples_read );
-				else
-					b.remove_samples( mixer.samples_read );
-			}
-			mixer.samples_read = 0;
-		}
+			remove_read_samples();
 	}
 	return out_size;
 }
 
+int Stereo_Buffer::skip_samples( int out_size )
+{
+	require( (out_size & 1) == 0 ); // must skip an even number of samples
+	out_size = min( out_size, samples_avail() );
+
+	int pair_count = int (out_size >> 1);
+	if ( pair_count )
+	{
+		mixer.skip_pairs( pair_count );
+		
+		if ( samples_avail() <= 0 || immediate_removal() )
+			remove_read_samples();
+	}
+	return out_size;
+}
+
+void Stereo_Buffer::remove_read_samples()
+{
+	for ( int i = bufs_size; --i >= 0; )
+	{
+		buf_t& b = bufs [i];
+		// TODO: might miss non-silence settling since it checks END of last read
+		if ( !b.non_silent() )
+			b.remove_silence( mixer.samples_read );
+		else
+			b.remove_samples( mixer.samples_read );
+	}
+	mixer.samples_read = 0;
+}
+
 
 // Stereo_Mixer
 
@@ -205,6 +313,31 @@ int Stereo_Buffer::read_samples( blip_sample_t out [], int out_size )
 // offset goes from negative to zero
 
 void Stereo_Mixer::read_pairs( blip_sample_t out [], int count )
+{
+	read_pairs_( out, count );
+}
+
+void Stereo_Mixer::read_pairs( blip_wide_sample_t out [], int count )
+{
+	read_pairs_( out, count );
+}
+
+// Leaves integrators as read_pairs() would. When buffers have gone silent,
+// this takes only as long as the integrators take to settle.
+void Stereo_Mixer::skip_pairs( int count )
+{
+	int const bass = bufs [2]->highpass_shift();
+	if ( bufs [0]->non_silent() | bufs [1]->non_silent() )
+	{
+		bufs [0]->skip_integrator( samples_read, count, bass );
+		bufs [1]->skip_integrator( samples_read, count, bass );
+	}
+	bufs [2]->skip_integrator( samples_read, count, bass );
+	samples_read += count;
+}
+
+template<class T>
+void Stereo_Mixer::read_pairs_( T out [], int count )
 {
 	// TODO: if caller never marks buffers as modified, uses mono
 	// except that buffer isn't cleared, so caller can encounter
@@ -216,13 +349,14 @@ void Stereo_Mixer::read_pairs( blip_sample_t out [], int count )
 		mix_mono( out, count );
 }
 
-void Stereo_Mixer::mix_mono( blip_sample_t out_ [], int count )
+template<class T>
+void Stereo_Mixer::mix_mono( T out_ [], int count )
 {
 	int const bass = bufs [2]->highpass_shift();
 	Blip_Buffer::delta_t const* center = bufs [2]->read_pos() + samples_read;
 	int center_sum = bufs [2]->integrator();
 	
-	typedef blip_sample_t stereo_blip_sample_t [stereo];
+	typedef T stereo_blip_sample_t [stereo];
 	stereo_blip_sample_t* BLARGG_RESTRICT out = (stereo_blip_sample_t*) out_ + count;
 	int offset = -count;
 	do
@@ -232,19 +366,90 @@ void Stereo_Mixer::mix_mono( blip_sample_t out_ [], int count )
 		center_sum -= center_sum >> bass;
 		center_sum += center [offset];
 		
-		BLIP_CLAMP( s, s );
-		
-		out [offset] [0] = (blip_sample_t) s;
-		out [offset] [1] = (blip_sample_t) s;
+		blip_store( out [offset] [0], s );
+		out [offset] [1] = out [offset] [0];
 	}
 	while ( ++offset );
 	
 	bufs [2]->set_integrator( center_sum );
 }
 
-void Stereo_Mixer::mix_stereo( blip_sample_t out_ [], int count )
+#if BLARGG_SSE2
+
+// Runs left, right, and center integrators in parallel lanes of one register,
+// four samples per iteration
+
+// sum lanes are left, right, center, center; d holds next deltas in same order
+#define MIX_STEREO_STEP( out, d ) \
+{\
+	out = _mm_srai_epi32( _mm_add_epi32( sum, _mm_shuffle_epi32( sum, 0xAA ) ),\
+			Blip_Buffer::delta_bits );\
+	sum = _mm_sub_epi32( sum, _mm_sra_epi32( sum, bass ) );\
+	sum = _mm_add_epi32( sum, d );\
+}
+
+template<class T>
+void Stereo_Mixer::mix_stereo( T out [], int count )
+{
+	__m128i const bass = _mm_cvtsi32_si128( bufs [2]->highpass_shift() );
+	Blip_Buffer::delta_t const* left   = bufs [0]->read_pos() + samples_read - count;
+	Blip_Buffer::delta_t const* right  = bufs [1]->read_pos() + samples_read - count;
+	Blip_Buffer::delta_t const* center = bufs [2]->read_pos() + samples_read - count;
+	
+	int const center_sum = bufs [2]->integrator();
+	__m128i sum = _mm_setr_epi32( bufs [0]->integrator(), bufs [1]->integrator(),
+			center_sum, center_sum );
+	
+	for ( ; count >= 4; count -= 4 )
+	{
+		__m128i l = _mm_loadu_si128( (__m128i const*) left   );
+		__m128i r = _mm_loadu_si128( (__m128i const*) right  );
+		__m128i c = _mm_loadu_si128( (__m128i const*) center );
+		left   += 4;
+		right  += 4;
+		center += 4;
+		
+		// transpose into one left, right, center, center vector per sample
+		__m128i lr = _mm_unpacklo_epi32( l, r );
+		__m128i cc = _mm_unpacklo_epi32( c, c );
+		l = _mm_unpackhi_epi32( l, r );
+		c = _mm_unpackhi_epi32( c, c );
+		
+		__m128i s0, s1, s2, s3;
+		MIX_STEREO_STEP( s0, _mm_unpacklo_epi64( lr, cc ) )
+		MIX_STEREO_STEP( s1, _mm_unpackhi_epi64( lr, cc ) )
+		MIX_STEREO_STEP( s2, _mm_unpacklo_epi64( l, c ) )
+		MIX_STEREO_STEP( s3, _mm_unpackhi_epi64( l, c ) )
+		
+		blip_store_pairs( out, _mm_unpacklo_epi64( s0, s1 ), _mm_unpacklo_epi64( s2, s3 ) );
+		out += 4 * stereo;
+	}
+	
+	for ( ; count; --count )
+	{
+		__m128i s;
+		MIX_STEREO_STEP( s, _mm_setr_epi32( *left, *right, *center, *center ) )
+		++left;
+		++right;
+		++center;
+		
+		blip_store_pair( out, s );
+		out += stereo;
+	}
+	
+	bufs [0]->set_integrator( _mm_cvtsi128_si32( sum ) );
+	bufs [1]->set_integrator( _mm_cvtsi128_si32( _mm_shuffle_epi32( sum, 0x55 ) ) );
+	bufs [2]->set_integrator( _mm_cvtsi128_si32( _mm_shuffle_epi32( sum, 0xAA ) ) );
+}
+
+#undef MIX_STEREO_STEP
+
+#else
+
+template<class T>
+void Stereo_Mixer::mix_stereo( T out_ [], int count )
 {
-	blip_sample_t* BLARGG_RESTRICT out = out_ + count * stereo;
+	T* BLARGG_RESTRICT out = out_ + count * stereo;
 	
 	// do left + center and right + center separately to reduce register load
 	Tracked_Blip_Buffer* const* buf = &bufs [2];
@@ -271,10 +476,8 @@ void Stereo_Mixer::mix_stereo( blip_sample_t out_ [], int count )
 			side_sum   += side   [offset];
 			center_sum += center [offset];
 			
-			BLIP_CLAMP( s, s );
-			
 			++offset; // before write since out is decremented to slightly before end
-			out [offset * stereo] = (blip_sample_t) s;
+			blip_store( out [offset * stereo], s );
 		}
 		while ( offset );
 		
@@ -288,3 +491,5 @@ void Stereo_Mixer::mix_stereo( blip_sample_t out_ [], int count )
 		break;
 	}
 }
+
+#endif
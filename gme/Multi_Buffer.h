@@ -6,6 +6,7 @@
 
 #include "blargg_common.h"
 #include "Blip_Buffer.h"
+class State_Copier;
 
 // Interface to one or more Blip_Buffers mapped to one or more channels
 // consisting of left, center, and right buffers.
@@ -48,6 +49,18 @@ public:
 	virtual void end_frame( blip_time_t )               BLARGG_PURE( ; )
 	virtual int read_samples( blip_sample_t [], int )   BLARGG_PURE( ; )
 	virtual int samples_avail() const                   BLARGG_PURE( ; )
+	
+	// Same as read_samples(), but samples aren't clamped to 16 bits. Default
+	// reads 16-bit samples and widens them.
+	virtual int read_samples_wide( blip_wide_sample_t [], int );
+	
+	// Removes samples exactly as read_samples() would, without generating them.
+	// Used when skipping. Default reads them into a temporary buffer.
+	virtual int skip_samples( int );
+	
+	// Saves/loads unread samples and filter state. Sets error in copier if
+	// not supported by this buffer type.
+	virtual void copy_state( State_Copier& );
 
 private:
 	// noncopyable
@@ -93,6 +106,7 @@ public:
 	virtual int read_samples( blip_sample_t p [], int s )   { return buf.read_samples( p, s ); }
 	virtual channel_t channel( int )                        { return chan; }
 	virtual void end_frame( blip_time_t t )                 { buf.end_frame( t ); }
+	virtual void copy_state( State_Copier& );
 
 private:
 	Blip_Buffer buf;
@@ -117,6 +131,8 @@ private:
 		Tracked_Blip_Buffer();
 		void clear();
 		void end_frame( blip_time_t );
+		void copy_state( State_Copier& );
+		void skip_integrator( int offset, int count, int bass );
 	
 	private:
 		int last_non_silence;
@@ -132,10 +148,13 @@ private:
 		
 		Stereo_Mixer() : samples_read( 0 ) { }
 		void read_pairs( blip_sample_t out [], int count );
+		void read_pairs( blip_wide_sample_t out [], int count );
+		void skip_pairs( int count );
 	
 	private:
-		void mix_mono  ( blip_sample_t out [], int pair_count );
-		void mix_stereo( blip_sample_t out [], int pair_count );
+		template<class T> void read_pairs_( T out [], int count );
+		template<class T> void mix_mono  ( T out [], int pair_count );
+		template<class T> void mix_stereo( T out [], int pair_count );
 	};
 
 
@@ -160,6 +179,9 @@ public:
 	virtual void end_frame( blip_time_t );
 	virtual int samples_avail() const           { return (bufs [0].samples_avail() - mixer.samples_read) * 2; }
 	virtual int read_samples( blip_sample_t [], int );
+	virtual int read_samples_wide( blip_wide_sample_t [], int );
+	virtual int skip_samples( int );
+	virtual void copy_state( State_Copier& );
 	
 private:
 	enum { bufs_size = 3 };
@@ -168,6 +190,9 @@ private:
 	Stereo_Mixer mixer;
 	channel_t chan;
 	int samples_avail_;
+	
+	template<class T> int read_samples_( T [], int );
+	void remove_read_samples();
 };
 
 
@@ -184,6 +209,7 @@ public:
 	virtual void end_frame( blip_time_t )           { }
 	virtual int samples_avail() const               { return 0; }
 	virtual int read_samples( blip_sample_t [], int ) { return 0; }
+	virtual void copy_state( State_Copier& );
 };
 
 
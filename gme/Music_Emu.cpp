@@ -2,6 +2,8 @@
 
 #include "Music_Emu.h"
 
+#include "State_Copier.h"
+
 /* Copyright (C) 2003-2008 Shay Green. This module is free software; you
 can redistribute it and/or modify it under the terms of the GNU Lesser
 General Public License as published by the Free Software Foundation; either
@@ -24,11 +26,13 @@ void Music_Emu::clear_track_vars()
 	current_track_ = -1;
 	warning(); // clear warning
 	track_filter.stop();
+	clear_checkpoints();
 }
 
 void Music_Emu::unload()
 {
-	voice_count_ = 0;
+	voice_count_   = 0;
+	file_checksum_ = 0;
 	clear_track_vars();
 	Gme_File::unload();
 }
@@ -36,13 +40,20 @@ void Music_Emu::unload()
 Music_Emu::gme_t()
 {
 	effects_buffer_ = NULL;
+	voice_buffer_   = NULL;
 	sample_rate_    = 0;
 	mute_mask_      = 0;
 	tempo_          = 1.0;
 	gain_           = 1.0;
+	quality_        = 1;
+	frame_length_   = 0;
     
     fade_set        = false;
 	
+	checkpoint_interval  = 0;
+	checkpoint_count     = 0;
+	checkpoint_data_size = 0;
+	
 	// defaults
 	tfilter = track_filter.setup();
 	set_max_initial_silence( 15 );
@@ -63,6 +74,7 @@ Music_Emu::gme_t()
 Music_Emu::~gme_t()
 {
 	assert( !effects_buffer_ );
+	assert( !voice_buffer_ );
 }
 
 blargg_err_t Music_Emu::set_sample_rate( int rate )
@@ -90,6 +102,17 @@ void Music_Emu::set_equalizer( equalizer_t const& eq )
 	set_equalizer_( eq );
 }
 
+void Music_Emu::set_quality( int q )
+{
+	quality_ = (q > 0);
+	set_quality_( quality_ );
+}
+
+void Music_Emu::set_frame_length( int msec )
+{
+	frame_length_ = max( msec, 0 );
+}
+
 void Music_Emu::mute_voice( int index, bool mute )
 {
 	require( (unsigned) index < (unsigned) voice_count() );
@@ -125,10 +148,14 @@ void Music_Emu::set_tempo( double t )
 	if ( t > max ) t = max;
 	tempo_ = t;
 	set_tempo_( t );
+	clear_checkpoints(); // times no longer match
 }
 
 blargg_err_t Music_Emu::post_load()
 {
+	if ( file_begin() )
+		add_file_checksum( file_begin(), file_size() );
+
 	set_tempo( tempo_ );
 	remute_voices();
 	return Gme_File::post_load();
@@ -153,7 +180,14 @@ int Music_Emu::tell() const
 blargg_err_t Music_Emu::seek( int msec )
 {
 	int time = msec_to_samples( msec );
-	if ( time < track_filter.sample_count() )
+	bool restart = (time < track_filter.sample_count());
+	
+	// resume from checkpoint if it's closer than current position
+	int i = find_checkpoint( time );
+	if ( i >= 0 && (restart || checkpoints [i].time > track_filter.sample_count()) )
+		restart = (restore_checkpoint( i ) != blargg_ok);
+	
+	if ( restart )
     {
 		RETURN_ERR( start_track( current_track_ ) );
         if ( fade_set )
@@ -165,6 +199,24 @@ blargg_err_t Music_Emu::seek( int msec )
 blargg_err_t Music_Emu::skip( int count )
 {
 	require( current_track() >= 0 ); // start_track() must have been called already
+	
+	#if GME_PROFILE
+		Gme_Profiler::Activator activate_profiler( &profiler );
+	#endif
+	GME_PROFILE_STAGE( track );
+	
+	// stop at each checkpoint along the way
+	while ( checkpoint_interval && count > 0 )
+	{
+		int last = (checkpoint_count ? checkpoints [checkpoint_count - 1].time : 0);
+		int n = last + checkpoint_interval - track_filter.sample_count();
+		if ( n <= 0 || n > count )
+			n = count;
+		count -= n;
+		RETURN_ERR( track_filter.skip( n ) );
+		update_checkpoints();
+	}
+	
 	return track_filter.skip( count );
 }
 
@@ -212,7 +264,15 @@ blargg_err_t Music_Emu::start_track( int track )
 	#endif
 	track_filter.setup( s );
 	
-	return track_filter.start_track();
+	#if GME_PROFILE
+		Gme_Profiler::Activator activate_profiler( &profiler );
+	#endif
+	GME_PROFILE_STAGE( track );
+	RETURN_ERR( track_filter.start_track() );
+	if ( checkpoint_interval )
+		add_checkpoint();
+	
+	return blargg_ok;
 }
 
 void Music_Emu::set_fade( int start_msec, int length_msec )
@@ -224,12 +284,227 @@ void Music_Emu::set_fade( int start_msec, int length_msec )
 			length_msec * sample_rate() / (1000 / stereo) );
 }
 
-blargg_err_t Music_Emu::play( int out_count, sample_t out [] )
+template<class T>
+inline blargg_err_t Music_Emu::play_samples( int out_count, T out [] )
 {
 	require( current_track() >= 0 );
 	require( out_count % stereo == 0 );
 	
-	return track_filter.play( out_count, out );
+	#if GME_PROFILE
+		Gme_Profiler::Activator activate_profiler( &profiler );
+	#endif
+	GME_PROFILE_STAGE( track );
+	
+	blargg_err_t err = track_filter.play( out_count, out );
+	if ( checkpoint_interval )
+		update_checkpoints();
+	
+	return err;
+}
+
+blargg_err_t Music_Emu::play( int out_count, sample_t out [] )
+{
+	return play_samples( out_count, out );
+}
+
+blargg_err_t Music_Emu::play( int out_count, wide_sample_t out [] )
+{
+	return play_samples( out_count, out );
+}
+
+blargg_err_t Music_Emu::play_wide_( int count, wide_sample_t out [] )
+{
+	// play into beginning of out, then widen from end so that no sample is
+	// overwritten before it's read
+	sample_t* in = (sample_t*) out;
+	RETURN_ERR( play_( count, in ) );
+	for ( int i = count; --i >= 0; )
+		out [i] = in [i];
+	return blargg_ok;
+}
+
+blargg_err_t Music_Emu::play_voices( int out_count, sample_t out [], sample_t* const voice_out [] )
+{
+	require( current_track() >= 0 );
+	
+	// voices must line up with out, so track filter can't buffer or fade
+	if ( !track_filter.passes_through() )
+		return BLARGG_ERR( BLARGG_ERR_CALLER, "voice output requires ignored silence and no fade" );
+	
+	RETURN_ERR( set_voice_out_( voice_out ) );
+	
+	// muted voices and any left over once track ends remain silent
+	for ( int i = voice_count(); --i >= 0; )
+		if ( voice_out [i] )
+			memset( voice_out [i], 0, out_count * sizeof *voice_out [i] );
+	
+	blargg_err_t err = play( out_count, out );
+	set_voice_out_( NULL );
+	return err;
+}
+
+blargg_err_t Music_Emu::separate_voices_()
+{
+	return BLARGG_ERR( BLARGG_ERR_LIMITATION, "voice output not supported by this format" );
+}
+
+blargg_err_t Music_Emu::set_voice_out_( sample_t* const [] )
+{
+	return BLARGG_ERR( BLARGG_ERR_LIMITATION, "voice output not supported by this format" );
+}
+
+// State
+
+void Music_Emu::add_file_checksum( void const* data, int size )
+{
+	// FNV-1a
+	unsigned sum = file_checksum_ ^ 0x811C9DC5;
+	for ( int i = 0; i < size; i++ )
+		sum = (sum ^ STATIC_CAST(byte const*,data) [i]) * 0x01000193;
+	file_checksum_ = sum;
+}
+
+blargg_err_t Music_Emu::copy_state( State_Copier& copier )
+{
+	// State can only be loaded with the same file, track, tempo, and rate
+	unsigned checksum = file_checksum_;
+	int track         = current_track_;
+	double tempo      = tempo_;
+	int rate          = sample_rate_;
+	copier.tag( BLARGG_4CHAR('G','M','E','s') );
+	copier.copy( checksum );
+	copier.copy( track );
+	copier.copy( tempo );
+	copier.copy( rate );
+	RETURN_ERR( copier.error() );
+	if ( checksum != file_checksum_ || track != current_track_ || track < 0 ||
+			tempo != tempo_ || rate != sample_rate_ )
+		return BLARGG_ERR( BLARGG_ERR_CALLER, "state is for different file, track, tempo, or sample rate" );
+	
+	track_filter.copy_state( copier );
+	blargg_err_t err = copy_state_( copier );
+	if ( !err )
+		err = copier.error();
+	
+	if ( copier.loading() )
+	{
+		if ( err )
+			track_filter.stop(); // partially loaded
+		else
+			remute_voices(); // state overwrote voice outputs
+	}
+	return err;
+}
+
+blargg_err_t Music_Emu::save_state( void* out, int size, int* size_out )
+{
+	// Measure first, so that state that can't be saved is reported as such
+	// rather than as the buffer being too small
+	State_Copier measure( State_Copier::mode_measure );
+	RETURN_ERR( copy_state( measure ) );
+	
+	State_Copier copier( State_Copier::mode_save, out, size );
+	RETURN_ERR( copy_state( copier ) );
+	if ( size_out )
+		*size_out = copier.size();
+	return blargg_ok;
+}
+
+blargg_err_t Music_Emu::load_state( void const* in, int size )
+{
+	State_Copier copier( State_Copier::mode_load, CONST_CAST(void*,in), size );
+	return copy_state( copier );
+}
+
+int Music_Emu::state_size()
+{
+	State_Copier copier( State_Copier::mode_measure );
+	if ( copy_state( copier ) )
+		return 0;
+	
+	return copier.size();
+}
+
+// Seek checkpoints
+
+void Music_Emu::set_checkpoint_interval( int msec )
+{
+	require( sample_rate() ); // sample rate must be set first
+	clear_checkpoints();
+	checkpoint_interval = (msec > 0 ? msec_to_samples( msec ) : 0);
+	if ( !checkpoint_interval )
+	{
+		checkpoints.clear();
+		checkpoint_data.clear();
+	}
+	else if ( current_track_ >= 0 )
+	{
+		add_checkpoint();
+	}
+}
+
+void Music_Emu::clear_checkpoints()
+{
+	checkpoint_count     = 0;
+	checkpoint_data_size = 0;
+}
+
+void Music_Emu::update_checkpoints()
+{
+	int now = track_filter.sample_count();
+	if ( !checkpoint_count || now >= checkpoints [checkpoint_count - 1].time + checkpoint_interval )
+		add_checkpoint();
+}
+
+void Music_Emu::add_checkpoint()
+{
+	// Checkpoints are only an optimization, so failure just leaves index as is
+	int size = state_size();
+	if ( !size )
+		return;
+	
+	// grow arrays geometrically
+	int data_needed = checkpoint_data_size + size;
+	int data_size   = (int) checkpoint_data.size();
+	if ( data_size < data_needed && checkpoint_data.resize( max( data_needed, data_size * 2 ) ) )
+		return;
+	
+	int count = (int) checkpoints.size();
+	if ( count <= checkpoint_count && checkpoints.resize( max( 16, count * 2 ) ) )
+		return;
+	
+	State_Copier copier( State_Copier::mode_save, &checkpoint_data [checkpoint_data_size], size );
+	if ( copy_state( copier ) )
+		return;
+	
+	checkpoint_t& c = checkpoints [checkpoint_count++];
+	c.time   = track_filter.sample_count();
+	c.offset = checkpoint_data_size;
+	checkpoint_data_size += copier.size();
+}
+
+int Music_Emu::find_checkpoint( int time ) const
+{
+	// binary search for last checkpoint at or before time
+	int lo = 0;
+	int hi = checkpoint_count;
+	while ( lo < hi )
+	{
+		int mid = (lo + hi) / 2;
+		if ( checkpoints [mid].time <= time )
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo - 1;
+}
+
+blargg_err_t Music_Emu::restore_checkpoint( int i )
+{
+	checkpoint_t const& c = checkpoints [i];
+	int end = (i + 1 < checkpoint_count ? checkpoints [i + 1].offset : checkpoint_data_size);
+	State_Copier copier( State_Copier::mode_load, &checkpoint_data [c.offset], end - c.offset );
+	return copy_state( copier );
 }
 
 // Gme_Info_
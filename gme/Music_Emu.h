@@ -6,8 +6,11 @@
 
 #include "Gme_File.h"
 #include "Track_Filter.h"
+#include "Gme_Profiler.h"
 #include "blargg_errors.h"
 class Multi_Buffer;
+class Voice_Buffer;
+class State_Copier;
 
 struct gme_t : public Gme_File, private Track_Filter::callbacks_t {
 public:
@@ -31,6 +34,11 @@ public:
 	typedef short sample_t;
 	blargg_err_t play( int count, sample_t* buf );
 	
+	// Same as play(), but samples are 32-bit and aren't clamped to 16 bits, for
+	// emulators that mix at higher precision. Others output 16-bit range samples.
+	typedef int wide_sample_t;
+	blargg_err_t play( int count, wide_sample_t* buf );
+	
 // Track information
 	
 	// See Gme_File.h
@@ -57,9 +65,36 @@ public:
 	// Number of milliseconds played since beginning of track (1000 per second)
 	int tell() const;
 	
-	// Seeks to new time in track. Seeking backwards or far forward can take a while.
+	// Seeks to new time in track. Seeking backwards or far forward can take a while,
+	// unless checkpoints are enabled.
 	blargg_err_t seek( int msec );
 	
+	// Enables recording of emulator state every msec milliseconds of playback or
+	// skipping, so that a later seek() to an earlier time resumes from the nearest
+	// checkpoint before it, rather than restarting the track and emulating from
+	// the beginning. Each checkpoint uses as much memory as the emulator's state
+	// (for SPC, about 75K), so the index grows by that much every msec of track
+	// played. Index is cleared when a track is started or tempo changed. 0 disables
+	// checkpoints and frees index. Has no effect on types that don't support
+	// saving state.
+	void set_checkpoint_interval( int msec );
+	
+	// Size of buffer needed to save state of current track, or 0 if this type
+	// doesn't support saving state or no track has been started
+	int state_size();
+	
+	// Saves current state of emulator into out, which has room for size bytes,
+	// and sets *size_out to number of bytes used. State can be loaded into any
+	// emulator in this process with the same file, track, tempo, and sample rate.
+	// It can't be kept in a file, since its layout depends on the build. Settings
+	// such as muting, equalization, and effects are not part of the state.
+	blargg_err_t save_state( void* out, int size, int* size_out = NULL );
+	
+	// Restores state saved by save_state(), along with time position. If state is
+	// for a different file, track, tempo, or sample rate, returns error and leaves
+	// emulator unchanged. If state is otherwise invalid, returns error and ends track.
+	blargg_err_t load_state( void const* in, int size );
+	
 	// Skips n samples
 	blargg_err_t skip( int n );
 	
@@ -88,6 +123,13 @@ public:
 	// Sets muting state of all voices at once using a bit mask, where -1 mutes them all,
 	// 0 unmutes them all, 0x01 mutes just the first voice, etc.
 	void mute_voices( int mask );
+	
+	// Same as play(), but also writes each voice's own stereo samples to
+	// voice_out [i], for i from 0 to voice_count()-1, skipping those that are
+	// NULL. Voices have no fade or effects applied. Only supported by emulators
+	// created with gme_new_emu_voices(), while silence is ignored and no fade is
+	// set.
+	blargg_err_t play_voices( int count, sample_t* buf, sample_t* const voice_out [] );
 
 // Sound customization
 	
@@ -95,6 +137,16 @@ public:
 	// Track length as returned by track_info() assumes a tempo of 1.0.
 	void set_tempo( double );
 	
+	// Sets sound synthesis quality, where 0 = fast linear interpolation and
+	// 1 = full band-limited synthesis (default). Only affects emulators that use
+	// Blip_Buffer for sound chips (not VGM/GYM FM), and resampling width of SPC/SFM.
+	// Can be changed at any time.
+	void set_quality( int );
+	
+	// Limits amount of sound emulated at once to msec milliseconds, or 0 for
+	// default of emulating enough to fill sound buffer. See gme.h.
+	void set_frame_length( int msec );
+	
 	// Changes overall output amplitude, where 1.0 results in minimal clamping.
 	// Must be called before set_sample_rate().
 	void set_gain( double );
@@ -141,6 +193,12 @@ protected:
 	// Current tempo
 	double tempo() const                        { return tempo_; }
 	
+	// Current synthesis quality
+	int quality() const                         { return quality_; }
+	
+	// Limit set by set_frame_length(), or 0 if none
+	int frame_length() const                    { return frame_length_; }
+	
 	// Re-applies muting mask using mute_voices_()
 	void remute_voices();
 	
@@ -153,6 +211,9 @@ protected:
 	// Set equalizer parameters
 	virtual void set_equalizer_( equalizer_t const& )           { }
 	
+	// Set synthesis quality, either blip_synth_fast or blip_synth_full
+	virtual void set_quality_( int )                            { }
+	
 	// Mute voices based on mask
 	virtual void mute_voices_( int mask )                       BLARGG_PURE( ; )
 	
@@ -165,14 +226,34 @@ protected:
 	// Generate count samples into *out. Count will always be even.
 	virtual blargg_err_t play_( int count, sample_t out [] )    BLARGG_PURE( ; )
 	
+	// Same as play_(), but samples don't need to be clamped. Default calls
+	// play_() and widens its samples.
+	virtual blargg_err_t play_wide_( int count, wide_sample_t out [] );
+	
 	// Skip count samples. Count will always be even.
 	virtual blargg_err_t skip_( int count );
+	
+	// Make emulator keep each voice separate for play_voices(). Called before
+	// sample rate is set. Default returns error.
+	virtual blargg_err_t separate_voices_();
+	
+	// Make play_() also write each voice's samples to out [i], or stop if out is
+	// NULL. Default returns error.
+	virtual blargg_err_t set_voice_out_( sample_t* const out [] );
 
     // Save current state of file to specified writer.
     virtual blargg_err_t save_( gme_writer_t, void* ) const { return "Not supported by this format"; }
 
     // Set track info
     virtual blargg_err_t set_track_info_( const track_info_t*, int ) { return "Not supported by this format"; }
+	
+	// Save or load everything that changes during playback of current track, using
+	// copier. Settings such as tempo, muting, and equalization are not included.
+	virtual blargg_err_t copy_state_( State_Copier& );
+	
+	// Adds data to checksum that identifies file in saved state. File data in
+	// memory is added automatically, so only load_() overrides need to call this.
+	void add_file_checksum( void const* data, int size );
     
 // Implementation
 public:
@@ -194,6 +275,8 @@ private:
 	int mute_mask_;
 	double tempo_;
 	double gain_;
+	int quality_;
+	int frame_length_;
 	int sample_rate_;
 	int current_track_;
     
@@ -201,17 +284,48 @@ private:
     int length_msec;
     int fade_msec;
 	
+	// Identifies file in saved state
+	unsigned file_checksum_;
+	
+	// Seek checkpoints
+	struct checkpoint_t
+	{
+		int time;   // sample_count() when state was saved
+		int offset; // offset of state in checkpoint_data
+	};
+	int checkpoint_interval; // 0 if disabled
+	int checkpoint_count;
+	int checkpoint_data_size;
+	blargg_vector<checkpoint_t> checkpoints;
+	blargg_vector<byte> checkpoint_data;
+	void clear_checkpoints();
+	void update_checkpoints();
+	void add_checkpoint();
+	blargg_err_t restore_checkpoint( int index );
+	int find_checkpoint( int time ) const;
+	
+	blargg_err_t copy_state( State_Copier& );
+	
+	#if GME_PROFILE
+		Gme_Profiler profiler;
+	#endif
+	
 	void clear_track_vars();
 	int msec_to_samples( int msec ) const;
+	template<class T> blargg_err_t play_samples( int, T [] );
 	
 	friend Music_Emu* gme_new_emu( gme_type_t, int );
+	friend Music_Emu* gme_new_emu_voices( gme_type_t, int );
 	friend void gme_effects( Music_Emu const*, gme_effects_t* );
 	friend void gme_set_effects( Music_Emu*, gme_effects_t const* );
 	friend void gme_set_stereo_depth( Music_Emu*, double );
 	friend const char** gme_voice_names ( Music_Emu const* );
+	friend gme_err_t gme_get_profile( Music_Emu const*, gme_profile_t* );
+	friend void gme_reset_profile( Music_Emu* );
 	
 protected:
 	Multi_Buffer* effects_buffer_;
+	Voice_Buffer* voice_buffer_;
 };
 
 // base class for info-only derivations
@@ -257,6 +371,11 @@ inline void Music_Emu::ignore_silence( bool b )     { track_filter.ignore_silenc
 inline void Music_Emu::set_tempo_( double t )       { tempo_ = t; }
 inline void Music_Emu::remute_voices()              { mute_voices( mute_mask_ ); }
 
+inline blargg_err_t Music_Emu::copy_state_( State_Copier& )
+{
+	return BLARGG_ERR( BLARGG_ERR_LIMITATION, "state saving not supported by this format" );
+}
+
 inline void Music_Emu::set_voice_names( const char* const p [] ) { voice_names_ = p; }
 
 inline void Music_Emu::mute_voices_( int ) { }
@@ -2,6 +2,8 @@
 
 #include "Nes_Apu.h"
 
+#include "State_Copier.h"
+
 /* Copyright (C) 2003-2008 Shay Green. This module is free software; you
 can redistribute it and/or modify it under the terms of the GNU Lesser
 General Public License as published by the Free Software Foundation; either
@@ -117,6 +119,58 @@ void Nes_Apu::reset( bool pal_mode, int initial_dmc_dac )
 		dmc.last_amp = initial_dmc_dac; // prevent output transition
 }
 
+void Nes_Apu::copy_state( State_Copier& copier )
+{
+	for ( int i = 0; i < osc_count; i++ )
+	{
+		Nes_Osc& osc = *oscs [i];
+		copier.copy( osc.regs );
+		copier.copy( osc.reg_written );
+		copier.copy( osc.length_counter );
+		copier.copy( osc.delay );
+		copier.copy( osc.last_amp );
+	}
+	
+	Nes_Envelope* const envs [3] = { &square1, &square2, &noise };
+	for ( int i = 0; i < 3; i++ )
+	{
+		copier.copy( envs [i]->envelope );
+		copier.copy( envs [i]->env_delay );
+	}
+	
+	copier.copy( square1.phase );
+	copier.copy( square1.sweep_delay );
+	copier.copy( square2.phase );
+	copier.copy( square2.sweep_delay );
+	copier.copy( triangle.phase );
+	copier.copy( triangle.linear_counter );
+	copier.copy( noise.noise );
+	
+	copier.copy( dmc.address );
+	copier.copy( dmc.period );
+	copier.copy( dmc.buf );
+	copier.copy( dmc.bits_remain );
+	copier.copy( dmc.bits );
+	copier.copy( dmc.buf_full );
+	copier.copy( dmc.silence );
+	copier.copy( dmc.dac );
+	copier.copy( dmc.next_irq );
+	copier.copy( dmc.irq_enabled );
+	copier.copy( dmc.irq_flag );
+	copier.copy( dmc.pal_mode );
+	
+	copier.copy( last_time );
+	copier.copy( last_dmc_time );
+	copier.copy( earliest_irq_ );
+	copier.copy( next_irq );
+	copier.copy( frame_period );
+	copier.copy( frame_delay );
+	copier.copy( frame );
+	copier.copy( osc_enables );
+	copier.copy( frame_mode );
+	copier.copy( irq_flag );
+}
+
 void Nes_Apu::irq_changed()
 {
 	blip_time_t new_irq = dmc.next_irq;
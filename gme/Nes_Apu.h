@@ -9,6 +9,7 @@
 
 struct apu_state_t;
 class Nes_Buffer;
+class State_Copier;
 
 class Nes_Apu {
 public:
@@ -63,6 +64,10 @@ public:
 	void save_state( apu_state_t* out ) const;
 	void load_state( apu_state_t const& );
 	
+	// Saves/loads exact emulation state in place. Outputs must be set again
+	// after loading.
+	void copy_state( State_Copier& );
+	
 	// Sets overall volume (default is 1.0)
 	void volume( double );
 	
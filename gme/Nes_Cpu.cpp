@@ -2,6 +2,7 @@
 
 #include "Nes_Cpu.h"
 
+#include "State_Copier.h"
 #include "blargg_endian.h"
 
 /* Copyright (C) 2003-2008 Shay Green. This module is free software; you
@@ -60,3 +61,20 @@ void Nes_Cpu::reset( void const* unmapped_page )
 	
 	blargg_verify_byte_order();
 }
+
+void Nes_Cpu::copy_state( State_Copier& copier )
+{
+	assert( cpu_state == &cpu_state_ );
+	copier.copy( r );
+	for ( int i = 0; i < page_count + 1; i++ )
+	{
+		byte const* p = cpu_state_.code_map [i] + NES_CPU_OFFSET( i * page_size );
+		copier.copy_ptr( p );
+		set_code_page( i, p );
+	}
+	copier.copy( cpu_state_.base );
+	copier.copy( cpu_state_.time );
+	copier.copy( irq_time_ );
+	copier.copy( end_time_ );
+	copier.copy( error_count_ );
+}
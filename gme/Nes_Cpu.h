@@ -5,6 +5,7 @@
 #define NES_CPU_H
 
 #include "blargg_common.h"
+class State_Copier;
 
 class Nes_Cpu {
 public:
@@ -66,6 +67,10 @@ public:
 	
 	// Can read this many bytes past end of a page
 	enum { cpu_padding = 8 };
+	
+	// Saves/loads registers, time, and memory map. Memory mapped must be within
+	// blocks already added to copier. Must not be called during emulation.
+	void copy_state( State_Copier& );
 
 private:
 	// noncopyable
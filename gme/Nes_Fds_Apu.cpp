@@ -2,6 +2,8 @@
 
 #include "Nes_Fds_Apu.h"
 
+#include "State_Copier.h"
+
 /* Copyright (C) 2006 Shay Green. This module is free software; you
 can redistribute it and/or modify it under the terms of the GNU Lesser
 General Public License as published by the Free Software Foundation; either
@@ -97,6 +99,25 @@ void Nes_Fds_Apu::write_( unsigned addr, int data )
 	}
 }
 
+void Nes_Fds_Apu::copy_state( State_Copier& copier )
+{
+	copier.copy( regs_ );
+	copier.copy( env_delay );
+	copier.copy( env_speed );
+	copier.copy( env_gain );
+	copier.copy( sweep_delay );
+	copier.copy( sweep_speed );
+	copier.copy( sweep_gain );
+	copier.copy( wave_pos );
+	copier.copy( last_amp );
+	copier.copy( wave_fract );
+	copier.copy( mod_fract );
+	copier.copy( mod_pos );
+	copier.copy( mod_write_pos );
+	copier.copy( mod_wave );
+	copier.copy( last_time );
+}
+
 void Nes_Fds_Apu::set_tempo( double t )
 {
 	lfo_tempo = lfo_base_tempo;
@@ -6,6 +6,7 @@
 
 #include "blargg_common.h"
 #include "Blip_Buffer.h"
+class State_Copier;
 
 class Nes_Fds_Apu {
 public:
@@ -23,6 +24,10 @@ public:
 	void write( blip_time_t time, unsigned addr, int data );
 	int read( blip_time_t time, unsigned addr );
 	void end_frame( blip_time_t );
+
+	// Saves/loads exact emulation state in place. Outputs must be set again
+	// after loading.
+	void copy_state( State_Copier& );
 	
 public:
 	Nes_Fds_Apu();
@@ -2,6 +2,8 @@
 
 #include "Nes_Fme7_Apu.h"
 
+#include "State_Copier.h"
+
 /* Copyright (C) 2003-2006 Shay Green. This module is free software; you
 can redistribute it and/or modify it under the terms of the GNU Lesser
 General Public License as published by the Free Software Foundation; either
@@ -26,6 +28,15 @@ void Nes_Fme7_Apu::reset()
 	memset( state, 0, sizeof *state );
 }
 
+void Nes_Fme7_Apu::copy_state( State_Copier& copier )
+{
+	fme7_apu_state_t* state = this;
+	copier.copy( *state );
+	for ( int i = 0; i < osc_count; i++ )
+		copier.copy( oscs [i].last_amp );
+	copier.copy( last_time );
+}
+
 unsigned char const Nes_Fme7_Apu::amp_table [16] =
 {
 	#define ENTRY( n ) (unsigned char) (n * amp_range + 0.5)
@@ -6,6 +6,7 @@
 
 #include "blargg_common.h"
 #include "Blip_Buffer.h"
+class State_Copier;
 
 struct fme7_apu_state_t
 {
@@ -28,6 +29,10 @@ public:
 	void end_frame( blip_time_t );
 	void save_state( fme7_apu_state_t* ) const;
 	void load_state( fme7_apu_state_t const& );
+
+	// Saves/loads exact emulation state in place. Outputs must be set again
+	// after loading.
+	void copy_state( State_Copier& );
 	
 	// Mask and addresses of registers
 	enum { addr_mask = 0xE000 };
@@ -2,6 +2,8 @@
 
 #include "Nes_Namco_Apu.h"
 
+#include "State_Copier.h"
+
 /* Copyright (C) 2003-2006 Shay Green. This module is free software; you
 can redistribute it and/or modify it under the terms of the GNU Lesser
 General Public License as published by the Free Software Foundation; either
@@ -45,6 +47,18 @@ void Nes_Namco_Apu::set_output( Blip_Buffer* buf )
 		set_output( i, buf );
 }
 
+void Nes_Namco_Apu::copy_state( State_Copier& copier )
+{
+	for ( int i = 0; i < osc_count; ++i )
+	{
+		copier.copy( oscs [i].delay );
+		copier.copy( oscs [i].last_amp );
+	}
+	copier.copy( last_time );
+	copier.copy( addr_reg );
+	copier.copy( reg );
+}
+
 /*
 void Nes_Namco_Apu::reflect_state( Tagged_Data& data )
 {
@@ -6,6 +6,7 @@
 
 #include "blargg_common.h"
 #include "Blip_Buffer.h"
+class State_Copier;
 
 struct namco_state_t;
 
@@ -32,6 +33,10 @@ public:
 	// to do: implement save/restore
 	void save_state( namco_state_t* out ) const;
 	void load_state( namco_state_t const& );
+
+	// Saves/loads exact emulation state in place. Outputs must be set again
+	// after loading.
+	void copy_state( State_Copier& );
 	
 public:
 	Nes_Namco_Apu();
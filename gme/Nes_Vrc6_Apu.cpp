@@ -2,6 +2,8 @@
 
 #include "Nes_Vrc6_Apu.h"
 
+#include "State_Copier.h"
+
 /* Copyright (C) 2003-2006 Shay Green. This module is free software; you
 can redistribute it and/or modify it under the terms of the GNU Lesser
 General Public License as published by the Free Software Foundation; either
@@ -70,6 +72,20 @@ void Nes_Vrc6_Apu::end_frame( blip_time_t time )
 	last_time -= time;
 }
 
+void Nes_Vrc6_Apu::copy_state( State_Copier& copier )
+{
+	for ( int i = 0; i < osc_count; i++ )
+	{
+		Vrc6_Osc& osc = oscs [i];
+		copier.copy( osc.regs );
+		copier.copy( osc.delay );
+		copier.copy( osc.last_amp );
+		copier.copy( osc.phase );
+		copier.copy( osc.amp );
+	}
+	copier.copy( last_time );
+}
+
 void Nes_Vrc6_Apu::save_state( vrc6_apu_state_t* out ) const
 {
 	assert( sizeof (vrc6_apu_state_t) == 20 );
@@ -6,6 +6,7 @@
 
 #include "blargg_common.h"
 #include "Blip_Buffer.h"
+class State_Copier;
 
 struct vrc6_apu_state_t;
 
@@ -21,6 +22,10 @@ public:
 	void end_frame( blip_time_t );
 	void save_state( vrc6_apu_state_t* ) const;
 	void load_state( vrc6_apu_state_t const& );
+
+	// Saves/loads exact emulation state in place. Outputs must be set again
+	// after loading.
+	void copy_state( State_Copier& );
 	
 	// Oscillator 0 write-only registers are at $9000-$9002
 	// Oscillator 1 write-only registers are at $A000-$A002
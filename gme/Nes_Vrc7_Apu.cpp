@@ -1,5 +1,7 @@
 #include "Nes_Vrc7_Apu.h"
 
+#include "State_Copier.h"
+
 #include "ym2413.h"
 #include <string.h>
 
@@ -108,6 +110,22 @@ void Nes_Vrc7_Apu::end_frame( blip_time_t time )
 	}
 }
 
+void Nes_Vrc7_Apu::copy_state( State_Copier& copier )
+{
+	for ( int i = 0; i < osc_count; ++i )
+	{
+		copier.copy( oscs [i].regs );
+		copier.copy( oscs [i].last_amp );
+	}
+	copier.copy( addr );
+	copier.copy( next_time );
+	copier.copy( mono.last_amp );
+	int ptrs [YM2413_STATE_PTRS];
+	int ptr_count = ym2413_state_ptrs( opll, ptrs );
+	copier.add_block( opll, ym2413_state_size() );
+	copier.copy_with_ptrs( opll, ym2413_state_size(), ptrs, ptr_count );
+}
+
 void Nes_Vrc7_Apu::save_snapshot( vrc7_snapshot_t* out ) const
 {
 	out->latch = addr;
@@ -5,6 +5,7 @@
 
 #include "blargg_common.h"
 #include "Blip_Buffer.h"
+class State_Copier;
 
 struct vrc7_snapshot_t;
 
@@ -22,6 +23,10 @@ public:
 	void end_frame( blip_time_t );
 	void save_snapshot( vrc7_snapshot_t* ) const;
 	void load_snapshot( vrc7_snapshot_t const& );
+
+	// Saves/loads exact emulation state in place. Outputs must be set again
+	// after loading.
+	void copy_state( State_Copier& );
 	
 	void write_reg( int reg );
 	void write_data( blip_time_t, int data );
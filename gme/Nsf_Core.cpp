@@ -2,6 +2,7 @@
 
 #include "Nsf_Core.h"
 
+#include "State_Copier.h"
 #include "blargg_endian.h"
 
 #if !NSF_EMU_APU_ONLY
@@ -287,6 +288,25 @@ blargg_err_t Nsf_Core::start_track( int track )
 	return Nsf_Impl::start_track( track );
 }
 
+void Nsf_Core::copy_state( State_Copier& copier )
+{
+	Nsf_Impl::copy_state( copier );
+	
+	#if !NSF_EMU_APU_ONLY
+		copier.copy( mmc5_mul );
+		if ( fds   ) fds  ->copy_state( copier );
+		if ( fme7  ) fme7 ->copy_state( copier );
+		if ( mmc5  )
+		{
+			mmc5->copy_state( copier );
+			copier.copy( mmc5->exram );
+		}
+		if ( namco ) namco->copy_state( copier );
+		if ( vrc6  ) vrc6 ->copy_state( copier );
+		if ( vrc7  ) vrc7 ->copy_state( copier );
+	#endif
+}
+
 void Nsf_Core::end_frame( time_t end )
 {
 	Nsf_Impl::end_frame( end );
@@ -2,6 +2,8 @@
 
 #include "Nsf_Emu.h"
 
+#include "State_Copier.h"
+
 #if !NSF_EMU_APU_ONLY
 	#include "Nes_Namco_Apu.h"
 	#include "Nes_Vrc6_Apu.h"
@@ -272,6 +274,8 @@ blargg_err_t Nsf_Emu::init_sound()
 blargg_err_t Nsf_Emu::load_( Data_Reader& in )
 {
 	RETURN_ERR( core_.load( in ) );
+	add_file_checksum( &header(), sizeof header() );
+	add_file_checksum( core_.rom_().begin(), core_.rom_().file_size() );
 	set_track_count( header().track_count );
 	RETURN_ERR( check_nsf_header( header() ) );
 	set_warning( core_.warning() );
@@ -326,6 +330,13 @@ blargg_err_t Nsf_Emu::start_track_( int track )
 	return core_.start_track( track );
 }
 
+blargg_err_t Nsf_Emu::copy_state_( State_Copier& copier )
+{
+	copier.tag( BLARGG_4CHAR('N','S','F','s') );
+	core_.copy_state( copier );
+	return copy_buffer_state( copier );
+}
+
 blargg_err_t Nsf_Emu::run_clocks( blip_time_t& duration, int )
 {
 	core_.end_frame( duration );
@@ -2,6 +2,7 @@
 
 #include "Nsf_Impl.h"
 
+#include "State_Copier.h"
 #include "blargg_endian.h"
 
 /* Copyright (C) 2003-2008 Shay Green. This module is free software; you
@@ -312,6 +313,22 @@ void Nsf_Impl::run_until( time_t end )
 		run_once( end );
 }
 
+void Nsf_Impl::copy_state( State_Copier& copier )
+{
+	copier.add_block( low_ram, sizeof low_ram );
+	copier.add_block( high_ram.begin(), (int) high_ram.size() );
+	copier.add_block( rom.mem(), rom.mem_size() );
+	cpu.copy_state( copier );
+	copier.copy( low_ram );
+	copier.copy( high_ram.begin(), (int) high_ram.size() );
+	copier.copy( next_play );
+	copier.copy( play_period );
+	copier.copy( play_extra );
+	copier.copy( play_delay );
+	copier.copy( saved_state );
+	apu.copy_state( copier );
+}
+
 void Nsf_Impl::end_frame( time_t end )
 {
 	if ( time() < end )
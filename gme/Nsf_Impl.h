@@ -90,6 +90,9 @@ public:
 	
 	// Time emulated to
 	time_t time() const             { return cpu.time(); }
+	
+	// Saves/loads CPU, memory, and sound chip state. Must be called between frames.
+	virtual void copy_state( State_Copier& );
 
 	void enable_w4011_(bool enable = true) { enable_w4011 = enable; }
 
@@ -3,6 +3,8 @@
 #include "Okim6258_Emu.h"
 #include "okim6258.h"
 
+#include "State_Copier.h"
+
 Okim6258_Emu::Okim6258_Emu() { chip = 0; }
 
 Okim6258_Emu::~Okim6258_Emu()
@@ -69,3 +71,8 @@ void Okim6258_Emu::run( int pair_count, sample_t* out )
 		pair_count -= todo;
 	}
 }
+
+void Okim6258_Emu::copy_state( State_Copier& copier )
+{
+	copier.copy( chip, okim6258_state_size() );
+}
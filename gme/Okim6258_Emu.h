@@ -4,6 +4,8 @@
 #ifndef OKIM6258_EMU_H
 #define OKIM6258_EMU_H
 
+class State_Copier;
+
 class Okim6258_Emu  {
 	void* chip;
 public:
@@ -27,6 +29,9 @@ public:
 	typedef short sample_t;
 	enum { out_chan_count = 2 }; // stereo
 	void run( int pair_count, sample_t* out );
+	
+	// Saves/loads exact emulation state in place
+	void copy_state( State_Copier& );
 };
 
 #endif
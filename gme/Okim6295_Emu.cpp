@@ -3,6 +3,8 @@
 #include "Okim6295_Emu.h"
 #include "okim6295.h"
 
+#include "State_Copier.h"
+
 Okim6295_Emu::Okim6295_Emu() { chip = 0; }
 
 Okim6295_Emu::~Okim6295_Emu()
@@ -75,3 +77,10 @@ void Okim6295_Emu::run( int pair_count, sample_t* out )
 		pair_count -= todo;
 	}
 }
+
+void Okim6295_Emu::copy_state( State_Copier& copier )
+{
+	int kept [OKIM6295_STATE_KEPT];
+	int kept_count = okim6295_state_kept( chip, kept );
+	copier.copy_with_ptrs( chip, okim6295_state_size(), NULL, 0, kept, kept_count );
+}
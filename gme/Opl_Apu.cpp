@@ -1,5 +1,6 @@
 #include "Opl_Apu.h"
 
+#include "State_Copier.h"
 #include "blargg_source.h"
 
 #include "ym2413.h"
@@ -169,6 +170,52 @@ int Opl_Apu::read( blip_time_t time, int port )
 	return 0;
 }
 
+void Opl_Apu::copy_state( State_Copier& copier )
+{
+	copier.copy( regs );
+	copier.copy( next_time );
+	copier.copy( last_amp );
+	copier.copy( addr );
+	
+	// Chip holds pointers to itself and to opl_memory
+	int ptrs [OPL_STATE_PTRS > YM2413_STATE_PTRS ? OPL_STATE_PTRS : YM2413_STATE_PTRS];
+	int ptr_count = 0;
+	int size = 0;
+	switch (type_)
+	{
+	case type_opll:
+	case type_msxmusic:
+	case type_smsfmunit:
+	case type_vrc7:
+		size = ym2413_state_size();
+		ptr_count = ym2413_state_ptrs( opl, ptrs );
+		break;
+
+	case type_opl:
+		size = ym3526_state_size();
+		ptr_count = opl_state_ptrs( opl, ptrs );
+		break;
+
+	case type_msxaudio:
+		size = y8950_state_size();
+		ptr_count = opl_state_ptrs( opl, ptrs );
+		break;
+
+	case type_opl2:
+		size = ym3812_state_size();
+		ptr_count = opl_state_ptrs( opl, ptrs );
+		break;
+	}
+	
+	if ( opl_memory )
+		copier.add_block( opl_memory, 32768 );
+	copier.add_block( opl, size );
+	copier.copy_with_ptrs( opl, size, ptrs, ptr_count );
+	
+	if ( opl_memory )
+		copier.copy( opl_memory, 32768 );
+}
+
 void Opl_Apu::end_frame( blip_time_t time )
 {
 	run_until( time );
@@ -3,6 +3,7 @@
 
 #include "blargg_common.h"
 #include "Blip_Buffer.h"
+class State_Copier;
 
 #include <stdio.h>
 
@@ -28,6 +29,9 @@ public:
 
 	int read( blip_time_t, int port );
 	
+	// Saves/loads exact emulation state in place
+	void copy_state( State_Copier& );
+	
 	static bool supported() { return true; }
 
 private:
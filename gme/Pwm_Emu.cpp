@@ -3,6 +3,8 @@
 #include "Pwm_Emu.h"
 #include "pwm.h"
 
+#include "State_Copier.h"
+
 Pwm_Emu::Pwm_Emu() { chip = 0; }
 
 Pwm_Emu::~Pwm_Emu()
@@ -64,3 +66,8 @@ void Pwm_Emu::run( int pair_count, sample_t* out )
 		pair_count -= todo;
 	}
 }
+
+void Pwm_Emu::copy_state( State_Copier& copier )
+{
+	copier.copy( chip, pwm_state_size() );
+}
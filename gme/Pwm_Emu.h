@@ -4,6 +4,8 @@
 #ifndef PWM_EMU_H
 #define PWM_EMU_H
 
+class State_Copier;
+
 class Pwm_Emu  {
 	void* chip;
 public:
@@ -28,6 +30,9 @@ public:
 	typedef short sample_t;
 	enum { out_chan_count = 2 }; // stereo
 	void run( int pair_count, sample_t* out );
+	
+	// Saves/loads exact emulation state in place
+	void copy_state( State_Copier& );
 };
 
 #endif
@@ -3,6 +3,8 @@
 #include "Qsound_Apu.h"
 #include "qmix.h"
 
+#include "State_Copier.h"
+
 Qsound_Apu::Qsound_Apu() { chip = 0; rom = 0; rom_size = 0; sample_rate = 0; }
 
 Qsound_Apu::~Qsound_Apu()
@@ -81,3 +83,12 @@ void Qsound_Apu::run( int pair_count, sample_t* out )
 		pair_count -= todo;
 	}
 }
+
+void Qsound_Apu::copy_state( State_Copier& copier )
+{
+	copier.copy( chip, _qmix_get_state_size() );
+	
+	// ROM pointer belongs to this object
+	if ( copier.loading() )
+		_qmix_set_sample_rom( chip, rom, rom_size );
+}
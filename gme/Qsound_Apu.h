@@ -4,6 +4,8 @@
 #ifndef QSOUND_APU_H
 #define QSOUND_APU_H
 
+class State_Copier;
+
 class Qsound_Apu  {
 	void* chip;
     void* rom;
@@ -31,6 +33,9 @@ public:
 	typedef short sample_t;
 	enum { out_chan_count = 2 }; // stereo
 	void run( int pair_count, sample_t* out );
+	
+	// Saves/loads exact emulation state in place, but not ROM
+	void copy_state( State_Copier& );
 };
 
 #endif
@@ -2,6 +2,9 @@
 
 #include "Resampler.h"
 
+#include "State_Copier.h"
+#include "Gme_Profiler.h"
+
 /* Copyright (C) 2004-2008 Shay Green. This module is free software; you
 can redistribute it and/or modify it under the terms of the GNU Lesser
 General Public License as published by the Free Software Foundation; either
@@ -29,10 +32,18 @@ void Resampler::clear()
 	clear_();
 }
 
+void Resampler::copy_state( State_Copier& copier )
+{
+	copier.copy( write_pos );
+	copier.copy_var( buf.begin(), write_pos * sizeof (sample_t), buf.size() * sizeof (sample_t) );
+	copy_state_( copier );
+}
+
 inline int Resampler::resample_wrapper( sample_t out [], int* out_size,
 		sample_t const in [], int in_size )
 {
 	assert( rate() );
+	GME_PROFILE_STAGE( resample );
 	
 	sample_t* out_ = out;
 	int result = resample_( &out_, out + *out_size, in, in_size ) - in;
@@ -5,6 +5,7 @@
 #define RESAMPLER_H
 
 #include "blargg_common.h"
+class State_Copier;
 
 class Resampler {
 public:
@@ -52,6 +53,9 @@ public:
 	// actually written to out. Result will be less than n if there aren't
 	// enough input samples in buffer.
 	int read( sample_t out [], int n );
+	
+	// Saves/loads buffered input samples and position within them
+	void copy_state( State_Copier& );
 
 // Direct writing to input buffer, instead of using write( in, n ) above
 
@@ -71,6 +75,8 @@ protected:
 	
 	virtual void clear_() { }
 	
+	virtual void copy_state_( State_Copier& ) { }
+	
 	// Resample as many available in samples as will fit within out_size and
 	// return pointer past last input sample read and set *out just past
 	// the last output sample.
@@ -3,6 +3,8 @@
 #include "Rf5C164_Emu.h"
 #include "scd_pcm.h"
 
+#include "State_Copier.h"
+
 Rf5C164_Emu::Rf5C164_Emu() { chip = 0; }
 
 Rf5C164_Emu::~Rf5C164_Emu()
@@ -80,3 +82,14 @@ void Rf5C164_Emu::run( int pair_count, sample_t* out )
 		pair_count -= todo;
 	}
 }
+
+void Rf5C164_Emu::copy_state( State_Copier& copier )
+{
+	int kept [RF5C164_STATE_KEPT];
+	int kept_count = rf5c164_state_kept( chip, kept );
+	copier.copy_with_ptrs( chip, rf5c164_state_size(), NULL, 0, kept, kept_count );
+	
+	int ram_size;
+	UINT8* ram = rf5c164_state_ram( chip, &ram_size );
+	copier.copy( ram, ram_size );
+}
@@ -3,6 +3,8 @@
 #include "Rf5C68_Emu.h"
 #include "rf5c68.h"
 
+#include "State_Copier.h"
+
 Rf5C68_Emu::Rf5C68_Emu() { chip = 0; }
 
 Rf5C68_Emu::~Rf5C68_Emu()
@@ -80,3 +82,16 @@ void Rf5C68_Emu::run( int pair_count, sample_t* out )
 		pair_count -= todo;
 	}
 }
+
+void Rf5C68_Emu::copy_state( State_Copier& copier )
+{
+	int ptrs [RF5C68_STATE_PTRS];
+	int ptr_count = rf5c68_state_ptrs( chip, ptrs );
+	int kept [RF5C68_STATE_KEPT];
+	int kept_count = rf5c68_state_kept( chip, kept );
+	copier.copy_with_ptrs( chip, rf5c68_state_size(), ptrs, ptr_count, kept, kept_count );
+	
+	int ram_size;
+	UINT8* ram = rf5c68_state_ram( chip, &ram_size );
+	copier.copy( ram, ram_size );
+}
@@ -4,6 +4,8 @@
 #ifndef RF5C68_EMU_H
 #define RF5C68_EMU_H
 
+class State_Copier;
+
 class Rf5C68_Emu  {
 	void* chip;
 public:
@@ -34,6 +36,10 @@ public:
 	typedef short sample_t;
 	enum { out_chan_count = 2 }; // stereo
 	void run( int pair_count, sample_t* out );
+	
+	// Saves/loads exact emulation state in place, including mute mask and
+	// RAM
+	void copy_state( State_Copier& );
 };
 
 #endif
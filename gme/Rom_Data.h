@@ -74,6 +74,10 @@ public:
 	// Mirrored using mask_addr().
 	byte* at_addr( int addr );
 	
+	// Memory that all pointers above point into, including padding
+	byte const* mem() const             { return rom.begin(); }
+	int mem_size() const                { return rom.size(); }
+	
 	// Frees memory
 	void clear();
 
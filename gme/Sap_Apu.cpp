@@ -2,6 +2,8 @@
 
 #include "Sap_Apu.h"
 
+#include "State_Copier.h"
+
 /* Copyright (C) 2006-2008 Shay Green. This module is free software; you
 can redistribute it and/or modify it under the terms of the GNU Lesser
 General Public License as published by the Free Software Foundation; either
@@ -329,6 +331,25 @@ void Sap_Apu::write_data( blip_time_t time, int addr, int data )
 	*/
 }
 
+void Sap_Apu::copy_state( State_Copier& copier )
+{
+	for ( int i = 0; i < osc_count; i++ )
+	{
+		osc_t& osc = oscs [i];
+		copier.copy( osc.regs );
+		copier.copy( osc.phase );
+		copier.copy( osc.invert );
+		copier.copy( osc.last_amp );
+		copier.copy( osc.delay );
+		copier.copy( osc.period );
+	}
+	copier.copy( last_time );
+	copier.copy( poly5_pos );
+	copier.copy( poly4_pos );
+	copier.copy( polym_pos );
+	copier.copy( control );
+}
+
 void Sap_Apu::end_frame( blip_time_t end_time )
 {
 	if ( end_time > last_time )
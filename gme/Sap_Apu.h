@@ -6,6 +6,7 @@
 
 #include "blargg_common.h"
 #include "Blip_Buffer.h"
+class State_Copier;
 
 class Sap_Apu_Impl;
 
@@ -32,6 +33,9 @@ public:
 	// Resets sound chip and sets Sap_Apu_Impl
 	void reset( Sap_Apu_Impl* impl );
 	
+	// Saves/loads exact emulation state in place
+	void copy_state( State_Copier& );
+	
 	// Registers are at io_addr to io_addr+io_size-1
 	enum { io_addr = 0xD200 };
 	enum { io_size = 0x0A };
@@ -2,6 +2,8 @@
 
 #include "Sap_Core.h"
 
+#include "State_Copier.h"
+
 /* Copyright (C) 2006-2008 Shay Green. This module is free software; you
 can redistribute it and/or modify it under the terms of the GNU Lesser
 General Public License as published by the Free Software Foundation; either
@@ -167,6 +169,19 @@ blargg_err_t Sap_Core::run_until( time_t end )
 	return blargg_ok;
 }
 
+void Sap_Core::copy_state( State_Copier& copier )
+{
+	copier.add_block( &mem, sizeof mem );
+	cpu.copy_state( copier );
+	copier.copy( mem );
+	copier.copy( saved_state );
+	copier.copy( next_play );
+	copier.copy( time_mask );
+	copier.copy( frame_start );
+	apu_ .copy_state( copier );
+	apu2_.copy_state( copier );
+}
+
 blargg_err_t Sap_Core::end_frame( time_t end )
 {
 	RETURN_ERR( run_until( end ) );
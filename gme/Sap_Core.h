@@ -40,6 +40,9 @@ public:
 	typedef Nes_Cpu::time_t time_t; // Clock count
 	blargg_err_t end_frame( time_t t );
 	
+	// Saves/loads CPU, memory, and sound chip state. Must be called between frames.
+	void copy_state( State_Copier& );
+	
 
 // Implementation
 public:
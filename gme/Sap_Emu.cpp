@@ -2,6 +2,8 @@
 
 #include "Sap_Emu.h"
 
+#include "State_Copier.h"
+
 #include "blargg_endian.h"
 
 /* Copyright (C) 2006-2008 Shay Green. This module is free software; you
@@ -417,6 +419,13 @@ blargg_err_t Sap_Emu::start_track_( int track )
 	return core.start_track( track, info_ );
 }
 
+blargg_err_t Sap_Emu::copy_state_( State_Copier& copier )
+{
+	copier.tag( BLARGG_4CHAR('S','A','P','s') );
+	core.copy_state( copier );
+	return copy_buffer_state( copier );
+}
+
 blargg_err_t Sap_Emu::run_clocks( blip_time_t& duration, int )
 {
 	return core.end_frame( duration );
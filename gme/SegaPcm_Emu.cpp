@@ -3,6 +3,8 @@
 #include "SegaPcm_Emu.h"
 #include "segapcm.h"
 
+#include "State_Copier.h"
+
 SegaPcm_Emu::SegaPcm_Emu() { chip = 0; }
 
 SegaPcm_Emu::~SegaPcm_Emu()
@@ -75,3 +77,14 @@ void SegaPcm_Emu::run( int pair_count, sample_t* out )
 		pair_count -= todo;
 	}
 }
+
+void SegaPcm_Emu::copy_state( State_Copier& copier )
+{
+	int kept [SEGAPCM_STATE_KEPT];
+	int kept_count = segapcm_state_kept( chip, kept );
+	copier.copy_with_ptrs( chip, segapcm_state_size(), NULL, 0, kept, kept_count );
+	
+	int ram_size;
+	UINT8* ram = segapcm_state_ram( chip, &ram_size );
+	copier.copy( ram, ram_size );
+}
@@ -4,6 +4,8 @@
 #ifndef SEGAPCM_EMU_H
 #define SEGAPCM_EMU_H
 
+class State_Copier;
+
 class SegaPcm_Emu  {
 	void* chip;
 public:
@@ -31,6 +33,10 @@ public:
 	typedef short sample_t;
 	enum { out_chan_count = 2 }; // stereo
 	void run( int pair_count, sample_t* out );
+	
+	// Saves/loads exact emulation state in place, including mute mask but
+	// not ROM
+	void copy_state( State_Copier& );
 };
 
 #endif
@@ -2,6 +2,8 @@
 
 #include "Sgc_Core.h"
 
+#include "State_Copier.h"
+
 /* Copyright (C) 2009 Shay Green. This module is free software; you
 can redistribute it and/or modify it under the terms of the GNU Lesser
 General Public License as published by the Free Software Foundation; either
@@ -62,6 +64,18 @@ blargg_err_t Sgc_Core::end_frame( time_t t )
 	return blargg_ok;
 }
 	
+void Sgc_Core::copy_state( State_Copier& copier )
+{
+	Sgc_Impl::copy_state( copier );
+	apu_.copy_state( copier );
+	if ( sega_mapping() )
+	{
+		copier.copy( fm_accessed );
+		if ( fm_apu_.supported() )
+			fm_apu_.copy_state( copier );
+	}
+}
+
 Sgc_Core::Sgc_Core()
 { }
 
@@ -21,6 +21,8 @@ public:
 	// Ends time frame at time t
 	blargg_err_t end_frame( time_t t );
 	
+	virtual void copy_state( State_Copier& );
+	
 	// SN76489 sound chip
 	Sms_Apu& apu()                  { return apu_; }
 	Sms_Fm_Apu& fm_apu()            { return fm_apu_; }
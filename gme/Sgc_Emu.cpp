@@ -2,6 +2,8 @@
 
 #include "Sgc_Emu.h"
 
+#include "State_Copier.h"
+
 /* Copyright (C) 2009 Shay Green. This module is free software; you
 can redistribute it and/or modify it under the terms of the GNU Lesser
 General Public License as published by the Free Software Foundation; either
@@ -108,6 +110,8 @@ gme_type_t_ const gme_sgc_type [1] = {{ "Z80 PSG", 0, &new_sgc_emu, &new_sgc_fil
 blargg_err_t Sgc_Emu::load_( Data_Reader& in )
 {
 	RETURN_ERR( core_.load( in ) );
+	add_file_checksum( &header(), sizeof header() );
+	add_file_checksum( core_.rom_().begin(), core_.rom_().file_size() );
 	set_warning( core_.warning() );
 	set_track_count( header().song_count );
 	set_voice_count( core_.sega_mapping() ? osc_count : core_.apu().osc_count );
@@ -153,6 +157,13 @@ blargg_err_t Sgc_Emu::start_track_( int track )
 	return Classic_Emu::start_track_( track );
 }
 
+blargg_err_t Sgc_Emu::copy_state_( State_Copier& copier )
+{
+	copier.tag( BLARGG_4CHAR('S','G','C','s') );
+	core_.copy_state( copier );
+	return copy_buffer_state( copier );
+}
+
 blargg_err_t Sgc_Emu::run_clocks( blip_time_t& duration, int )
 {
 	RETURN_ERR( core_.end_frame( duration ) );
@@ -2,6 +2,8 @@
 
 #include "Sgc_Impl.h"
 
+#include "State_Copier.h"
+
 /* Copyright (C) 2006-2009 Shay Green. This module is free software; you
 can redistribute it and/or modify it under the terms of the GNU Lesser
 General Public License as published by the Free Software Foundation; either
@@ -195,6 +197,23 @@ void Sgc_Impl::cpu_out( time_t, addr_t addr, int )
 	dprintf( "out %02X\n", addr & 0xFF );
 }
 
+void Sgc_Impl::copy_state( State_Copier& copier )
+{
+	copier.add_block( ram.begin(),            (int) ram.size() );
+	copier.add_block( ram2.begin(),           (int) ram2.size() );
+	copier.add_block( vectors.begin(),        (int) vectors.size() );
+	copier.add_block( unmapped_write.begin(), (int) unmapped_write.size() );
+	copier.add_block( rom.mem(), rom.mem_size() );
+	if ( !sega_mapping() )
+		copier.add_block( coleco_bios, 0x2000 );
+	cpu.copy_state( copier );
+	copier.copy( ram.begin(),     (int) ram.size() );
+	copier.copy( ram2.begin(),    (int) ram2.size() );
+	copier.copy( vectors.begin(), (int) vectors.size() );
+	copier.copy( next_play );
+	copier.copy_ptr( bank2 );
+}
+
 blargg_err_t Sgc_Impl::end_frame( time_t end )
 {
 	while ( cpu.time() < end )
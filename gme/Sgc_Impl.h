@@ -63,6 +63,9 @@ public:
 	// Runs for t clocks
 	blargg_err_t end_frame( time_t t );
 	
+	// Saves/loads CPU, memory, and sound chip state. Must be called between frames.
+	virtual void copy_state( State_Copier& );
+	
 	// True if Master System or Game Gear
 	bool sega_mapping() const;
 	
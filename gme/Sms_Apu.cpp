@@ -2,6 +2,8 @@
 
 #include "Sms_Apu.h"
 
+#include "State_Copier.h"
+
 /* Copyright (C) 2003-2008 Shay Green. This module is free software; you
 can redistribute it and/or modify it under the terms of the GNU Lesser
 General Public License as published by the Free Software Foundation; either
@@ -355,6 +357,31 @@ inline const char* Sms_Apu::save_load( sms_apu_state_t* io, bool save )
 	return 0;
 }
 
+void Sms_Apu::copy_state( State_Copier& copier )
+{
+	for ( int i = 0; i < osc_count; i++ )
+	{
+		Osc& osc = oscs [i];
+		copier.copy( osc.last_amp );
+		copier.copy( osc.volume );
+		copier.copy( osc.period );
+		copier.copy( osc.delay );
+		copier.copy( osc.phase );
+	}
+	copier.copy( ggstereo );
+	copier.copy( latch );
+	copier.copy( last_time );
+	copier.copy( noise_feedback );
+	copier.copy( looped_feedback );
+	
+	// output depends on ggstereo
+	if ( copier.loading() )
+	{
+		for ( int i = 0; i < osc_count; i++ )
+			oscs [i].output = oscs [i].outputs [calc_output( i )];
+	}
+}
+
 void Sms_Apu::save_state( sms_apu_state_t* out )
 {
 	save_load( out, true );
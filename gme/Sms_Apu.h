@@ -8,6 +8,7 @@
 #include "Blip_Buffer.h"
 
 struct sms_apu_state_t;
+class State_Copier;
 
 class Sms_Apu {
 public:
@@ -50,6 +51,9 @@ public:
 	
 	// Loads state. You should call reset() BEFORE this.
 	blargg_err_t load_state( sms_apu_state_t const& in );
+	
+	// Saves/loads exact emulation state in place, in a non-portable format
+	void copy_state( State_Copier& );
 
 private:
 	// noncopyable
@@ -1,5 +1,7 @@
 #include "Sms_Fm_Apu.h"
 
+#include "State_Copier.h"
+
 #include "blargg_source.h"
 
 Sms_Fm_Apu::Sms_Fm_Apu()
@@ -67,6 +69,14 @@ void Sms_Fm_Apu::run_until( blip_time_t end_time )
 	next_time = time;
 }
 
+void Sms_Fm_Apu::copy_state( State_Copier& copier )
+{
+	copier.copy( next_time );
+	copier.copy( last_amp );
+	copier.copy( addr );
+	apu.copy_state( copier );
+}
+
 void Sms_Fm_Apu::end_frame( blip_time_t time )
 {
 	if ( time > next_time )
@@ -19,6 +19,9 @@ public:
 	void write_data( blip_time_t, int data );
 	
 	void end_frame( blip_time_t t );
+	
+	// Saves/loads exact emulation state in place
+	void copy_state( State_Copier& );
 
 // Implementation
 public:
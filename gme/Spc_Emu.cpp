@@ -2,6 +2,7 @@
 
 #include "Spc_Emu.h"
 
+#include "State_Copier.h"
 #include "blargg_endian.h"
 
 /* Copyright (C) 2004-2009 Shay Green. This module is free software; you
@@ -21,11 +22,16 @@ Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA */
 
 Spc_Emu::Spc_Emu()
 {
+	voices    = NULL;
+	voice_out = NULL;
 	set_type( gme_spc_type );
 	set_gain( 1.4 );
 }
 
-Spc_Emu::~Spc_Emu() { }
+Spc_Emu::~Spc_Emu()
+{
+	delete [] voices;
+}
 
 // Track info
 
@@ -320,14 +326,66 @@ gme_type_t_ const gme_spc_type [1] = {{ "Super Nintendo", 1, &new_spc_emu, &new_
 blargg_err_t Spc_Emu::set_sample_rate_( int sample_rate )
 {
 	smp.power();
+	smp.dsp.separate_voices( voices != NULL );
 	if ( sample_rate != native_sample_rate )
 	{
-		RETURN_ERR( resampler.resize_buffer( native_sample_rate / 20 * 2 ) );
-		RETURN_ERR( resampler.set_rate( (double) native_sample_rate / sample_rate ) ); // 0.9965 rolloff
+		RETURN_ERR( set_resampler_rate( resampler, sample_rate ) );
+		
+		if ( voices )
+		{
+			for ( int i = 0; i < voice_count; i++ )
+				RETURN_ERR( set_resampler_rate( voices [i].resampler, sample_rate ) );
+		}
 	}
 	return blargg_ok;
 }
 
+blargg_err_t Spc_Emu::set_resampler_rate( Spc_Emu_Resampler& r, int sample_rate )
+{
+	#if !GME_SPC_FAST_RESAMPLER
+		// wider FIR at full quality
+		r.set_width( quality() ? 24 : 8 );
+	#endif
+	RETURN_ERR( r.resize_buffer( native_sample_rate / 20 * 2 ) );
+	return r.set_rate( (double) native_sample_rate / sample_rate ); // 0.9965 rolloff
+}
+
+void Spc_Emu::set_quality_( int )
+{
+	#if !GME_SPC_FAST_RESAMPLER
+		// Only resampler width depends on quality. Rate was already set
+		// successfully, so re-setting it can only fail on allocation.
+		if ( sample_rate() && sample_rate() != native_sample_rate )
+		{
+			if ( set_resampler_rate( resampler, sample_rate() ) )
+				check( false );
+			
+			if ( voices )
+			{
+				for ( int i = 0; i < voice_count; i++ )
+					if ( set_resampler_rate( voices [i].resampler, sample_rate() ) )
+						check( false );
+			}
+		}
+	#endif
+}
+
+blargg_err_t Spc_Emu::separate_voices_()
+{
+	voices = BLARGG_NEW voice_t [voice_count];
+	CHECK_ALLOC( voices );
+	return blargg_ok;
+}
+
+blargg_err_t Spc_Emu::set_voice_out_( sample_t* const out [] )
+{
+	if ( !voices )
+		return BLARGG_ERR( BLARGG_ERR_CALLER, "emulator not created for voice output" );
+	
+	voice_out = out;
+	return blargg_ok;
+}
+
 void Spc_Emu::mute_voices_( int m )
 {
 	Music_Emu::mute_voices_( m );
@@ -398,13 +456,52 @@ blargg_err_t Spc_Emu::start_track_( int track )
     }
 
 	filter.set_gain( (int) (gain() * Spc_Filter::gain_unit) );
+	if ( voices )
+	{
+		for ( int i = 0; i < voice_count; i++ )
+		{
+			voices [i].resampler.clear();
+			voices [i].filter.clear();
+			voices [i].filter.set_gain( (int) (gain() * Spc_Filter::gain_unit) );
+		}
+	}
 	return blargg_ok;
 }
 
-blargg_err_t Spc_Emu::play_and_filter( int count, sample_t out [] )
+blargg_err_t Spc_Emu::copy_state_( State_Copier& copier )
 {
-	smp.render( out, count );
+	// voices kept separate add to state, so it can't be mixed with other state
+	copier.tag( voices ? BLARGG_4CHAR('S','P','C','v') : BLARGG_4CHAR('S','P','C','s') );
+	smp.copy_state( copier );
+	filter.copy_state( copier );
+	if ( sample_rate() != native_sample_rate )
+		resampler.copy_state( copier );
+	
+	if ( voices )
+	{
+		for ( int i = 0; i < voice_count; i++ )
+		{
+			voices [i].filter.copy_state( copier );
+			if ( sample_rate() != native_sample_rate )
+				voices [i].resampler.copy_state( copier );
+		}
+	}
+	return copier.error();
+}
+
+blargg_err_t Spc_Emu::play_and_filter( int count, sample_t out [], sample_t* const voice_bufs [] )
+{
+	{
+		GME_PROFILE_STAGE( emulate );
+		smp.render( out, count, voice_bufs );
+	}
+	GME_PROFILE_STAGE( filter );
 	filter.run( out, count );
+	if ( voice_bufs )
+	{
+		for ( int i = 0; i < voice_count; i++ )
+			voices [i].filter.run( voice_bufs [i], count );
+	}
 	return blargg_ok;
 }
 
@@ -413,6 +510,11 @@ blargg_err_t Spc_Emu::skip_( int count )
 	if ( sample_rate() != native_sample_rate )
 	{
 		count = (int) (count * resampler.rate()) & ~1;
+		if ( voices )
+		{
+			for ( int i = 0; i < voice_count; i++ )
+				voices [i].resampler.skip_input( count );
+		}
 		count -= resampler.skip_input( count );
 	}
 	
@@ -420,8 +522,14 @@ blargg_err_t Spc_Emu::skip_( int count )
 	
 	if ( count > 0 )
 	{
+		GME_PROFILE_STAGE( emulate );
 		smp.skip( count );
 		filter.clear();
+		if ( voices )
+		{
+			for ( int i = 0; i < voice_count; i++ )
+				voices [i].filter.clear();
+		}
 	}
 	
 	// eliminate pop due to resampler
@@ -435,8 +543,58 @@ blargg_err_t Spc_Emu::skip_( int count )
 	return blargg_ok;
 }
 
+// Where voice i's samples at pos go, its buf if they aren't wanted
+inline Spc_Emu::sample_t* Spc_Emu::voice_dest( int i, int pos )
+{
+	if ( voice_out && voice_out [i] )
+		return &voice_out [i] [pos];
+	return voices [i].buf;
+}
+
+// Same as play_(), but voices are kept separate. Every voice is always run
+// through its filter and resampler, so they stay in step with the main output
+// whether or not their output is wanted.
+blargg_err_t Spc_Emu::play_separate( int count, sample_t out [] )
+{
+	sample_t* bufs [voice_count];
+	int pos = 0;
+	while ( pos < count )
+	{
+		int n = min( count - pos, (int) voice_buf_size );
+		if ( sample_rate() == native_sample_rate )
+		{
+			for ( int i = 0; i < voice_count; i++ )
+				bufs [i] = voice_dest( i, pos );
+			RETURN_ERR( play_and_filter( n, &out [pos], bufs ) );
+		}
+		else
+		{
+			// resamplers are in step, so each voice reads as many as main
+			n = resampler.read( &out [pos], n );
+			for ( int i = 0; i < voice_count; i++ )
+				voices [i].resampler.read( voice_dest( i, pos ), n );
+			
+			if ( !n )
+			{
+				int free = resampler.buffer_free();
+				for ( int i = 0; i < voice_count; i++ )
+					bufs [i] = voices [i].resampler.buffer();
+				RETURN_ERR( play_and_filter( free, resampler.buffer(), bufs ) );
+				resampler.write( free );
+				for ( int i = 0; i < voice_count; i++ )
+					voices [i].resampler.write( free );
+			}
+		}
+		pos += n;
+	}
+	return blargg_ok;
+}
+
 blargg_err_t Spc_Emu::play_( int count, sample_t out [] )
 {
+	if ( voices )
+		return play_separate( count, out );
+	
 	if ( sample_rate() == native_sample_rate )
 		return play_and_filter( count, out );
 	
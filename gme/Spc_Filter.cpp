@@ -2,6 +2,8 @@
 
 #include "Spc_Filter.h"
 
+#include "State_Copier.h"
+
 /* Copyright (C) 2007 Shay Green. This module is free software; you
 can redistribute it and/or modify it under the terms of the GNU Lesser
 General Public License as published by the Free Software Foundation; either
@@ -30,12 +32,16 @@ static short hard_limit_sample( int sample )
     return val * 32768.0;
 }
 
-void Spc_Filter::build_limit_table()
+// Shared by all filters, since it's the same for all and 256K in size
+static short hard_limit_table[131072];
+
+static bool build_limit_table()
 {
     for (int i = -65536; i < 65536; ++i)
     {
         hard_limit_table[ i + 65536 ] = hard_limit_sample( i );
     }
+    return true;
 }
 
 inline short Spc_Filter::limit_sample(int sample)
@@ -48,13 +54,22 @@ inline short Spc_Filter::limit_sample(int sample)
 
 void Spc_Filter::clear() { limiting = false; memset( ch, 0, sizeof ch ); }
 
+void Spc_Filter::copy_state( State_Copier& copier )
+{
+	copier.copy( ch );
+	copier.copy( limiting );
+}
+
 Spc_Filter::Spc_Filter()
 {
 	enabled = true;
 	gain    = gain_unit;
 	bass    = bass_norm;
 	clear();
-    build_limit_table();
+    
+    // built by first filter created (initialization of local static is thread-safe)
+    static bool const limit_table_built = build_limit_table();
+    (void) limit_table_built;
 }
 
 void Spc_Filter::run( short io [], int count )
@@ -5,6 +5,7 @@
 #define SPC_FILTER_H
 
 #include "blargg_common.h"
+class State_Copier;
 
 struct Spc_Filter {
 public:
@@ -32,6 +33,9 @@ public:
 	enum { bass_max  = 31 };
 	void set_bass( int bass );
 	
+	// Saves/loads filter state
+	void copy_state( State_Copier& );
+	
 public:
 	Spc_Filter();
 	BLARGG_DISABLE_NOTHROW
@@ -43,8 +47,6 @@ private:
     bool limiting;
 	struct chan_t { int p1, pp1, sum; };
 	chan_t ch [2];
-    short hard_limit_table[131072];
-    void build_limit_table();
     inline short limit_sample(int sample);
 };
 
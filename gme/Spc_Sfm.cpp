@@ -2,6 +2,7 @@
 
 #include "Spc_Sfm.h"
 
+#include "State_Copier.h"
 #include "blargg_endian.h"
 
 #include <stdio.h>
@@ -23,13 +24,18 @@ Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA */
 
 Sfm_Emu::Sfm_Emu()
 {
+    voices    = NULL;
+    voice_out = NULL;
     set_type( gme_sfm_type );
     set_gain( 1.4 );
     set_max_initial_silence( 30 );
 	set_silence_lookahead( 30 ); // Some SFMs may have a lot of initialization code
 }
 
-Sfm_Emu::~Sfm_Emu() { }
+Sfm_Emu::~Sfm_Emu()
+{
+    delete [] voices;
+}
 
 // Track info
 
@@ -173,14 +179,65 @@ gme_type_t_ const gme_sfm_type [1] = {{ "Super Nintendo with log", 1, &new_sfm_e
 blargg_err_t Sfm_Emu::set_sample_rate_( int sample_rate )
 {
     smp.power();
+    smp.dsp.separate_voices( voices != NULL );
     if ( sample_rate != native_sample_rate )
     {
-        RETURN_ERR( resampler.resize_buffer( native_sample_rate / 20 * 2 ) );
-        RETURN_ERR( resampler.set_rate( (double) native_sample_rate / sample_rate ) ); // 0.9965 rolloff
+        RETURN_ERR( set_resampler_rate( resampler, sample_rate ) );
+        
+        if ( voices )
+        {
+            for ( int i = 0; i < voice_count; i++ )
+                RETURN_ERR( set_resampler_rate( voices [i].resampler, sample_rate ) );
+        }
     }
     return blargg_ok;
 }
 
+blargg_err_t Sfm_Emu::set_resampler_rate( Spc_Emu_Resampler& r, int sample_rate )
+{
+#if !GME_SPC_FAST_RESAMPLER
+    // wider FIR at full quality
+    r.set_width( quality() ? 24 : 8 );
+#endif
+    RETURN_ERR( r.resize_buffer( native_sample_rate / 20 * 2 ) );
+    return r.set_rate( (double) native_sample_rate / sample_rate ); // 0.9965 rolloff
+}
+
+void Sfm_Emu::set_quality_( int )
+{
+#if !GME_SPC_FAST_RESAMPLER
+    // Only resampler width depends on quality
+    if ( sample_rate() && sample_rate() != native_sample_rate )
+    {
+        if ( set_resampler_rate( resampler, sample_rate() ) )
+            check( false );
+        
+        if ( voices )
+        {
+            for ( int i = 0; i < voice_count; i++ )
+                if ( set_resampler_rate( voices [i].resampler, sample_rate() ) )
+                    check( false );
+        }
+    }
+#endif
+}
+
+blargg_err_t Sfm_Emu::separate_voices_()
+{
+    voices = BLARGG_NEW voice_t [voice_count];
+    CHECK_ALLOC( voices );
+    return blargg_ok;
+}
+
+blargg_err_t Sfm_Emu::set_voice_out_( sample_t* const out [] )
+{
+    if ( !voices )
+        return BLARGG_ERR( BLARGG_ERR_CALLER, "emulator not created for voice output" );
+    
+    voice_out = out;
+    return blargg_ok;
+}
+
 void Sfm_Emu::mute_voices_( int m )
 {
     Music_Emu::mute_voices_( m );
@@ -429,7 +486,7 @@ blargg_err_t Sfm_Emu::start_track_( int track )
         {
             for (int j = 0; j < SuperFamicom::SPC_DSP::brr_buf_size; ++j)
             {
-                voice.buf[j] = voice.buf[j + SuperFamicom::SPC_DSP::brr_buf_size] = strtol(value, &end, 10);
+                voice.buf[j] = voice.buf[j + SuperFamicom::SPC_DSP::brr_buf_size] = (int16_t) strtol(value, &end, 10);
                 if (!*end) break;
                 value = end + 1;
             }
@@ -447,6 +504,15 @@ blargg_err_t Sfm_Emu::start_track_( int track )
     }
 
     filter.set_gain( (int) (gain() * Spc_Filter::gain_unit) );
+    if ( voices )
+    {
+        for ( int i = 0; i < voice_count; i++ )
+        {
+            voices [i].resampler.clear();
+            voices [i].filter.clear();
+            voices [i].filter.set_gain( (int) (gain() * Spc_Filter::gain_unit) );
+        }
+    }
     return blargg_ok;
 }
 
@@ -618,10 +684,36 @@ blargg_err_t Sfm_Emu::save_( gme_writer_t writer, void* your_data ) const
     return blargg_ok;
 }
 
-blargg_err_t Sfm_Emu::play_and_filter( int count, sample_t out [] )
+blargg_err_t Sfm_Emu::copy_state_( State_Copier& copier )
+{
+    // voices kept separate add to state, so it can't be mixed with other state
+    copier.tag( voices ? BLARGG_4CHAR('S','F','M','v') : BLARGG_4CHAR('S','F','M','s') );
+    smp.copy_state( copier );
+    filter.copy_state( copier );
+    if ( sample_rate() != native_sample_rate )
+        resampler.copy_state( copier );
+    
+    if ( voices )
+    {
+        for ( int i = 0; i < voice_count; i++ )
+        {
+            voices [i].filter.copy_state( copier );
+            if ( sample_rate() != native_sample_rate )
+                voices [i].resampler.copy_state( copier );
+        }
+    }
+    return copier.error();
+}
+
+blargg_err_t Sfm_Emu::play_and_filter( int count, sample_t out [], sample_t* const voice_bufs [] )
 {
-    smp.render( out, count );
+    smp.render( out, count, voice_bufs );
     filter.run( out, count );
+    if ( voice_bufs )
+    {
+        for ( int i = 0; i < voice_count; i++ )
+            voices [i].filter.run( voice_bufs [i], count );
+    }
     return blargg_ok;
 }
 
@@ -630,6 +722,11 @@ blargg_err_t Sfm_Emu::skip_( int count )
     if ( sample_rate() != native_sample_rate )
     {
         count = (int) (count * resampler.rate()) & ~1;
+        if ( voices )
+        {
+            for ( int i = 0; i < voice_count; i++ )
+                voices [i].resampler.skip_input( count );
+        }
         count -= resampler.skip_input( count );
     }
 
@@ -639,6 +736,11 @@ blargg_err_t Sfm_Emu::skip_( int count )
     {
         smp.skip( count );
         filter.clear();
+        if ( voices )
+        {
+            for ( int i = 0; i < voice_count; i++ )
+                voices [i].filter.clear();
+        }
     }
 
 	if ( sample_rate() != native_sample_rate )
@@ -652,8 +754,56 @@ blargg_err_t Sfm_Emu::skip_( int count )
 	return blargg_ok;
 }
 
+// Where voice i's samples at pos go, its buf if they aren't wanted
+inline Sfm_Emu::sample_t* Sfm_Emu::voice_dest( int i, int pos )
+{
+    if ( voice_out && voice_out [i] )
+        return &voice_out [i] [pos];
+    return voices [i].buf;
+}
+
+// Same as Spc_Emu::play_separate()
+blargg_err_t Sfm_Emu::play_separate( int count, sample_t out [] )
+{
+    sample_t* bufs [voice_count];
+    int pos = 0;
+    while ( pos < count )
+    {
+        int n = min( count - pos, (int) voice_buf_size );
+        if ( sample_rate() == native_sample_rate )
+        {
+            for ( int i = 0; i < voice_count; i++ )
+                bufs [i] = voice_dest( i, pos );
+            RETURN_ERR( play_and_filter( n, &out [pos], bufs ) );
+        }
+        else
+        {
+            // resamplers are in step, so each voice reads as many as main
+            n = resampler.read( &out [pos], n );
+            for ( int i = 0; i < voice_count; i++ )
+                voices [i].resampler.read( voice_dest( i, pos ), n );
+            
+            if ( !n )
+            {
+                int free = resampler.buffer_free();
+                for ( int i = 0; i < voice_count; i++ )
+                    bufs [i] = voices [i].resampler.buffer();
+                RETURN_ERR( play_and_filter( free, resampler.buffer(), bufs ) );
+                resampler.write( free );
+                for ( int i = 0; i < voice_count; i++ )
+                    voices [i].resampler.write( free );
+            }
+        }
+        pos += n;
+    }
+    return blargg_ok;
+}
+
 blargg_err_t Sfm_Emu::play_( int count, sample_t out [] )
 {
+    if ( voices )
+        return play_separate( count, out );
+    
     if ( sample_rate() == native_sample_rate )
         return play_and_filter( count, out );
 
@@ -15,7 +15,7 @@
     typedef Upsampler Spc_Emu_Resampler;
 #else
     #include "Fir_Resampler.h"
-    typedef Fir_Resampler<24> Spc_Emu_Resampler;
+    typedef Fir_Resampler_Dynamic Spc_Emu_Resampler;
 #endif
 
 class Sfm_Emu : public Music_Emu {
@@ -53,22 +53,41 @@ protected:
     virtual blargg_err_t track_info_( track_info_t*, int track ) const;
     virtual blargg_err_t set_track_info_( const track_info_t*, int track );
     virtual blargg_err_t set_sample_rate_( int );
+    virtual void set_quality_( int );
     virtual blargg_err_t start_track_( int );
     virtual blargg_err_t play_( int, sample_t [] );
     virtual blargg_err_t skip_( int );
     virtual void mute_voices_( int );
     virtual void set_tempo_( double );
     virtual blargg_err_t save_( gme_writer_t, void* ) const;
+    virtual blargg_err_t copy_state_( State_Copier& );
+    virtual blargg_err_t separate_voices_();
+    virtual blargg_err_t set_voice_out_( sample_t* const [] );
 
 private:
     Spc_Emu_Resampler resampler;
     Spc_Filter filter;
     SuperFamicom::SMP smp;
 
+    // Separate voices, as in Spc_Emu
+    enum { voice_count = SuperFamicom::SPC_DSP::voice_count };
+    enum { voice_buf_size = native_sample_rate / 20 * 2 };
+    struct voice_t
+    {
+        Spc_Filter filter;
+        Spc_Emu_Resampler resampler;
+        sample_t buf [voice_buf_size];
+    };
+    voice_t* voices;            // NULL unless voices are kept separate
+    sample_t* const* voice_out; // NULL if voice output isn't wanted
+
     Bml_Parser metadata;
     void create_updated_metadata(Bml_Parser &out) const;
 
-    blargg_err_t play_and_filter( int count, sample_t out [] );
+    blargg_err_t set_resampler_rate( Spc_Emu_Resampler&, int sample_rate );
+    blargg_err_t play_and_filter( int count, sample_t out [], sample_t* const voice_bufs [] = NULL );
+    blargg_err_t play_separate( int count, sample_t out [] );
+    sample_t* voice_dest( int i, int pos );
 };
 
 inline SuperFamicom::SMP const* Sfm_Emu::get_smp() const { return &smp; }
@@ -0,0 +1,168 @@
+// Game_Music_Emu $vers. http://www.slack.net/~ant/
+
+#include "State_Copier.h"
+
+/* Copyright (C) 2003-2008 Shay Green. This module is free software; you
+can redistribute it and/or modify it under the terms of the GNU Lesser
+General Public License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version. This
+module is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+details. You should have received a copy of the GNU Lesser General Public
+License along with this module; if not, write to the Free Software Foundation,
+Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA */
+
+#include "blargg_source.h"
+
+State_Copier::State_Copier( mode_t mode, void* p, int size )
+{
+	mode_  = mode;
+	begin  = (unsigned char*) p;
+	pos    = 0;
+	limit  = (mode == mode_measure ? INT_MAX : size);
+	error_ = blargg_ok;
+	block_count = 0;
+}
+
+void State_Copier::set_error( blargg_err_t err )
+{
+	if ( !error_ )
+		error_ = err;
+}
+
+unsigned char* State_Copier::reserve( int size )
+{
+	if ( error_ )
+		return NULL;
+	
+	if ( size > limit - pos )
+	{
+		set_error( loading() ? BLARGG_ERR( BLARGG_ERR_FILE_EOF, "state" ) :
+				BLARGG_ERR( BLARGG_ERR_CALLER, "state buffer too small" ) );
+		return NULL;
+	}
+	
+	unsigned char* p = (mode_ == mode_measure ? NULL : begin + pos);
+	pos += size;
+	return p;
+}
+
+void State_Copier::copy( void* p, int size )
+{
+	unsigned char* s = reserve( size );
+	if ( s && size ) // p can be NULL if size is zero
+	{
+		if ( loading() )
+			memcpy( p, s, size );
+		else
+			memcpy( s, p, size );
+	}
+}
+
+void State_Copier::copy_var( void* p, int size, int max_size )
+{
+	if ( (unsigned) size > (unsigned) max_size )
+	{
+		set_error( BLARGG_ERR( BLARGG_ERR_FILE_CORRUPT, "state" ) );
+		return;
+	}
+	
+	if ( mode_ == mode_measure )
+		size = max_size;
+	
+	copy( p, size );
+}
+
+void State_Copier::add_block( void const* p, int size )
+{
+	// size catches state for different file
+	int n = size;
+	copy( n );
+	if ( n != size )
+		set_error( BLARGG_ERR( BLARGG_ERR_CALLER, "state is for different file, track, tempo, or sample rate" ) );
+	
+	if ( block_count >= max_blocks )
+	{
+		set_error( BLARGG_ERR( BLARGG_ERR_INTERNAL, "too many state blocks" ) );
+		return;
+	}
+	block_t& b = blocks [block_count++];
+	b.begin = (unsigned char const*) p;
+	b.size  = size;
+}
+
+void State_Copier::copy_ptr_( void const*& p )
+{
+	// block is -1 for NULL
+	int block  = -1;
+	int offset = 0;
+	if ( !loading() && p )
+	{
+		unsigned char const* bp = (unsigned char const*) p;
+		for ( block = block_count; --block >= 0; )
+		{
+			block_t const& b = blocks [block];
+			if ( bp >= b.begin && bp <= b.begin + b.size )
+			{
+				offset = (int) (bp - b.begin);
+				break;
+			}
+		}
+		if ( block < 0 )
+			set_error( BLARGG_ERR( BLARGG_ERR_INTERNAL, "pointer outside state blocks" ) );
+	}
+	
+	copy( block );
+	copy( offset );
+	
+	if ( loading() && !error_ )
+	{
+		if ( block < 0 )
+			p = NULL;
+		else if ( block < block_count && (unsigned) offset <= (unsigned) blocks [block].size )
+			p = blocks [block].begin + offset;
+		else
+			set_error( BLARGG_ERR( BLARGG_ERR_FILE_CORRUPT, "state" ) );
+	}
+}
+
+void State_Copier::copy_with_ptrs( void* p, int size, int const ptrs [], int count,
+		int const keep [], int keep_count )
+{
+	unsigned char* s = (unsigned char*) p;
+	int done = 0;
+	int i = 0;
+	int k = 0;
+	while ( i < count || k < keep_count )
+	{
+		// take lower offset of the two lists
+		bool kept = (i >= count || (k < keep_count && keep [k] < ptrs [i]));
+		int offset = (kept ? keep [k++] : ptrs [i++]);
+		if ( offset < done || offset > size - (int) sizeof (void*) )
+		{
+			set_error( BLARGG_ERR( BLARGG_ERR_INTERNAL, "bad state pointer offset" ) );
+			return;
+		}
+		copy( s + done, offset - done );
+		
+		if ( !kept )
+		{
+			// memcpy since pointer field can be of any type
+			void const* v;
+			memcpy( &v, s + offset, sizeof v );
+			copy_ptr_( v );
+			memcpy( s + offset, &v, sizeof v );
+		}
+		done = offset + (int) sizeof (void*);
+	}
+	copy( s + done, size - done );
+}
+
+void State_Copier::tag( int four_char )
+{
+	int t = four_char;
+	copy( t );
+	if ( t != four_char )
+		set_error( BLARGG_ERR( BLARGG_ERR_FILE_TYPE, "state doesn't match emulator" ) );
+}
@@ -0,0 +1,89 @@
+// Copies emulator state to and from a flat block of memory
+
+// Game_Music_Emu $vers
+#ifndef STATE_COPIER_H
+#define STATE_COPIER_H
+
+#include "blargg_common.h"
+
+/* The same copy_state() function of a component is used to measure, save, and
+load its state, so the three can't get out of step. State is a raw image of
+emulator memory, except that pointers are saved as positions within blocks of
+memory, so it can be loaded into any emulator with the same file loaded, in the
+same process. After the first error, all further copying is ignored. */
+class State_Copier {
+public:
+	enum mode_t { mode_measure, mode_save, mode_load };
+	
+	// Sets up copier for size bytes at p. P isn't used when measuring.
+	State_Copier( mode_t, void* p = NULL, int size = 0 );
+	
+	// True if state is being loaded, as opposed to measured or saved
+	bool loading() const                    { return mode_ == mode_load; }
+	
+	// Copies size bytes between p and state
+	void copy( void* p, int size );
+	
+	// Copies variable or structure in place
+	template<class T>
+	void copy( T& t )                       { copy( &t, sizeof t ); }
+	
+	// Copies size bytes between p and state, where size varies at run-time and
+	// must not exceed max_size. Space for max_size is counted when measuring, so
+	// that the measured size is always enough. Size must already have been copied.
+	void copy_var( void* p, int size, int max_size );
+	
+	// Adds block of memory that pointers copied with copy_ptr() can point into.
+	// Blocks must be added in the same order and with the same sizes when
+	// saving and loading.
+	void add_block( void const* p, int size );
+	
+	// Copies pointer as index of block it points into and offset within that
+	// block. Pointer can be NULL or point to end of block.
+	template<class T>
+	void copy_ptr( T*& p )                  { void const* v = p; copy_ptr_( v ); p = (T*) v; }
+	
+	// Copies size bytes at p, except that the pointers at byte offsets ptrs [0]
+	// to ptrs [count-1], which must be in increasing order, are copied with
+	// copy_ptr(). Pointers at keep [0] to keep [keep_count-1], also in
+	// increasing order, aren't copied at all, for memory that the structure
+	// allocated itself or that belongs to its owner. Used for structures of C
+	// code.
+	void copy_with_ptrs( void* p, int size, int const ptrs [], int count,
+			int const keep [] = NULL, int keep_count = 0 );
+	
+	// Reserves size bytes for a component that copies its own state, and returns
+	// pointer to them, or NULL if measuring or there isn't enough space.
+	unsigned char* reserve( int size );
+	
+	// Saves tag, or when loading, verifies that it matches. Catches state
+	// written by different code.
+	void tag( int four_char );
+	
+	// Makes error() return err, unless an error was already set
+	void set_error( blargg_err_t err );
+	
+	// Number of bytes copied so far. When measuring, space needed so far.
+	int size() const                        { return pos; }
+	
+	// Error that occurred, or NULL if none
+	blargg_err_t error() const              { return error_; }
+	
+private:
+	enum { max_blocks = 96 };
+	struct block_t {
+		unsigned char const* begin;
+		int size;
+	};
+	block_t blocks [max_blocks];
+	int block_count;
+	unsigned char* begin;
+	int pos;
+	int limit;
+	mode_t mode_;
+	blargg_err_t error_;
+	
+	void copy_ptr_( void const*& );
+};
+
+#endif
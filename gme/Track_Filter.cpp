@@ -2,6 +2,8 @@
 
 #include "Track_Filter.h"
 
+#include "State_Copier.h"
+
 /* Copyright (C) 2003-2008 Shay Green. This module is free software; you
 can redistribute it and/or modify it under the terms of the GNU Lesser
 General Public License as published by the Free Software Foundation; either
@@ -54,6 +56,23 @@ Track_Filter::Track_Filter() : setup_()
 
 Track_Filter::~Track_Filter() { }
 
+void Track_Filter::copy_state( State_Copier& copier )
+{
+	int ended = track_ended_;
+	copier.copy( out_time );
+	copier.copy( emu_time );
+	copier.copy( emu_track_ended_ );
+	copier.copy( ended );
+	track_ended_ = ended;
+	copier.copy( silence_time );
+	copier.copy( silence_count );
+	
+	// buffered samples are at end of buf
+	copier.copy( buf_remain );
+	copier.copy_var( buf.begin() + (buf_size - buf_remain), buf_remain * sizeof (wide_sample_t),
+			buf_size * sizeof (wide_sample_t) );
+}
+
 blargg_err_t Track_Filter::start_track()
 {
 	emu_error = NULL;
@@ -77,6 +96,11 @@ blargg_err_t Track_Filter::start_track()
 	return emu_error;
 }
 
+bool Track_Filter::passes_through() const
+{
+	return silence_ignored_ && fade_start == indefinite_count && !(silence_count | buf_remain);
+}
+
 void Track_Filter::end_track_if_error( blargg_err_t err )
 {
 	if ( err )
@@ -123,7 +147,7 @@ blargg_err_t Track_Filter::skip_( int count )
 		if ( n > count )
 			n = count;
 		count -= n;
-		RETURN_ERR( callbacks->play_( n, buf.begin() ) );
+		RETURN_ERR( callbacks->play_( n, (sample_t*) buf.begin() ) ); // wide buf has plenty of room
 	}
 	return blargg_ok;
 }
@@ -151,7 +175,19 @@ static int int_log( int x, int step, int unit )
 	return ((unit - fraction) + (fraction >> 1)) >> shift;
 }
 
-void Track_Filter::handle_fade( sample_t out [], int out_count )
+// (s * gain) >> shift, without overflow for wide samples
+static inline Track_Filter::sample_t fade_sample( Track_Filter::sample_t s, int gain, int shift )
+{
+	return Track_Filter::sample_t ((s * gain) >> shift);
+}
+
+static inline Track_Filter::wide_sample_t fade_sample( Track_Filter::wide_sample_t s, int gain, int shift )
+{
+	return Track_Filter::wide_sample_t ((BOOST::int64_t) s * gain >> shift);
+}
+
+template<class T>
+void Track_Filter::handle_fade( T out [], int out_count )
 {
 	for ( int i = 0; i < out_count; i += fade_block_size )
 	{
@@ -162,10 +198,10 @@ void Track_Filter::handle_fade( sample_t out [], int out_count )
 		if ( gain < (unit >> fade_shift) )
 			track_ended_ = emu_track_ended_ = true;
 		
-		sample_t* io = &out [i];
+		T* io = &out [i];
 		for ( int count = min( fade_block_size, out_count - i ); count; --count )
 		{
-			*io = sample_t ((*io * gain) >> shift);
+			*io = fade_sample( *io, gain, shift );
 			++io;
 		}
 	}
@@ -182,12 +218,22 @@ void Track_Filter::emu_play( sample_t out [], int count )
 		memset( out, 0, count * sizeof *out );
 }
 
+void Track_Filter::emu_play( wide_sample_t out [], int count )
+{
+	emu_time += count;
+	if ( !emu_track_ended_ )
+		end_track_if_error( callbacks->play_wide_( count, out ) );
+	else
+		memset( out, 0, count * sizeof *out );
+}
+
 // number of consecutive silent samples at end
-static int count_silence( Track_Filter::sample_t begin [], int size )
+template<class T>
+static int count_silence( T begin [], int size )
 {
-	Track_Filter::sample_t first = *begin;
+	T first = *begin;
 	*begin = silence_threshold * 2; // sentinel
-	Track_Filter::sample_t* p = begin + size;
+	T* p = begin + size;
 	while ( (unsigned) (*--p + silence_threshold) <= (unsigned) silence_threshold * 2 ) { }
 	*begin = first;
 	return size - (p - begin);
@@ -211,7 +257,35 @@ void Track_Filter::fill_buf()
 	silence_count += buf_size;
 }
 
+// Copies buffered samples to out, clamping them if out is 16-bit
+static void copy_samples( Track_Filter::sample_t out [], Track_Filter::wide_sample_t const in [], int count )
+{
+	for ( int i = 0; i < count; i++ )
+	{
+		int s = in [i];
+		if ( (Track_Filter::sample_t) s != s )
+			s = 0x7FFF ^ (s >> 31);
+		out [i] = (Track_Filter::sample_t) s;
+	}
+}
+
+static void copy_samples( Track_Filter::wide_sample_t out [], Track_Filter::wide_sample_t const in [], int count )
+{
+	memcpy( out, in, count * sizeof *out );
+}
+
 blargg_err_t Track_Filter::play( int out_count, sample_t out [] )
+{
+	return play_samples( out_count, out );
+}
+
+blargg_err_t Track_Filter::play( int out_count, wide_sample_t out [] )
+{
+	return play_samples( out_count, out );
+}
+
+template<class T>
+blargg_err_t Track_Filter::play_samples( int out_count, T out [] )
 {
 	emu_error = NULL;
 	if ( track_ended_ )
@@ -256,7 +330,7 @@ blargg_err_t Track_Filter::play( int out_count, sample_t out [] )
 		if ( buf_remain )
 		{
 			int n = min( buf_remain, (int) (out_count - pos) );
-			memcpy( out + pos, buf.begin() + (buf_size - buf_remain), n * sizeof *out );
+			copy_samples( out + pos, buf.begin() + (buf_size - buf_remain), n );
 			buf_remain -= n;
 			pos += n;
 		}
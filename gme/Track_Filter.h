@@ -6,17 +6,20 @@
 #define TRACK_FILTER_H
 
 #include "blargg_common.h"
+class State_Copier;
 
 class Track_Filter {
 public:
 	typedef int sample_count_t;
 	typedef short sample_t;
+	typedef int wide_sample_t; // same scale as sample_t, but not clamped to 16 bits
 	
 	enum { indefinite_count = INT_MAX/2 + 1 };
 	
 	struct callbacks_t {
 		// Samples may be stereo or mono
 		virtual blargg_err_t play_( int count, sample_t* out )  BLARGG_PURE( { return blargg_ok; } )
+		virtual blargg_err_t play_wide_( int count, wide_sample_t* out ) BLARGG_PURE( { return blargg_ok; } )
 		virtual blargg_err_t skip_( int count )                 BLARGG_PURE( { return blargg_ok; } )
 		virtual ~callbacks_t() { } // avoids silly "non-virtual dtor" warning
 	};
@@ -46,9 +49,16 @@ public:
 	// Generates n samples into buf
 	blargg_err_t play( int n, sample_t buf [] );
 	
+	// Generates n samples into buf, without clamping them to 16 bits
+	blargg_err_t play( int n, wide_sample_t buf [] );
+	
 	// Skips n samples
 	blargg_err_t skip( int n );
 	
+	// True if play() currently generates samples directly, without buffering,
+	// removing silence, or fading them
+	bool passes_through() const;
+	
 	// Number of samples played/skipped since start_track()
 	int sample_count() const                    { return out_time; }
 	
@@ -59,6 +69,9 @@ public:
 	// Clears state
 	void stop();
 	
+	// Saves/loads timing and buffered samples
+	void copy_state( State_Copier& );
+	
 // For use by callbacks
 
 	// Sets internal "track ended" flag and stops generation of further source samples
@@ -90,16 +103,18 @@ private:
 	int fade_start;
 	int fade_step;
 	bool is_fading() const;
-	void handle_fade( sample_t out [], int count );
+	template<class T> void handle_fade( T out [], int count );
 	
 	// Silence detection
 	int silence_time;   // absolute number of samples where most recent silence began
 	int silence_count;  // number of samples of silence to play before using buf
 	int buf_remain;     // number of samples left in silence buffer
 	enum { buf_size = 2048 };
-	blargg_vector<sample_t> buf;
+	blargg_vector<wide_sample_t> buf; // wide so that either output can be made from it
 	void fill_buf();
 	void emu_play( sample_t out [], int count );
+	void emu_play( wide_sample_t out [], int count );
+	template<class T> blargg_err_t play_samples( int n, T buf [] );
 };
 
 #endif
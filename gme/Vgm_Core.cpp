@@ -4,6 +4,8 @@
 
 #include "dac_control.h"
 
+#include "State_Copier.h"
+#include "Gme_Profiler.h"
 #include "blargg_endian.h"
 #include <math.h>
 
@@ -130,84 +132,99 @@ inline int command_len( int command )
 
 int Vgm_Core::run_ym2151( int chip, int time )
 {
+	GME_PROFILE_CHIP( ym2151, ym2151[!!chip].enabled() );
 	return ym2151[!!chip].run_until( time );
 }
 
 int Vgm_Core::run_ym2203( int chip, int time )
 {
+	GME_PROFILE_CHIP( ym2203, ym2203[!!chip].enabled() );
 	return ym2203[!!chip].run_until( time );
 }
 
 int Vgm_Core::run_ym2413( int chip, int time )
 {
+	GME_PROFILE_CHIP( ym2413, ym2413[!!chip].enabled() );
 	return ym2413[!!chip].run_until( time );
 }
 
 int Vgm_Core::run_ym2612( int chip, int time )
 {
+	GME_PROFILE_CHIP( ym2612, ym2612[!!chip].enabled() );
 	return ym2612[!!chip].run_until( time );
 }
 
 int Vgm_Core::run_ym2610( int chip, int time )
 {
+	GME_PROFILE_CHIP( ym2610, ym2610[!!chip].enabled() );
 	return ym2610[!!chip].run_until( time );
 }
 
 int Vgm_Core::run_ym2608( int chip, int time )
 {
+	GME_PROFILE_CHIP( ym2608, ym2608[!!chip].enabled() );
 	return ym2608[!!chip].run_until( time );
 }
 
 int Vgm_Core::run_ym3812( int chip, int time )
 {
+	GME_PROFILE_CHIP( ym3812, ym3812[!!chip].enabled() );
 	return ym3812[!!chip].run_until( time );
 }
 
 int Vgm_Core::run_ymf262( int chip, int time )
 {
+	GME_PROFILE_CHIP( ymf262, ymf262[!!chip].enabled() );
 	return ymf262[!!chip].run_until( time );
 }
 
 int Vgm_Core::run_ymz280b( int time )
 {
+	GME_PROFILE_CHIP( ymz280b, ymz280b.enabled() );
 	return ymz280b.run_until( time );
 }
 
 int Vgm_Core::run_c140( int time )
 {
+	GME_PROFILE_CHIP( c140, c140.enabled() );
 	return c140.run_until( time );
 }
 
 int Vgm_Core::run_segapcm( int time )
 {
+	GME_PROFILE_CHIP( segapcm, segapcm.enabled() );
 	return segapcm.run_until( time );
 }
 
 int Vgm_Core::run_rf5c68( int time )
 {
+	GME_PROFILE_CHIP( rf5c68, rf5c68.enabled() );
 	return rf5c68.run_until( time );
 }
 
 int Vgm_Core::run_rf5c164( int time )
 {
+	GME_PROFILE_CHIP( rf5c164, rf5c164.enabled() );
 	return rf5c164.run_until( time );
 }
 
 int Vgm_Core::run_pwm( int time )
 {
+	GME_PROFILE_CHIP( pwm, pwm.enabled() );
 	return pwm.run_until( time );
 }
 
 int Vgm_Core::run_okim6258( int chip, int time )
 {
     chip = !!chip;
+	GME_PROFILE_CHIP( okim6258, okim6258[chip].enabled() );
     if ( okim6258[chip].enabled() )
     {
-        int current_clock = okim6258[chip].get_clock();
+        int current_clock = okim6258[chip]->get_clock();
         if ( okim6258_hz[chip] != current_clock )
         {
             okim6258_hz[chip] = current_clock;
-            okim6258[chip].setup( (double)okim6258_hz[chip] / vgm_rate, 0.85, 1.0 );
+            okim6258[chip]->setup( (double)okim6258_hz[chip] / vgm_rate, 0.85, 1.0 );
         }
     }
 	return okim6258[chip].run_until( time );
@@ -215,26 +232,31 @@ int Vgm_Core::run_okim6258( int chip, int time )
 
 int Vgm_Core::run_okim6295( int chip, int time )
 {
+	GME_PROFILE_CHIP( okim6295, okim6295[!!chip].enabled() );
 	return okim6295[!!chip].run_until( time );
 }
 
 int Vgm_Core::run_k051649( int time )
 {
+	GME_PROFILE_CHIP( k051649, k051649.enabled() );
 	return k051649.run_until( time );
 }
 
 int Vgm_Core::run_k053260( int time )
 {
+	GME_PROFILE_CHIP( k053260, k053260.enabled() );
 	return k053260.run_until( time );
 }
 
 int Vgm_Core::run_k054539( int time )
 {
+	GME_PROFILE_CHIP( k054539, k054539.enabled() );
 	return k054539.run_until( time );
 }
 
 int Vgm_Core::run_qsound( int chip, int time )
 {
+    GME_PROFILE_CHIP( qsound, qsound[!!chip].enabled() );
     return qsound[!!chip].run_until( time );
 }
 
@@ -242,6 +264,7 @@ int Vgm_Core::run_qsound( int chip, int time )
 int Vgm_Core::run_dac_control( int time )
 {
 	if (dac_control_recursion) return 1;
+	GME_PROFILE_CHIP( dac_control, DacCtrlUsed != 0 );
 
 	++dac_control_recursion;
 	for ( unsigned i = 0; i < DacCtrlUsed; i++ )
@@ -265,6 +288,9 @@ Vgm_Core::Vgm_Core()
 	has_looped = false;
 	DacCtrlUsed = 0;
 	dac_control = NULL;
+	runner_count = 0;
+	bus_count = 0;
+	chips_separate_ = false;
 	memset( PCMBank, 0, sizeof( PCMBank ) );
 	memset( &PCMTbl, 0, sizeof( PCMTbl ) );
 	memset( DacCtrl, 0, sizeof( DacCtrl ) );
@@ -273,6 +299,7 @@ Vgm_Core::Vgm_Core()
 
 Vgm_Core::~Vgm_Core()
 {
+	free_buses();
 	for (unsigned i = 0; i < DacCtrlUsed; i++) device_stop_daccontrol( dac_control [i] );
 	if ( dac_control ) free( dac_control );
 	for (unsigned i = 0; i < PCM_BANK_COUNT; i++)
@@ -519,11 +546,11 @@ void Vgm_Core::AddPCMData(byte Type, unsigned DataSize, const byte* Data)
 	}
 
 	TempPCM = &PCMBank[Type & 0x3F];
-	CurBnk = TempPCM->BankCount;
-	TempPCM->BankCount ++;
 	TempPCM->BnkPos ++;
-	if (TempPCM->BnkPos < TempPCM->BankCount)
+	if (TempPCM->BnkPos <= TempPCM->BankCount)
 		return;	// Speed hack (for restarting playback)
+	CurBnk = TempPCM->BankCount;
+	TempPCM->BankCount ++;
 	TempPCM->Bank = (VGM_PCM_DATA*)realloc(TempPCM->Bank,
 		sizeof(VGM_PCM_DATA) * TempPCM->BankCount);
 
@@ -610,7 +637,7 @@ void Vgm_Core::chip_reg_write(unsigned Sample, byte ChipType, byte ChipID, byte
 					dac_disabled[ChipID] = (Data >> 7 & 1) - 1;
 					dac_amp[ChipID] |= dac_disabled[ChipID];
 				}
-				ym2612[ChipID].write0( Offset, Data );
+				ym2612[ChipID]->write0( Offset, Data );
 			}
 			break;
 		
@@ -635,7 +662,7 @@ void Vgm_Core::chip_reg_write(unsigned Sample, byte ChipType, byte ChipID, byte
 					}*/
 					this->blip_buf[ChipID] = blip_buf;
 				}
-				ym2612[ChipID].write1( Offset, Data );
+				ym2612[ChipID]->write1( Offset, Data );
 			}
 			break;
 		}
@@ -643,26 +670,29 @@ void Vgm_Core::chip_reg_write(unsigned Sample, byte ChipType, byte ChipID, byte
 
 	case 0x11:
 		if ( run_pwm( to_fm_time( Sample ) ) )
-			pwm.write( Port, ( ( Offset ) << 8 ) + Data );
+			pwm->write( Port, ( ( Offset ) << 8 ) + Data );
 		break;
 
 	case 0x00:
+	{
+		GME_PROFILE_CHIP( sn76489, true );
 		psg[ChipID].write_data( to_psg_time( Sample ), Data );
 		break;
+	}
 
 	case 0x01:
 		if ( run_ym2413( ChipID, to_fm_time( Sample ) ) )
-			ym2413[ChipID].write( Offset, Data );
+			ym2413[ChipID]->write( Offset, Data );
 		break;
 
 	case 0x03:
 		if ( run_ym2151( ChipID, to_fm_time( Sample ) ) )
-			ym2151[ChipID].write( Offset, Data );
+			ym2151[ChipID]->write( Offset, Data );
 		break;
 
 	case 0x06:
 		if ( run_ym2203( ChipID, to_fm_time( Sample ) ) )
-			ym2203[ChipID].write( Offset, Data );
+			ym2203[ChipID]->write( Offset, Data );
 		break;
 
 	case 0x07:
@@ -670,8 +700,8 @@ void Vgm_Core::chip_reg_write(unsigned Sample, byte ChipType, byte ChipID, byte
 		{
 			switch (Port)
 			{
-			case 0: ym2608[ChipID].write0( Offset, Data ); break;
-			case 1: ym2608[ChipID].write1( Offset, Data ); break;
+			case 0: ym2608[ChipID]->write0( Offset, Data ); break;
+			case 1: ym2608[ChipID]->write1( Offset, Data ); break;
 			}
 		}
 		break;
@@ -681,15 +711,15 @@ void Vgm_Core::chip_reg_write(unsigned Sample, byte ChipType, byte ChipID, byte
 		{
 			switch (Port)
 			{
-			case 0: ym2610[ChipID].write0( Offset, Data ); break;
-			case 1: ym2610[ChipID].write1( Offset, Data ); break;
+			case 0: ym2610[ChipID]->write0( Offset, Data ); break;
+			case 1: ym2610[ChipID]->write1( Offset, Data ); break;
 			}
 		}
 		break;
 
 	case 0x09:
 		if ( run_ym3812( ChipID, to_fm_time( Sample ) ) )
-			ym3812[ChipID].write( Offset, Data );
+			ym3812[ChipID]->write( Offset, Data );
 		break;
 
 	case 0x0C:
@@ -697,58 +727,67 @@ void Vgm_Core::chip_reg_write(unsigned Sample, byte ChipType, byte ChipID, byte
 		{
 			switch (Port)
 			{
-			case 0: ymf262[ChipID].write0( Offset, Data ); break;
-			case 1: ymf262[ChipID].write1( Offset, Data ); break;
+			case 0: ymf262[ChipID]->write0( Offset, Data ); break;
+			case 1: ymf262[ChipID]->write1( Offset, Data ); break;
 			}
 		}
 		break;
 
 	case 0x0F:
 		if ( run_ymz280b( to_fm_time( Sample ) ) )
-			ymz280b.write( Offset, Data );
+			ymz280b->write( Offset, Data );
 		break;
 
 	case 0x12:
+	{
+		GME_PROFILE_CHIP( ay8910, true );
 		ay[ChipID].write_addr( Offset );
 		ay[ChipID].write_data( to_ay_time( Sample ), Data );
 		break;
+	}
 
 	case 0x13:
+	{
+		GME_PROFILE_CHIP( gbdmg, true );
 		gbdmg[ChipID].write_register( to_gbdmg_time( Sample ), 0xFF10 + Offset, Data );
 		break;
+	}
 
 	case 0x17:
 		if ( run_okim6258( ChipID, to_fm_time( Sample ) ) )
-			okim6258[ChipID].write( Offset, Data );
+			okim6258[ChipID]->write( Offset, Data );
 		break;
 
 	case 0x18:
 		if ( run_okim6295( ChipID, to_fm_time( Sample ) ) )
-			okim6295[ChipID].write( Offset, Data );
+			okim6295[ChipID]->write( Offset, Data );
 		break;
 
 	case 0x19:
 		if ( run_k051649( to_fm_time( Sample ) ) )
-			k051649.write( Port, Offset, Data );
+			k051649->write( Port, Offset, Data );
 		break;
 
 	case 0x1A:
 		if ( run_k054539( to_fm_time( Sample ) ) )
-			k054539.write( ( Port << 8 ) | Offset, Data );
+			k054539->write( ( Port << 8 ) | Offset, Data );
 		break;
 
     case 0x1B:
+    {
+        GME_PROFILE_CHIP( huc6280, true );
         huc6280[ChipID].write_data( to_huc6280_time( Sample ), 0x800 + Offset, Data );
         break;
+    }
 
 	case 0x1D:
 		if ( run_k053260( to_fm_time( Sample ) ) )
-			k053260.write( Offset, Data );
+			k053260->write( Offset, Data );
 		break;
 
     case 0x1F:
         if ( run_qsound( ChipID, Sample ) )
-            qsound[ ChipID ].write( Data, ( Port << 8 ) + Offset );
+            qsound[ ChipID ]->write( Data, ( Port << 8 ) + Offset );
         break;
 	}
 }
@@ -868,11 +907,6 @@ blargg_err_t Vgm_Core::load_mem_( byte const data [], int size )
 
 	_header.cleanup();
 
-	// Get loop
-	loop_begin = file_end();
-	if ( get_le32( h.loop_offset ) )
-		loop_begin = &data [get_le32( h.loop_offset ) + offsetof (header_t,loop_offset)];
-	
 	// PSG rate
 	int psg_rate = get_le32( h.psg_rate ) & 0x3FFFFFFF;
 	if ( !psg_rate )
@@ -896,39 +930,56 @@ blargg_err_t Vgm_Core::load_mem_( byte const data [], int size )
 		gbdmg_rate = Gb_Apu::clock_rate;
 	stereo_buf[3].clock_rate( gbdmg_rate );
 
-	// Disable FM
+	// Free chips used by previous file. init_chips() allocates the ones this file uses.
 	fm_rate = 0;
-	ymz280b.enable( false );
-	ymf262[0].enable( false );
-	ymf262[1].enable( false );
-	ym3812[0].enable( false );
-	ym3812[1].enable( false );
-	ym2612[0].enable( false );
-	ym2612[1].enable( false );
-	ym2610[0].enable( false );
-	ym2610[1].enable( false );
-	ym2608[0].enable( false );
-	ym2608[1].enable( false );
-	ym2413[0].enable( false );
-	ym2413[1].enable( false );
-	ym2203[0].enable( false );
-	ym2203[1].enable( false );
-	ym2151[0].enable( false );
-	ym2151[1].enable( false );
-	c140.enable( false );
-	segapcm.enable( false );
-	rf5c68.enable( false );
-	rf5c164.enable( false );
-	pwm.enable( false );
-	okim6258[0].enable( false );
-    okim6258[1].enable( false );
-	okim6295[0].enable( false );
-	okim6295[1].enable( false );
-	k051649.enable( false );
-	k053260.enable( false );
-	k054539.enable( false );
-    qsound[0].enable( false );
-    qsound[1].enable( false );
+	free_buses();
+	runner_count = 0;
+	ymz280b.release();
+	ymf262[0].release();
+	ymf262[1].release();
+	ym3812[0].release();
+	ym3812[1].release();
+	ym2612[0].release();
+	ym2612[1].release();
+	ym2610[0].release();
+	ym2610[1].release();
+	ym2608[0].release();
+	ym2608[1].release();
+	ym2413[0].release();
+	ym2413[1].release();
+	ym2203[0].release();
+	ym2203[1].release();
+	ym2151[0].release();
+	ym2151[1].release();
+	c140.release();
+	segapcm.release();
+	rf5c68.release();
+	rf5c164.release();
+	pwm.release();
+	okim6258[0].release();
+    okim6258[1].release();
+	okim6295[0].release();
+	okim6295[1].release();
+	k051649.release();
+	k053260.release();
+	k054539.release();
+    qsound[0].release();
+    qsound[1].release();
+	
+	// Free PCM data of previous file
+	for ( int i = 0; i < PCM_BANK_COUNT; i++ )
+	{
+		free( PCMBank [i].Bank );
+		free( PCMBank [i].Data );
+	}
+	memset( PCMBank, 0, sizeof PCMBank );
+	free( PCMTbl.Entries );
+	memset( &PCMTbl, 0, sizeof PCMTbl );
+	
+	RETURN_ERR( decode_log() );
+	
+	// Decode all PCM data now, so that it doesn't move while playing
+	decode_pcm_blocks();
 	
 	set_tempo( 1 );
 	
@@ -993,6 +1044,8 @@ void Vgm_Core::update_fm_rates( int* ym2151_rate, int* ym2413_rate, int* ym2612_
 
 blargg_err_t Vgm_Core::init_chips( double* rate, bool reinit )
 {
+	free_buses();
+	
 	int ymz280b_rate = get_le32( header().ymz280b_rate ) & 0xBFFFFFFF;
 	int ymf262_rate = get_le32( header().ymf262_rate ) & 0xBFFFFFFF;
 	int ym3812_rate = get_le32( header().ym3812_rate ) & 0xBFFFFFFF;
@@ -1024,22 +1077,24 @@ blargg_err_t Vgm_Core::init_chips( double* rate, bool reinit )
 		double gain = dual_chip ? 0.5 : 1.0;
 		double fm_rate = ymf262_rate / 288.0;
 		int result;
+		RETURN_ERR( ymf262[0].alloc() );
 		if ( !reinit )
 		{
-			result = ymf262[0].set_rate( fm_rate, ymf262_rate );
+			result = ymf262[0]->set_rate( fm_rate, ymf262_rate );
 			CHECK_ALLOC( !result );
 		}
-		RETURN_ERR( ymf262[0].setup( fm_rate / vgm_rate, 0.85, gain ) );
-		ymf262[0].enable();
+		RETURN_ERR( ymf262[0]->setup( fm_rate / vgm_rate, 0.85, gain ) );
+		ymf262[0]->enable();
 		if ( dual_chip )
 		{
+			RETURN_ERR( ymf262[1].alloc() );
 			if ( !reinit )
 			{
-				result = ymf262[1].set_rate( fm_rate, ymf262_rate );
+				result = ymf262[1]->set_rate( fm_rate, ymf262_rate );
 				CHECK_ALLOC( !result );
 			}
-			RETURN_ERR( ymf262[1].setup( fm_rate / vgm_rate, 0.85, gain ) );
-			ymf262[1].enable();
+			RETURN_ERR( ymf262[1]->setup( fm_rate / vgm_rate, 0.85, gain ) );
+			ymf262[1]->enable();
 		}
 	}
 	if ( ym3812_rate )
@@ -1048,22 +1103,24 @@ blargg_err_t Vgm_Core::init_chips( double* rate, bool reinit )
 		double gain = dual_chip ? 0.5 : 1.0;
 		double fm_rate = ym3812_rate / 72.0;
 		int result;
+		RETURN_ERR( ym3812[0].alloc() );
 		if ( !reinit )
 		{
-			result = ym3812[0].set_rate( fm_rate, ym3812_rate );
+			result = ym3812[0]->set_rate( fm_rate, ym3812_rate );
 			CHECK_ALLOC( !result );
 		}
-		RETURN_ERR( ym3812[0].setup( fm_rate / vgm_rate, 0.85, gain ) );
-		ym3812[0].enable();
+		RETURN_ERR( ym3812[0]->setup( fm_rate / vgm_rate, 0.85, gain ) );
+		ym3812[0]->enable();
 		if ( dual_chip )
 		{
+			RETURN_ERR( ym3812[1].alloc() );
 			if ( !reinit )
 			{
-				result = ym3812[1].set_rate( fm_rate, ym3812_rate );
+				result = ym3812[1]->set_rate( fm_rate, ym3812_rate );
 				CHECK_ALLOC( !result );
 			}
-			RETURN_ERR( ym3812[1].setup( fm_rate / vgm_rate, 0.85, gain ) );
-			ym3812[1].enable();
+			RETURN_ERR( ym3812[1]->setup( fm_rate / vgm_rate, 0.85, gain ) );
+			ym3812[1]->enable();
 		}
 	}
 	if ( ym2612_rate )
@@ -1071,20 +1128,22 @@ blargg_err_t Vgm_Core::init_chips( double* rate, bool reinit )
 		bool dual_chip = !!(header().ym2612_rate[3] & 0x40);
 		double gain = dual_chip ? 0.5 : 1.0;
 		double fm_rate = ym2612_rate / 144.0;
+		RETURN_ERR( ym2612[0].alloc() );
 		if ( !reinit )
 		{
-			RETURN_ERR( ym2612[0].set_rate( fm_rate, ym2612_rate ) );
+			RETURN_ERR( ym2612[0]->set_rate( fm_rate, ym2612_rate ) );
 		}
-		RETURN_ERR( ym2612[0].setup( fm_rate / vgm_rate, 0.85, gain ) );
-		ym2612[0].enable();
+		RETURN_ERR( ym2612[0]->setup( fm_rate / vgm_rate, 0.85, gain ) );
+		ym2612[0]->enable();
 		if ( dual_chip )
 		{
+			RETURN_ERR( ym2612[1].alloc() );
 			if ( !reinit )
 			{
-				RETURN_ERR( ym2612[1].set_rate( fm_rate, ym2612_rate ) );
+				RETURN_ERR( ym2612[1]->set_rate( fm_rate, ym2612_rate ) );
 			}
-			RETURN_ERR( ym2612[1].setup( fm_rate / vgm_rate, 0.85, gain ) );
-			ym2612[1].enable();
+			RETURN_ERR( ym2612[1]->setup( fm_rate / vgm_rate, 0.85, gain ) );
+			ym2612[1]->enable();
 		}
 	}
 	if ( ym2610_rate )
@@ -1094,22 +1153,24 @@ blargg_err_t Vgm_Core::init_chips( double* rate, bool reinit )
 		double gain = dual_chip ? 0.5 : 1.0;
 		double fm_rate = ym2610_rate / 72.0;
 		int result;
+		RETURN_ERR( ym2610[0].alloc() );
 		if ( !reinit )
 		{
-			result = ym2610[0].set_rate( fm_rate, ym2610_rate, is_2610b );
+			result = ym2610[0]->set_rate( fm_rate, ym2610_rate, is_2610b );
 			CHECK_ALLOC( !result );
 		}
-		RETURN_ERR( ym2610[0].setup( fm_rate / vgm_rate, 0.85, gain ) );
-		ym2610[0].enable();
+		RETURN_ERR( ym2610[0]->setup( fm_rate / vgm_rate, 0.85, gain ) );
+		ym2610[0]->enable();
 		if ( dual_chip )
 		{
+			RETURN_ERR( ym2610[1].alloc() );
 			if ( !reinit )
 			{
-				result = ym2610[1].set_rate( fm_rate, ym2610_rate, is_2610b );
+				result = ym2610[1]->set_rate( fm_rate, ym2610_rate, is_2610b );
 				CHECK_ALLOC( !result );
 			}
-			RETURN_ERR( ym2610[1].setup( fm_rate / vgm_rate, 0.85, gain ) );
-			ym2610[1].enable();
+			RETURN_ERR( ym2610[1]->setup( fm_rate / vgm_rate, 0.85, gain ) );
+			ym2610[1]->enable();
 		}
 	}
 	if ( ym2608_rate )
@@ -1118,22 +1179,24 @@ blargg_err_t Vgm_Core::init_chips( double* rate, bool reinit )
 		double gain = dual_chip ? 1.0 : 2.0;
 		double fm_rate = ym2608_rate / 72.0;
 		int result;
+		RETURN_ERR( ym2608[0].alloc() );
 		if ( !reinit )
 		{
-			result = ym2608[0].set_rate( fm_rate, ym2608_rate );
+			result = ym2608[0]->set_rate( fm_rate, ym2608_rate );
 			CHECK_ALLOC( !result );
 		}
-		RETURN_ERR( ym2608[0].setup( fm_rate / vgm_rate, 0.85, gain ) );
-		ym2608[0].enable();
+		RETURN_ERR( ym2608[0]->setup( fm_rate / vgm_rate, 0.85, gain ) );
+		ym2608[0]->enable();
 		if ( dual_chip )
 		{
+			RETURN_ERR( ym2608[1].alloc() );
 			if ( !reinit )
 			{
-				result = ym2608[1].set_rate( fm_rate, ym2608_rate );
+				result = ym2608[1]->set_rate( fm_rate, ym2608_rate );
 				CHECK_ALLOC( !result );
 			}
-			RETURN_ERR( ym2608[1].setup( fm_rate / vgm_rate, 0.85, gain ) );
-			ym2608[1].enable();
+			RETURN_ERR( ym2608[1]->setup( fm_rate / vgm_rate, 0.85, gain ) );
+			ym2608[1]->enable();
 		}
 	}
 	if ( ym2413_rate )
@@ -1142,24 +1205,26 @@ blargg_err_t Vgm_Core::init_chips( double* rate, bool reinit )
 		double gain = dual_chip ? 0.5 : 1.0;
 		double fm_rate = ym2413_rate / 72.0;
 		int result;
+		RETURN_ERR( ym2413[0].alloc() );
 		if ( !reinit )
 		{
-			result = ym2413[0].set_rate( fm_rate, ym2413_rate );
+			result = ym2413[0]->set_rate( fm_rate, ym2413_rate );
 			if ( result == 2 )
 				return "YM2413 FM sound not supported";
 			CHECK_ALLOC( !result );
 		}
-		RETURN_ERR( ym2413[0].setup( fm_rate / vgm_rate, 0.85, gain ) );
-		ym2413[0].enable();
+		RETURN_ERR( ym2413[0]->setup( fm_rate / vgm_rate, 0.85, gain ) );
+		ym2413[0]->enable();
 		if ( dual_chip )
 		{
+			RETURN_ERR( ym2413[1].alloc() );
 			if ( !reinit )
 			{
-				result = ym2413[1].set_rate( fm_rate, ym2413_rate );
+				result = ym2413[1]->set_rate( fm_rate, ym2413_rate );
 				CHECK_ALLOC( !result );
 			}
-			RETURN_ERR( ym2413[1].setup( fm_rate / vgm_rate, 0.85, gain ) );
-			ym2413[1].enable();
+			RETURN_ERR( ym2413[1]->setup( fm_rate / vgm_rate, 0.85, gain ) );
+			ym2413[1]->enable();
 		}
 	}
 	if ( ym2151_rate )
@@ -1168,22 +1233,24 @@ blargg_err_t Vgm_Core::init_chips( double* rate, bool reinit )
 		double gain = dual_chip ? 0.5 : 1.0;
 		double fm_rate = ym2151_rate / 64.0;
 		int result;
+		RETURN_ERR( ym2151[0].alloc() );
 		if ( !reinit )
 		{
-			result = ym2151[0].set_rate( fm_rate, ym2151_rate );
+			result = ym2151[0]->set_rate( fm_rate, ym2151_rate );
 			CHECK_ALLOC( !result );
 		}
-		RETURN_ERR( ym2151[0].setup( fm_rate / vgm_rate, 0.85, gain ) );
-		ym2151[0].enable();
+		RETURN_ERR( ym2151[0]->setup( fm_rate / vgm_rate, 0.85, gain ) );
+		ym2151[0]->enable();
 		if ( dual_chip )
 		{
+			RETURN_ERR( ym2151[1].alloc() );
 			if ( !reinit )
 			{
-				result = ym2151[1].set_rate( fm_rate, ym2151_rate );
+				result = ym2151[1]->set_rate( fm_rate, ym2151_rate );
 				CHECK_ALLOC( !result );
 			}
-			RETURN_ERR( ym2151[1].setup( fm_rate / vgm_rate, 0.85, gain ) );
-			ym2151[1].enable();
+			RETURN_ERR( ym2151[1]->setup( fm_rate / vgm_rate, 0.85, gain ) );
+			ym2151[1]->enable();
 		}
 	}
 	if ( ym2203_rate )
@@ -1192,88 +1259,99 @@ blargg_err_t Vgm_Core::init_chips( double* rate, bool reinit )
 		double gain = dual_chip ? 0.5 : 1.0;
 		double fm_rate = ym2203_rate / 72.0;
 		int result;
+		RETURN_ERR( ym2203[0].alloc() );
 		if ( !reinit )
 		{
-			result = ym2203[0].set_rate( fm_rate, ym2203_rate );
+			result = ym2203[0]->set_rate( fm_rate, ym2203_rate );
 			CHECK_ALLOC ( !result );
 		}
-		RETURN_ERR( ym2203[0].setup( fm_rate / vgm_rate, 0.85, gain ) );
-		ym2203[0].enable();
+		RETURN_ERR( ym2203[0]->setup( fm_rate / vgm_rate, 0.85, gain ) );
+		ym2203[0]->enable();
 		if ( dual_chip )
 		{
+			RETURN_ERR( ym2203[1].alloc() );
 			if ( !reinit )
 			{
-				result = ym2203[1].set_rate( fm_rate, ym2203_rate );
+				result = ym2203[1]->set_rate( fm_rate, ym2203_rate );
 				CHECK_ALLOC ( !result );
 			}
-			RETURN_ERR( ym2203[1].setup( fm_rate / vgm_rate, 0.85, gain ) );
-			ym2203[1].enable();
+			RETURN_ERR( ym2203[1]->setup( fm_rate / vgm_rate, 0.85, gain ) );
+			ym2203[1]->enable();
 		}
 	}
 
 	if ( segapcm_rate )
 	{
 		double pcm_rate = segapcm_rate / 128.0;
+		RETURN_ERR( segapcm.alloc() );
 		if ( !reinit )
 		{
-			int result = segapcm.set_rate( get_le32( header().segapcm_reg ) );
+			int result = segapcm->set_rate( get_le32( header().segapcm_reg ) );
 			CHECK_ALLOC( !result );
 		}
-		RETURN_ERR( segapcm.setup( pcm_rate / vgm_rate, 0.85, 1.5 ) );
-		segapcm.enable();
+		RETURN_ERR( segapcm->setup( pcm_rate / vgm_rate, 0.85, 1.5 ) );
+		segapcm->enable();
 	}
 	if ( rf5c68_rate )
 	{
 		double pcm_rate = rf5c68_rate / 384.0;
+		RETURN_ERR( rf5c68.alloc() );
 		if ( !reinit )
 		{
-			int result = rf5c68.set_rate();
+			int result = rf5c68->set_rate();
 			CHECK_ALLOC( !result );
 		}
-		RETURN_ERR( rf5c68.setup( pcm_rate / vgm_rate, 0.85, 0.6875 ) );
-		rf5c68.enable();
+		RETURN_ERR( rf5c68->setup( pcm_rate / vgm_rate, 0.85, 0.6875 ) );
+		rf5c68->enable();
 	}
 	if ( rf5c164_rate )
 	{
 		double pcm_rate = rf5c164_rate / 384.0;
+		RETURN_ERR( rf5c164.alloc() );
 		if ( !reinit )
 		{
-			int result = rf5c164.set_rate( rf5c164_rate );
+			int result = rf5c164->set_rate( rf5c164_rate );
 			CHECK_ALLOC( !result );
 		}
-		RETURN_ERR( rf5c164.setup( pcm_rate / vgm_rate, 0.85, 0.5 ) );
-		rf5c164.enable();
+		RETURN_ERR( rf5c164->setup( pcm_rate / vgm_rate, 0.85, 0.5 ) );
+		rf5c164->enable();
 	}
 	if ( pwm_rate )
 	{
 		double pcm_rate = 22020.0;
+		RETURN_ERR( pwm.alloc() );
 		if ( !reinit )
 		{
-			int result = pwm.set_rate( pwm_rate );
+			int result = pwm->set_rate( pwm_rate );
 			CHECK_ALLOC( !result );
 		}
-		RETURN_ERR( pwm.setup( pcm_rate / vgm_rate, 0.85, 0.875 ) );
-		pwm.enable();
+		RETURN_ERR( pwm->setup( pcm_rate / vgm_rate, 0.85, 0.875 ) );
+		pwm->enable();
 	}
 	if ( okim6258_rate )
 	{
         bool dual_chip = !!( header().okim6258_rate[3] & 0x40 );
+		RETURN_ERR( okim6258[0].alloc() );
 		if ( !reinit )
 		{
-			okim6258_hz[0] = okim6258[0].set_rate( okim6258_rate, header().okim6258_flags & 0x03, ( header().okim6258_flags & 0x04 ) >> 2, ( header().okim6258_flags & 0x08 ) >> 3 );
+			okim6258_hz[0] = okim6258[0]->set_rate( okim6258_rate, header().okim6258_flags & 0x03, ( header().okim6258_flags & 0x04 ) >> 2, ( header().okim6258_flags & 0x08 ) >> 3 );
 			CHECK_ALLOC( okim6258_hz[0] );
 		}
-		RETURN_ERR( okim6258[0].setup( (double)okim6258_hz[0] / vgm_rate, 0.85, 1.0 ) );
-		okim6258[0].enable();
+		// clock can be changed by writes, which changes rate of its bus
+		okim6258[0]->input.own_bus = true;
+		RETURN_ERR( okim6258[0]->setup( (double)okim6258_hz[0] / vgm_rate, 0.85, 1.0 ) );
+		okim6258[0]->enable();
         if ( dual_chip )
         {
+            RETURN_ERR( okim6258[1].alloc() );
             if ( !reinit )
             {
-                okim6258_hz[1] = okim6258[1].set_rate( okim6258_rate, header().okim6258_flags & 0x03, ( header().okim6258_flags & 0x04 ) >> 2, ( header().okim6258_flags & 0x08 ) >> 3 );
+                okim6258_hz[1] = okim6258[1]->set_rate( okim6258_rate, header().okim6258_flags & 0x03, ( header().okim6258_flags & 0x04 ) >> 2, ( header().okim6258_flags & 0x08 ) >> 3 );
                 CHECK_ALLOC( okim6258_hz[1] );
             }
-            RETURN_ERR( okim6258[1].setup( (double)okim6258_hz[1] / vgm_rate, 0.85, 1.0 ) );
-            okim6258[1].enable();
+            okim6258[1]->input.own_bus = true;
+            RETURN_ERR( okim6258[1]->setup( (double)okim6258_hz[1] / vgm_rate, 0.85, 1.0 ) );
+            okim6258[1]->enable();
         }
 	}
 	if ( okim6295_rate )
@@ -1290,93 +1368,182 @@ blargg_err_t Vgm_Core::init_chips( double* rate, bool reinit )
 		bool dual_chip = !!( header().okim6295_rate[3] & 0x40 );
 		double gain = is_cp_system ? 0.4296875 : 1.0;
 		if ( dual_chip ) gain *= 0.5;
+		RETURN_ERR( okim6295[0].alloc() );
 		if ( !reinit )
 		{
-			okim6295_hz = okim6295[0].set_rate( okim6295_rate );
+			okim6295_hz = okim6295[0]->set_rate( okim6295_rate );
 			CHECK_ALLOC( okim6295_hz );
 		}
-		RETURN_ERR( okim6295[0].setup( (double)okim6295_hz / vgm_rate, 0.85, gain ) );
-		okim6295[0].enable();
+		RETURN_ERR( okim6295[0]->setup( (double)okim6295_hz / vgm_rate, 0.85, gain ) );
+		okim6295[0]->enable();
 		if ( dual_chip )
 		{
+			RETURN_ERR( okim6295[1].alloc() );
 			if ( !reinit )
 			{
-				int result = okim6295[1].set_rate( okim6295_rate );
+				int result = okim6295[1]->set_rate( okim6295_rate );
 				CHECK_ALLOC( result );
 			}
-			RETURN_ERR( okim6295[1].setup( (double)okim6295_hz / vgm_rate, 0.85, gain ) );
-			okim6295[1].enable();
+			RETURN_ERR( okim6295[1]->setup( (double)okim6295_hz / vgm_rate, 0.85, gain ) );
+			okim6295[1]->enable();
 		}
 	}
 	if ( c140_rate )
 	{
 		double pcm_rate = c140_rate;
+		RETURN_ERR( c140.alloc() );
 		if ( !reinit )
 		{
-			int result = c140.set_rate( header().c140_type, c140_rate, c140_rate );
+			int result = c140->set_rate( header().c140_type, c140_rate, c140_rate );
 			CHECK_ALLOC( !result );
 		}
-		RETURN_ERR( c140.setup( pcm_rate / vgm_rate, 0.85, 1.0 ) );
-		c140.enable();
+		RETURN_ERR( c140->setup( pcm_rate / vgm_rate, 0.85, 1.0 ) );
+		c140->enable();
 	}
 	if ( k051649_rate )
 	{
 		double pcm_rate = k051649_rate / 16.0;
+		RETURN_ERR( k051649.alloc() );
 		if ( !reinit )
 		{
-			int result = k051649.set_rate( k051649_rate );
+			int result = k051649->set_rate( k051649_rate );
 			CHECK_ALLOC( !result );
 		}
-		RETURN_ERR( k051649.setup( pcm_rate / vgm_rate, 0.85, 1.0 ) );
-		k051649.enable();
+		RETURN_ERR( k051649->setup( pcm_rate / vgm_rate, 0.85, 1.0 ) );
+		k051649->enable();
 	}
 	if ( k053260_rate )
 	{
 		double pcm_rate = k053260_rate / 32.0;
+		RETURN_ERR( k053260.alloc() );
 		if ( !reinit )
 		{
-			int result = k053260.set_rate( k053260_rate );
+			int result = k053260->set_rate( k053260_rate );
 			CHECK_ALLOC( !result );
 		}
-		RETURN_ERR( k053260.setup( pcm_rate / vgm_rate, 0.85, 1.0 ) );
-		k053260.enable();
+		RETURN_ERR( k053260->setup( pcm_rate / vgm_rate, 0.85, 1.0 ) );
+		k053260->enable();
 	}
 	if ( k054539_rate )
 	{
 		double pcm_rate = k054539_rate;
+		RETURN_ERR( k054539.alloc() );
 		if ( !reinit )
 		{
-			int result = k054539.set_rate( k054539_rate, header().k054539_flags );
+			int result = k054539->set_rate( k054539_rate, header().k054539_flags );
 			CHECK_ALLOC( !result );
 		}
-		RETURN_ERR( k054539.setup( pcm_rate / vgm_rate, 0.85, 1.0 ) );
-		k054539.enable();
+		RETURN_ERR( k054539->setup( pcm_rate / vgm_rate, 0.85, 1.0 ) );
+		k054539->enable();
 	}
 	if ( ymz280b_rate )
 	{
+		RETURN_ERR( ymz280b.alloc() );
 		if ( !reinit )
 		{
-			ymz280b_hz = ymz280b.set_rate( ymz280b_rate );
+			ymz280b_hz = ymz280b->set_rate( ymz280b_rate );
 			CHECK_ALLOC( ymz280b_hz );
 		}
-		RETURN_ERR( ymz280b.setup( (double)ymz280b_hz / vgm_rate, 0.85, 0.59375 ) );
-		ymz280b.enable();
+		RETURN_ERR( ymz280b->setup( (double)ymz280b_hz / vgm_rate, 0.85, 0.59375 ) );
+		ymz280b->enable();
 	}
     if ( qsound_rate )
     {
         /*double pcm_rate = (double)qsound_rate / 166.0;*/
+		RETURN_ERR( qsound[0].alloc() );
 		if ( !reinit )
 		{
-			int result = qsound[0].set_rate( qsound_rate );
+			int result = qsound[0]->set_rate( qsound_rate );
 			CHECK_ALLOC( result );
 		}
-		qsound[0].set_sample_rate( vgm_rate );
-        RETURN_ERR( qsound[0].setup( 1.0, 0.85, 1.0 ) );
-        qsound[0].enable();
+		qsound[0]->set_sample_rate( vgm_rate );
+        RETURN_ERR( qsound[0]->setup( 1.0, 0.85, 1.0 ) );
+        qsound[0]->enable();
     }
 
 	fm_rate = *rate;
 	
+	build_runners();
+	
+	return build_buses();
+}
+
+template<class Emu>
+void Vgm_Core::add_runner( Vgm_Chip<Emu>& c, run_func_t run, run_single_func_t run_single,
+		const char* name, int chip )
+{
+	if ( c.enabled() )
+	{
+		assert( runner_count < max_runners );
+		runner_t& r = runners [runner_count++];
+		r.input       = &c->input;
+		r.run         = run;
+		r.run_single  = run_single;
+		r.chip        = chip;
+		r.name        = name;
+	}
+}
+
+void Vgm_Core::build_runners()
+{
+	runner_count = 0;
+	for ( int i = 0; i < 2; i++ ) add_runner( ymf262 [i], &Vgm_Core::run_ymf262, NULL, i ? "YMF262 #2" : "YMF262", i );
+	for ( int i = 0; i < 2; i++ ) add_runner( ym3812 [i], &Vgm_Core::run_ym3812, NULL, i ? "YM3812 #2" : "YM3812", i );
+	for ( int i = 0; i < 2; i++ ) add_runner( ym2612 [i], &Vgm_Core::run_ym2612, NULL, i ? "YM2612 #2" : "YM2612", i );
+	for ( int i = 0; i < 2; i++ ) add_runner( ym2610 [i], &Vgm_Core::run_ym2610, NULL, i ? "YM2610 #2" : "YM2610", i );
+	for ( int i = 0; i < 2; i++ ) add_runner( ym2608 [i], &Vgm_Core::run_ym2608, NULL, i ? "YM2608 #2" : "YM2608", i );
+	for ( int i = 0; i < 2; i++ ) add_runner( ym2413 [i], &Vgm_Core::run_ym2413, NULL, i ? "YM2413 #2" : "YM2413", i );
+	for ( int i = 0; i < 2; i++ ) add_runner( ym2203 [i], &Vgm_Core::run_ym2203, NULL, i ? "YM2203 #2" : "YM2203", i );
+	for ( int i = 0; i < 2; i++ ) add_runner( ym2151 [i], &Vgm_Core::run_ym2151, NULL, i ? "YM2151 #2" : "YM2151", i );
+	add_runner( c140,    NULL, &Vgm_Core::run_c140,    "C140" );
+	add_runner( segapcm, NULL, &Vgm_Core::run_segapcm, "SegaPCM" );
+	add_runner( rf5c68,  NULL, &Vgm_Core::run_rf5c68,  "RF5C68" );
+	add_runner( rf5c164, NULL, &Vgm_Core::run_rf5c164, "RF5C164" );
+	add_runner( pwm,     NULL, &Vgm_Core::run_pwm,     "PWM" );
+	for ( int i = 0; i < 2; i++ ) add_runner( okim6258 [i], &Vgm_Core::run_okim6258, NULL, i ? "OKIM6258 #2" : "OKIM6258", i );
+	for ( int i = 0; i < 2; i++ ) add_runner( okim6295 [i], &Vgm_Core::run_okim6295, NULL, i ? "OKIM6295 #2" : "OKIM6295", i );
+	add_runner( k051649, NULL, &Vgm_Core::run_k051649, "K051649" );
+	add_runner( k053260, NULL, &Vgm_Core::run_k053260, "K053260" );
+	add_runner( k054539, NULL, &Vgm_Core::run_k054539, "K054539" );
+	add_runner( ymz280b, NULL, &Vgm_Core::run_ymz280b, "YMZ280B" );
+	for ( int i = 0; i < 2; i++ ) add_runner( qsound [i], &Vgm_Core::run_qsound, NULL, i ? "QSound #2" : "QSound", i );
+}
+
+void Vgm_Core::free_buses()
+{
+	for ( int i = 0; i < bus_count; i++ )
+		delete buses [i];
+	bus_count = 0;
+	
+	for ( int i = 0; i < runner_count; i++ )
+		runners [i].input->bus = NULL;
+}
+
+blargg_err_t Vgm_Core::build_buses()
+{
+	assert( !bus_count );
+	bool shared [max_buses];
+	for ( int i = 0; i < runner_count; i++ )
+	{
+		Chip_Bus_Input& in = *runners [i].input;
+		
+		Chip_Bus* bus = NULL;
+		for ( int b = 0; b < bus_count && !in.own_bus && !chips_separate_; b++ )
+		{
+			if ( shared [b] && buses [b]->rate() == in.rate )
+				bus = buses [b];
+		}
+		
+		if ( !bus )
+		{
+			assert( bus_count < max_buses );
+			CHECK_ALLOC( bus = BLARGG_NEW Chip_Bus );
+			shared [bus_count] = !in.own_bus;
+			buses [bus_count++] = bus;
+			RETURN_ERR( bus->set_rate( in.rate ) );
+		}
+		bus->add( in );
+	}
 	return blargg_ok;
 }
 
@@ -1396,110 +1563,109 @@ void Vgm_Core::start_track()
 
 	dac_disabled[0] = -1;
 	dac_disabled[1] = -1;
-	pos             = file_begin() + header().size();
+	pos             = 0;
 	dac_amp[0]      = -1;
 	dac_amp[1]      = -1;
 	vgm_time        = 0;
-	int data_offset = get_le32( header().data_offset );
-	check( data_offset );
-	if ( data_offset )
-		pos += data_offset + offsetof (header_t,data_offset) - header().size();
-	pcm_pos      = pos;
+	pcm_pos         = log_begin();
 	
 	if ( uses_fm() )
 	{
 		if ( rf5c68.enabled() )
-			rf5c68.reset();
+			rf5c68->reset();
 
 		if ( rf5c164.enabled() )
-			rf5c164.reset();
+			rf5c164->reset();
 
 		if ( segapcm.enabled() )
-			segapcm.reset();
+			segapcm->reset();
 
 		if ( pwm.enabled() )
-			pwm.reset();
+			pwm->reset();
 
 		if ( okim6258[0].enabled() )
-			okim6258[0].reset();
+			okim6258[0]->reset();
         
         if ( okim6258[1].enabled() )
-            okim6258[1].reset();
+            okim6258[1]->reset();
 
 		if ( okim6295[0].enabled() )
-			okim6295[0].reset();
+			okim6295[0]->reset();
 
 		if ( okim6295[1].enabled() )
-			okim6295[1].reset();
+			okim6295[1]->reset();
 
 		if ( k051649.enabled() )
-			k051649.reset();
+			k051649->reset();
 
 		if ( k053260.enabled() )
-			k053260.reset();
+			k053260->reset();
 
 		if ( k054539.enabled() )
-			k054539.reset();
+			k054539->reset();
 
 		if ( c140.enabled() )
-			c140.reset();
+			c140->reset();
 
 		if ( ym2151[0].enabled() )
-			ym2151[0].reset();
+			ym2151[0]->reset();
 
 		if ( ym2151[1].enabled() )
-			ym2151[1].reset();
+			ym2151[1]->reset();
 
 		if ( ym2203[0].enabled() )
-			ym2203[0].reset();
+			ym2203[0]->reset();
 
 		if ( ym2203[1].enabled() )
-			ym2203[1].reset();
+			ym2203[1]->reset();
 
 		if ( ym2413[0].enabled() )
-			ym2413[0].reset();
+			ym2413[0]->reset();
 
 		if ( ym2413[1].enabled() )
-			ym2413[1].reset();
+			ym2413[1]->reset();
 		
 		if ( ym2612[0].enabled() )
-			ym2612[0].reset();
+			ym2612[0]->reset();
 
 		if ( ym2612[1].enabled() )
-			ym2612[1].reset();
+			ym2612[1]->reset();
 
 		if ( ym2610[0].enabled() )
-			ym2610[0].reset();
+			ym2610[0]->reset();
 
 		if ( ym2610[1].enabled() )
-			ym2610[1].reset();
+			ym2610[1]->reset();
 
 		if ( ym2608[0].enabled() )
-			ym2608[0].reset();
+			ym2608[0]->reset();
 
 		if ( ym2608[1].enabled() )
-			ym2608[0].reset();
+			ym2608[0]->reset();
 
 		if ( ym3812[0].enabled() )
-			ym3812[0].reset();
+			ym3812[0]->reset();
 
 		if ( ym3812[1].enabled() )
-			ym3812[1].reset();
+			ym3812[1]->reset();
 
 		if ( ymf262[0].enabled() )
-			ymf262[0].reset();
+			ymf262[0]->reset();
 
 		if ( ymf262[1].enabled() )
-			ymf262[1].reset();
+			ymf262[1]->reset();
 
 		if ( ymz280b.enabled() )
-			ymz280b.reset();
+			ymz280b->reset();
 
         if ( qsound[0].enabled() )
-            qsound[0].reset();
+            qsound[0]->reset();
 
         if ( qsound[1].enabled() )
-            qsound[1].reset();
+            qsound[1]->reset();
+		
+		for ( int i = 0; i < bus_count; i++ )
+			buses [i]->clear();
 		
 		stereo_buf[0].clear();
 		stereo_buf[1].clear();
@@ -1530,6 +1696,162 @@ void Vgm_Core::start_track()
     dac_control_recursion = 0;
 }
 
+blargg_err_t Vgm_Core::copy_state( State_Copier& copier )
+{
+	copier.add_block( file_begin(), file_size() );
+	copier.add_block( &stereo_buf [0], sizeof stereo_buf [0] );
+	
+	// PCM data is all decoded when file is loaded, so it doesn't move
+	for ( int i = 0; i < PCM_BANK_COUNT; i++ )
+		if ( PCMBank [i].DataSize )
+			copier.add_block( PCMBank [i].Data, PCMBank [i].DataSize );
+	
+	copier.copy( vgm_time );
+	copier.copy( pos );
+	copier.copy( loop_begin );
+	copier.copy( has_looped );
+	copier.copy( dac_amp );
+	copier.copy( dac_disabled );
+	copier.copy_ptr( blip_buf [0] );
+	copier.copy_ptr( blip_buf [1] );
+	copier.copy( fm_time_offset );
+	copier.copy( ay_time_offset );
+	copier.copy( huc6280_time_offset );
+	copier.copy( gbdmg_time_offset );
+	
+	for ( int i = 0; i < PCM_BANK_COUNT; i++ )
+	{
+		copier.copy( PCMBank [i].BnkPos );
+		copier.copy( PCMBank [i].DataPos );
+		if ( PCMBank [i].BnkPos > PCMBank [i].BankCount )
+			copier.set_error( blargg_err_file_corrupt );
+	}
+	copier.copy_ptr( pcm_pos );
+	
+	// DAC stream control, with devices added or removed to match
+	byte dac_used = DacCtrlUsed;
+	copier.copy( dac_used );
+	if ( copier.loading() && !copier.error() && dac_used > DacCtrlUsed )
+	{
+		void** p = (void**) realloc( dac_control, dac_used * sizeof *dac_control );
+		if ( !p )
+			return blargg_err_memory;
+		dac_control = p;
+		while ( DacCtrlUsed < dac_used )
+		{
+			void* dev = device_start_daccontrol( vgm_rate, this );
+			if ( !dev )
+				return blargg_err_memory;
+			dac_control [DacCtrlUsed++] = dev;
+		}
+	}
+	while ( DacCtrlUsed > dac_used )
+		device_stop_daccontrol( dac_control [--DacCtrlUsed] );
+	copier.copy( DacCtrlUsg );
+	copier.copy( DacCtrl );
+	copier.copy( DacCtrlMap );
+	copier.copy( DacCtrlTime );
+	for ( unsigned i = 0; i < DacCtrlUsed; i++ )
+	{
+		int ptrs [DACCONTROL_STATE_PTRS];
+		int ptr_count = daccontrol_state_ptrs( dac_control [i], ptrs );
+		int kept [DACCONTROL_STATE_KEPT];
+		int kept_count = daccontrol_state_kept( dac_control [i], kept );
+		copier.copy_with_ptrs( dac_control [i], daccontrol_state_size(),
+				ptrs, ptr_count, kept, kept_count );
+	}
+	
+	// OKIM6258 rate can change while playing. Its bus is set up again before
+	// being loaded, since that clears it.
+	for ( int i = 0; i < 2; i++ )
+	{
+		int hz = okim6258_hz [i];
+		copier.copy( hz );
+		if ( hz != okim6258_hz [i] && okim6258 [i].enabled() && !copier.error() )
+		{
+			okim6258_hz [i] = hz;
+			RETURN_ERR( okim6258 [i]->setup( (double) hz / vgm_rate, 0.85, 1.0 ) );
+		}
+	}
+	
+	for ( int i = 0; i < bus_count; i++ )
+		buses [i]->copy_state( copier );
+	
+	// ROM isn't saved; blocks played so far are written again from file
+	if ( copier.loading() && !copier.error() )
+		rewrite_rom_blocks();
+	
+	for ( int i = 0; i < 2; i++ )
+	{
+		psg     [i].copy_state( copier );
+		ay      [i].copy_state( copier );
+		huc6280 [i].copy_state( copier );
+		gbdmg   [i].copy_state( copier );
+		
+		if ( ym2612 [i].enabled() )
+			ym2612 [i]->copy_state( copier );
+		
+		if ( ym2413 [i].enabled() )
+			ym2413 [i]->copy_state( copier );
+		
+		if ( ym2151 [i].enabled() )
+			ym2151 [i]->copy_state( copier );
+		
+		if ( ym2203 [i].enabled() )
+			ym2203 [i]->copy_state( copier );
+		
+		if ( ym2608 [i].enabled() )
+			ym2608 [i]->copy_state( copier );
+		
+		if ( ym2610 [i].enabled() )
+			ym2610 [i]->copy_state( copier );
+		
+		if ( ym3812 [i].enabled() )
+			ym3812 [i]->copy_state( copier );
+		
+		if ( ymf262 [i].enabled() )
+			ymf262 [i]->copy_state( copier );
+		
+		if ( okim6258 [i].enabled() )
+			okim6258 [i]->copy_state( copier );
+		
+		if ( okim6295 [i].enabled() )
+			okim6295 [i]->copy_state( copier );
+		
+		if ( qsound [i].enabled() )
+			qsound [i]->copy_state( copier );
+	}
+	
+	if ( segapcm.enabled() )
+		segapcm->copy_state( copier );
+	
+	if ( rf5c68.enabled() )
+		rf5c68->copy_state( copier );
+	
+	if ( rf5c164.enabled() )
+		rf5c164->copy_state( copier );
+	
+	if ( pwm.enabled() )
+		pwm->copy_state( copier );
+	
+	if ( c140.enabled() )
+		c140->copy_state( copier );
+	
+	if ( k051649.enabled() )
+		k051649->copy_state( copier );
+	
+	if ( k053260.enabled() )
+		k053260->copy_state( copier );
+	
+	if ( k054539.enabled() )
+		k054539->copy_state( copier );
+	
+	if ( ymz280b.enabled() )
+		ymz280b->copy_state( copier );
+	
+	return copier.error();
+}
+
 inline Vgm_Core::fm_time_t Vgm_Core::to_fm_time( vgm_time_t t ) const
 {
 	return (t * fm_time_factor + fm_time_offset) >> fm_time_bits;
@@ -1573,528 +1895,699 @@ void Vgm_Core::write_pcm( vgm_time_t vgm_time, int chip, int amp )
 	}
 }
 
-blip_time_t Vgm_Core::run( vgm_time_t end_time )
+// Kinds of events in decoded log
+enum {
+	event_delay,        // only waits
+	event_write,        // chip_reg_write()
+	event_psg,          // SN76489 write
+	event_gg_stereo,    // Game Gear stereo write
+	event_pcm_delay,    // YM2612 DAC write of next byte of PCM data, then wait
+	event_end,          // end of log, loops if loop point was given
+	event_command       // other command, handled by run_command()
+};
+
+// Chip_reg_write() parameters for simple register write commands
+struct vgm_write_cmd_t
 {
-	vgm_time_t vgm_time = this->vgm_time; 
-	vgm_time_t vgm_loop_time = ~0;
-	int ChipID;
-	byte const* pos = this->pos;
-	if ( pos > file_end() )
-		set_warning( "Stream lacked end event" );
+	byte cmd;
+	byte chip_type;
+	byte chip_id;
+	byte port;
+};
+
+static vgm_write_cmd_t const vgm_write_cmds [] = {
+	{ cmd_ym2413,           0x01, 0, 0 },
+	{ cmd_ym2413_2,         0x01, 1, 0 },
+	{ cmd_ym2612_port0,     0x02, 0, 0 },
+	{ cmd_ym2612_2_port0,   0x02, 1, 0 },
+	{ cmd_ym2612_port1,     0x02, 0, 1 },
+	{ cmd_ym2612_2_port1,   0x02, 1, 1 },
+	{ cmd_ym2151,           0x03, 0, 0 },
+	{ cmd_ym2151_2,         0x03, 1, 0 },
+	{ cmd_ym2203,           0x06, 0, 0 },
+	{ cmd_ym2203_2,         0x06, 1, 0 },
+	{ cmd_ym2608_port0,     0x07, 0, 0 },
+	{ cmd_ym2608_2_port0,   0x07, 1, 0 },
+	{ cmd_ym2608_port1,     0x07, 0, 1 },
+	{ cmd_ym2608_2_port1,   0x07, 1, 1 },
+	{ cmd_ym2610_port0,     0x08, 0, 0 },
+	{ cmd_ym2610_2_port0,   0x08, 1, 0 },
+	{ cmd_ym2610_port1,     0x08, 0, 1 },
+	{ cmd_ym2610_2_port1,   0x08, 1, 1 },
+	{ cmd_ym3812,           0x09, 0, 0 },
+	{ cmd_ym3812_2,         0x09, 1, 0 },
+	{ cmd_ymf262_port0,     0x0C, 0, 0 },
+	{ cmd_ymf262_2_port0,   0x0C, 1, 0 },
+	{ cmd_ymf262_port1,     0x0C, 0, 1 },
+	{ cmd_ymf262_2_port1,   0x0C, 1, 1 },
+	{ cmd_ymz280b,          0x0F, 0, 0 },
+	{ 0, 0, 0, 0 }
+};
+
+// Chips selected by bit 7 of register number
+struct vgm_dual_write_cmd_t
+{
+	byte cmd;
+	byte chip_type;
+};
+
+static vgm_dual_write_cmd_t const vgm_dual_write_cmds [] = {
+	{ cmd_ay8910,           0x12 },
+	{ cmd_gbdmg_write,      0x13 },
+	{ cmd_okim6258_write,   0x17 },
+	{ cmd_okim6295_write,   0x18 },
+	{ cmd_huc6280_write,    0x1B },
+	{ 0, 0 }
+};
+
+inline byte const* Vgm_Core::log_begin() const
+{
+	byte const* begin = file_begin() + header().size();
+	int data_offset = get_le32( header().data_offset );
+	check( data_offset );
+	if ( data_offset )
+		begin += data_offset + offsetof (header_t,data_offset) - header().size();
+	return begin;
+}
+
+// Decodes log into out, or just counts events if out is NULL. Returns number
+// of events.
+int Vgm_Core::decode_log( byte const* const begin, event_t* out )
+{
+	byte const* const end = file_end();
+	byte const* loop = NULL;
+	if ( get_le32( header().loop_offset ) )
+		loop = file_begin() + get_le32( header().loop_offset ) + offsetof (header_t,loop_offset);
+	
+	if ( out )
+		loop_begin = -1;
 	
-	while ( vgm_time < end_time && pos < file_end() )
+	int count = 0;
+	bool new_event = true; // true if next delay can't be added to previous event
+	byte const* pos = begin;
+	while ( pos < end )
 	{
-		// TODO: be sure there are enough bytes left in stream for particular command
-		// so we don't read past end
-		switch ( *pos++ )
+		if ( pos == loop )
+		{
+			if ( out )
+				loop_begin = count;
+			new_event = true;
+		}
+		
+		int cmd = *pos++;
+		int len = 0;        // operand bytes
+		int delay = -1;     // non-negative for delay commands
+		bool dual = false;  // chip is selected by bit 7 of first operand
+		bool ignore = false;
+		event_t e;
+		e.kind      = event_command;
+		e.delay     = 0;
+		e.offset    = pos - file_begin();
+		e.chip_type = 0;
+		e.chip_id   = 0;
+		e.port      = 0;
+		e.reg       = 0;
+		e.data      = 0;
+		
+		switch ( cmd )
 		{
 		case cmd_end:
-			if ( vgm_loop_time == ~0 ) vgm_loop_time = vgm_time;
-			else if ( vgm_loop_time == vgm_time ) loop_begin = file_end(); // XXX some files may loop forever on a region without any delay commands
-			pos = loop_begin; // if not looped, loop_begin == file_end()
-			if ( pos != file_end() ) has_looped = true;
+			e.kind = event_end;
 			break;
 		
 		case cmd_delay_735:
-			vgm_time += 735;
+			delay = 735;
 			break;
 		
 		case cmd_delay_882:
-			vgm_time += 882;
+			delay = 882;
 			break;
 		
-		case cmd_gg_stereo:
-			psg[0].write_ggstereo( to_psg_time( vgm_time ), *pos++ );
+		case cmd_delay:
+			len = 2;
 			break;
-
+		
+		case cmd_byte_delay:
+			len = 1;
+			break;
+		
+		case cmd_gg_stereo:
 		case cmd_gg_stereo_2:
-			psg[1].write_ggstereo( to_psg_time( vgm_time ), *pos++ );
+			len = 1;
+			e.kind = event_gg_stereo;
+			e.chip_id = (cmd == cmd_gg_stereo_2);
 			break;
 		
 		case cmd_psg:
-			psg[0].write_data( to_psg_time( vgm_time ), *pos++ );
-			break;
-
 		case cmd_psg_2:
-			psg[1].write_data( to_psg_time( vgm_time ), *pos++ );
+			len = 1;
+			e.kind = event_psg;
+			e.chip_id = (cmd == cmd_psg_2);
 			break;
-
-		case cmd_ay8910:
-			ChipID = !!(pos [0] & 0x80);
-			chip_reg_write( vgm_time, 0x12, ChipID, 0x00, pos [0] & 0x7F, pos [1] );
-			pos += 2;
+		
+		case cmd_pwm:
+			len = 2;
+			e.kind = event_write;
+			e.chip_type = 0x11;
 			break;
 		
-		case cmd_delay:
-			vgm_time += pos [1] * 0x100 + pos [0];
-			pos += 2;
+		case cmd_k053260_write:
+			len = 2;
+			e.kind = event_write;
+			e.chip_type = 0x1D;
 			break;
 		
-		case cmd_byte_delay:
-			vgm_time += *pos++;
+		case cmd_k051649_write:
+		case cmd_k054539_write:
+		case cmd_qsound_write:
+			len = 3;
+			e.kind = event_write;
+			e.chip_type = (cmd == cmd_k051649_write ? 0x19 : cmd == cmd_k054539_write ? 0x1A : 0x1F);
 			break;
-
-		case cmd_segapcm_write:
-			if ( get_le32( header().segapcm_rate ) > 0 )
-				if ( run_segapcm( to_fm_time( vgm_time ) ) )
-					segapcm.write( get_le16( pos ), pos [2] );
-			pos += 3;
+		
+		case cmd_dacctl_stop:
+			len = 1;
 			break;
-
+		
 		case cmd_rf5c68:
-			if ( run_rf5c68( to_fm_time( vgm_time ) ) )
-				rf5c68.write( pos [0], pos [1] );
-			pos += 2;
-			break;
-
-		case cmd_rf5c68_mem:
-			if ( run_rf5c68( to_fm_time( vgm_time ) ) )
-				rf5c68.write_mem( get_le16( pos ), pos [2] );
-			pos += 3;
-			break;
-
 		case cmd_rf5c164:
-			if ( run_rf5c164( to_fm_time( vgm_time ) ) )
-				rf5c164.write( pos [0], pos [1] );
-			pos += 2;
+			len = 2;
 			break;
-
+		
+		case cmd_segapcm_write:
+		case cmd_rf5c68_mem:
 		case cmd_rf5c164_mem:
-			if ( run_rf5c164( to_fm_time( vgm_time ) ) )
-				rf5c164.write_mem( get_le16( pos ), pos [2] );
-			pos += 3;
-			break;
-
-		case cmd_pwm:
-			chip_reg_write( vgm_time, 0x11, 0x00, pos [0] >> 4, pos [0] & 0x0F, pos [1] );
-			pos += 2;
-			break;
-
 		case cmd_c140:
-			if ( get_le32( header().c140_rate ) > 0 )
-				if ( run_c140( to_fm_time( vgm_time ) ) )
-					c140.write( get_be16( pos ), pos [2] );
-			pos += 3;
-			break;
-
-		case cmd_ym2151:
-			chip_reg_write( vgm_time, 0x03, 0x00, 0x00, pos [0], pos [1] );
-			pos += 2;
-			break;
-
-		case cmd_ym2151_2:
-			chip_reg_write( vgm_time, 0x03, 0x01, 0x00, pos [0], pos [1] );
-			pos += 2;
-			break;
-
-		case cmd_ym2203:
-			chip_reg_write( vgm_time, 0x06, 0x00, 0x00, pos [0], pos [1] );
-			pos += 2;
-			break;
-
-		case cmd_ym2203_2:
-			chip_reg_write( vgm_time, 0x06, 0x01, 0x00, pos [0], pos [1] );
-			pos += 2;
+			len = 3;
 			break;
 		
-		case cmd_ym2413:
-			chip_reg_write( vgm_time, 0x01, 0x00, 0x00, pos [0], pos [1] );
-			pos += 2;
-			break;
-
-		case cmd_ym2413_2:
-			chip_reg_write( vgm_time, 0x01, 0x01, 0x00, pos [0], pos [1] );
-			pos += 2;
-			break;
-
-		case cmd_ym3812:
-			chip_reg_write( vgm_time, 0x09, 0x00, 0x00, pos [0], pos [1] );
-			pos += 2;
-			break;
-
-		case cmd_ym3812_2:
-			chip_reg_write( vgm_time, 0x09, 0x01, 0x00, pos [0], pos [1] );
-			pos += 2;
-			break;
-
-		case cmd_ymf262_port0:
-			chip_reg_write( vgm_time, 0x0C, 0x00, 0x00, pos [0], pos [1] );
-			pos += 2;
-			break;
-
-		case cmd_ymf262_2_port0:
-			chip_reg_write( vgm_time, 0x0C, 0x01, 0x00, pos [0], pos [1] );
-			pos += 2;
-			break;
-
-		case cmd_ymf262_port1:
-			chip_reg_write( vgm_time, 0x0C, 0x00, 0x01, pos [0], pos [1] );
-			pos += 2;
-			break;
-
-		case cmd_ymf262_2_port1:
-			chip_reg_write( vgm_time, 0x0C, 0x01, 0x01, pos [0], pos [1] );
-			pos += 2;
-			break;
-
-		case cmd_ymz280b:
-			chip_reg_write( vgm_time, 0x0F, 0x00, 0x00, pos [0], pos [1] );
-			pos += 2;
+		case cmd_dacctl_setup:
+		case cmd_dacctl_data:
+		case cmd_dacctl_playblock:
+		case cmd_pcm_seek:
+			len = 4;
 			break;
 		
-		case cmd_ym2612_port0:
-			chip_reg_write( vgm_time, 0x02, 0x00, 0x00, pos [0], pos [1] );
-			pos += 2;
-			break;
-
-		case cmd_ym2612_2_port0:
-			chip_reg_write( vgm_time, 0x02, 0x01, 0x00, pos [0], pos [1] );
-			pos += 2;
+		case cmd_dacctl_freq:
+			len = 5;
 			break;
 		
-		case cmd_ym2612_port1:
-			chip_reg_write( vgm_time, 0x02, 0x00, 0x01, pos [0], pos [1] );
-			pos += 2;
-			break;
-
-		case cmd_ym2612_2_port1:
-			chip_reg_write( vgm_time, 0x02, 0x01, 0x01, pos [0], pos [1] );
-			pos += 2;
-			break;
-
-		case cmd_ym2610_port0:
-			chip_reg_write( vgm_time, 0x08, 0x00, 0x00, pos [0], pos [1] );
-			pos += 2;
-			break;
-
-		case cmd_ym2610_2_port0:
-			chip_reg_write( vgm_time, 0x08, 0x01, 0x00, pos [0], pos [1] );
-			pos += 2;
-			break;
-
-		case cmd_ym2610_port1:
-			chip_reg_write( vgm_time, 0x08, 0x00, 0x01, pos [0], pos [1] );
-			pos += 2;
-			break;
-
-		case cmd_ym2610_2_port1:
-			chip_reg_write( vgm_time, 0x08, 0x01, 0x01, pos [0], pos [1] );
-			pos += 2;
-			break;
-
-		case cmd_ym2608_port0:
-			chip_reg_write( vgm_time, 0x07, 0x00, 0x00, pos [0], pos [1] );
-			pos += 2;
-			break;
-
-		case cmd_ym2608_2_port0:
-			chip_reg_write( vgm_time, 0x07, 0x01, 0x00, pos [0], pos [1] );
-			pos += 2;
-			break;
-
-		case cmd_ym2608_port1:
-			chip_reg_write( vgm_time, 0x07, 0x00, 0x01, pos [0], pos [1] );
-			pos += 2;
-			break;
-
-		case cmd_ym2608_2_port1:
-			chip_reg_write( vgm_time, 0x07, 0x01, 0x01, pos [0], pos [1] );
-			pos += 2;
-			break;
-
-		case cmd_okim6258_write:
-			chip_reg_write( vgm_time, 0x17, ChipID, 0x00, pos [0] & 0x7F, pos [1] );
-			pos += 2;
-			break;
-
-		case cmd_okim6295_write:
-			ChipID = (pos [0] & 0x80) ? 1 : 0;
-			chip_reg_write( vgm_time, 0x18, ChipID, 0x00, pos [0] & 0x7F, pos [1] );
-			pos += 2;
-			break;
-
-        case cmd_huc6280_write:
-            ChipID = (pos [0] & 0x80) ? 1 : 0;
-            chip_reg_write( vgm_time, 0x1B, ChipID, 0x00, pos [0] & 0x7F, pos [1] );
-            pos += 2;
-            break;
-
-		case cmd_gbdmg_write:
-			ChipID = (pos [0] & 0x80) ? 1 : 0;
-			chip_reg_write( vgm_time, 0x13, ChipID, 0x00, pos [0] & 0x7F, pos [1] );
-			pos += 2;
-			break;
-
-		case cmd_k051649_write:
-			chip_reg_write( vgm_time, 0x19, 0x00, pos [0] & 0x7F, pos [1], pos [2] );
-			pos += 3;
+		case cmd_dacctl_play:
+			len = 10;
 			break;
-
-		case cmd_k053260_write:
-			chip_reg_write( vgm_time, 0x1D, 0x00, 0x00, pos [0] & 0x7F, pos [1] );
-			pos += 2;
+		
+		case cmd_data_block:
+			len = 6;
+			if ( end - pos >= len )
+				len += get_le32( pos + 2 ) & 0x7FFFFFFF;
 			break;
-
-		case cmd_k054539_write:
-			chip_reg_write( vgm_time, 0x1A, 0x00, pos [0] & 0x7F, pos [1], pos [2] );
-			pos += 3;
+		
+		case cmd_ram_block:
+			len = 11;
 			break;
-
-        case cmd_qsound_write:
-            chip_reg_write( vgm_time, 0x1F, 0x00, pos [0], pos [1], pos [2] );
-            pos += 3;
-            break;
-			
-		case cmd_dacctl_setup:
-			if ( run_dac_control( vgm_time ) )
+		
+		default:
+			for ( vgm_write_cmd_t const* w = vgm_write_cmds; w->cmd; w++ )
 			{
-				unsigned chip = pos [0];
-				if ( chip < 0xFF )
+				if ( w->cmd == cmd )
 				{
-					if ( ! DacCtrl [chip].Enable )
-					{
-						dac_control_grow( chip );
-						DacCtrl [chip].Enable = true;
-					}
-					daccontrol_setup_chip( dac_control [DacCtrlMap [chip]], pos [1] & 0x7F, ( pos [1] & 0x80 ) >> 7, get_be16( pos + 2 ) );
+					len = 2;
+					e.kind      = event_write;
+					e.chip_type = w->chip_type;
+					e.chip_id   = w->chip_id;
+					e.port      = w->port;
 				}
 			}
-			pos += 4;
-			break;
-
-		case cmd_dacctl_data:
-			if ( run_dac_control( vgm_time ) )
+			for ( vgm_dual_write_cmd_t const* w = vgm_dual_write_cmds; w->cmd; w++ )
 			{
-				unsigned chip = pos [0];
-				if ( chip < 0xFF && DacCtrl [chip].Enable )
+				if ( w->cmd == cmd )
 				{
-					DacCtrl [chip].Bank = pos [1];
-					if ( DacCtrl [chip].Bank >= 0x40 )
-						DacCtrl [chip].Bank = 0x00;
-
-					VGM_PCM_BANK * TempPCM = &PCMBank [DacCtrl [chip].Bank];
-					daccontrol_set_data( dac_control [DacCtrlMap [chip]], TempPCM->Data, TempPCM->DataSize, pos [2], pos [3] );
+					len = 2;
+					dual = true;
+					e.kind      = event_write;
+					e.chip_type = w->chip_type;
 				}
 			}
-			pos += 4;
-			break;
-		case cmd_dacctl_freq:
-			if ( run_dac_control( vgm_time ) )
-			{
-				unsigned chip = pos [0];
-				if ( chip < 0xFF && DacCtrl [chip].Enable )
-				{
-					daccontrol_set_frequency( dac_control [DacCtrlMap [chip]], get_le32( pos + 1 ) );
-				}
+			if ( len )
+				break;
+			
+			switch ( cmd & 0xF0 )
+			{
+				case cmd_pcm_delay:
+					e.kind = event_pcm_delay;
+					e.delay = cmd & 0x0F;
+					break;
+				
+				case cmd_short_delay:
+					delay = (cmd & 0x0F) + 1;
+					break;
+				
+				case 0x50:
+					len = 2;
+					ignore = true;
+					break;
+				
+				default:
+					len = command_len( cmd ) - 1;
+					ignore = true;
+					set_warning( "Unknown stream event" );
 			}
-			pos += 5;
+		}
+		
+		if ( end - pos < len )
+		{
+			set_warning( "Stream lacked end event" );
 			break;
-		case cmd_dacctl_play:
-			if ( run_dac_control( vgm_time ) )
+		}
+		
+		if ( cmd == cmd_delay )
+			delay = get_le16( pos );
+		else if ( cmd == cmd_byte_delay )
+			delay = pos [0];
+		
+		if ( e.kind == event_write )
+		{
+			// Same chip_reg_write() parameters as command's operands give
+			if ( len == 3 )
 			{
-				unsigned chip = pos [0];
-				if ( chip < 0xFF && DacCtrl [chip].Enable && PCMBank [DacCtrl [chip].Bank].BankCount )
-				{
-					daccontrol_start( dac_control [DacCtrlMap [chip]], get_le32( pos + 1 ), pos [5], get_le32( pos + 6 ) );
-				}
+				e.port = pos [0];
+				e.reg  = pos [1];
+				e.data = pos [2];
+				if ( cmd != cmd_qsound_write )
+					e.port &= 0x7F;
 			}
-			pos += 10;
-			break;
-		case cmd_dacctl_stop:
-			if ( run_dac_control( vgm_time ) )
+			else
 			{
-				unsigned chip = pos [0];
-				if ( chip < 0xFF && DacCtrl [chip].Enable )
+				e.reg  = pos [0];
+				e.data = pos [1];
+				if ( cmd == cmd_pwm )
 				{
-					daccontrol_stop( dac_control [DacCtrlMap [chip]] );
+					e.port = pos [0] >> 4;
+					e.reg  = pos [0] & 0x0F;
 				}
-				else if ( chip == 0xFF )
+				else if ( dual || cmd == cmd_k053260_write )
 				{
-					for ( unsigned i = 0; i < DacCtrlUsed; i++ )
-					{
-						daccontrol_stop( dac_control [i] );
-					}
+					e.chip_id = dual && (pos [0] & 0x80);
+					e.reg     = pos [0] & 0x7F;
 				}
 			}
-			pos++;
-			break;
-		case cmd_dacctl_playblock:
-			if ( run_dac_control( vgm_time ) )
+		}
+		else if ( e.kind != event_command && len )
+		{
+			e.data = pos [0];
+		}
+		pos += len;
+		
+		if ( e.kind == event_end )
+			pos = end;
+		
+		if ( ignore )
+			continue;
+		
+		if ( delay >= 0 )
+		{
+			// Add to previous event, unless loop point is between them
+			if ( new_event )
 			{
-				unsigned chip = pos [0];
-				if ( chip < 0xFF && DacCtrl [chip].Enable && PCMBank [DacCtrl [chip].Bank].BankCount )
+				e.kind = event_delay;
+				if ( out )
+					out [count] = e;
+				count++;
+				new_event = false;
+			}
+			if ( out )
+				out [count - 1].delay += delay;
+			continue;
+		}
+		
+		if ( out )
+			out [count] = e;
+		count++;
+		new_event = false;
+	}
+	
+	if ( out && loop_begin < 0 )
+		loop_begin = count;
+	
+	return count;
+}
+
+blargg_err_t Vgm_Core::decode_log()
+{
+	byte const* begin = log_begin();
+	int count = 0;
+	if ( begin < file_end() )
+		count = decode_log( begin, NULL );
+	RETURN_ERR( events.resize( count ) );
+	loop_begin = count;
+	if ( count )
+		decode_log( begin, events.begin() );
+	return blargg_ok;
+}
+
+void Vgm_Core::decode_pcm_blocks()
+{
+	bool looped = has_looped;
+	has_looped = false;
+	for ( int i = 0; i < PCM_BANK_COUNT; i++ )
+		PCMBank [i].BnkPos = 0;
+	
+	// AddPCMData() skips blocks already decoded
+	int const event_count = events.size();
+	for ( int i = 0; i < event_count; i++ )
+	{
+		event_t const& e = events [i];
+		byte const* pos = file_begin() + e.offset;
+		if ( e.kind == event_command && pos [-1] == cmd_data_block && !(pos [1] & 0x80) )
+			AddPCMData( pos [1], get_le32( pos + 2 ) & 0x7FFFFFFF, pos + 6 );
+	}
+	
+	has_looped = looped;
+}
+
+void Vgm_Core::write_rom_block( int type, int chipid, int size, byte const* pos )
+{
+	if ( size < 8 )
+		return;
+	
+	int rom_size = get_le32( pos );
+	int data_start = get_le32( pos + 4 );
+	int data_size = size - 8;
+	void * rom_data = ( void * ) ( pos + 8 );
+
+	switch ( type )
+	{
+	case rom_segapcm:
+		if ( segapcm.enabled() )
+			segapcm->write_rom( rom_size, data_start, data_size, rom_data );
+		break;
+
+	case rom_ym2608_deltat:
+		if ( ym2608[chipid].enabled() )
+		{
+			ym2608[chipid]->write_rom( 0x02, rom_size, data_start, data_size, rom_data );
+		}
+		break;
+
+	case rom_ym2610_adpcm:
+	case rom_ym2610_deltat:
+		if ( ym2610[chipid].enabled() )
+		{
+			int rom_id = 0x01 + ( type - rom_ym2610_adpcm );
+			ym2610[chipid]->write_rom( rom_id, rom_size, data_start, data_size, rom_data );
+		}
+		break;
+
+	case rom_ymz280b:
+		if ( ymz280b.enabled() )
+			ymz280b->write_rom( rom_size, data_start, data_size, rom_data );
+		break;
+
+	case rom_okim6295:
+		if ( okim6295[chipid].enabled() )
+			okim6295[chipid]->write_rom( rom_size, data_start, data_size, rom_data );
+		break;
+
+	case rom_k054539:
+		if ( k054539.enabled() )
+			k054539->write_rom( rom_size, data_start, data_size, rom_data );
+		break;
+
+	case rom_c140:
+		if ( c140.enabled() )
+			c140->write_rom( rom_size, data_start, data_size, rom_data );
+		break;
+
+	case rom_k053260:
+		if ( k053260.enabled() )
+			k053260->write_rom( rom_size, data_start, data_size, rom_data );
+		break;
+
+	case rom_qsound:
+		if ( qsound[chipid].enabled() )
+			qsound[chipid]->write_rom( rom_size, data_start, data_size, rom_data );
+		break;
+	}
+}
+
+void Vgm_Core::rewrite_rom_blocks()
+{
+	for ( int i = 0; i < pos; i++ )
+	{
+		event_t const& e = events [i];
+		byte const* p = file_begin() + e.offset;
+		if ( e.kind == event_command && p [-1] == cmd_data_block && (p [1] & 0xC0) == rom_block_type )
+		{
+			unsigned size = get_le32( p + 2 );
+			write_rom_block( p [1], size >> 31, size & 0x7FFFFFFF, p + 6 );
+		}
+	}
+}
+
+void Vgm_Core::run_command( byte const* pos, vgm_time_t vgm_time )
+{
+	switch ( pos [-1] )
+	{
+	case cmd_segapcm_write:
+		if ( get_le32( header().segapcm_rate ) > 0 )
+			if ( run_segapcm( to_fm_time( vgm_time ) ) )
+				segapcm->write( get_le16( pos ), pos [2] );
+		break;
+
+	case cmd_rf5c68:
+		if ( run_rf5c68( to_fm_time( vgm_time ) ) )
+			rf5c68->write( pos [0], pos [1] );
+		break;
+
+	case cmd_rf5c68_mem:
+		if ( run_rf5c68( to_fm_time( vgm_time ) ) )
+			rf5c68->write_mem( get_le16( pos ), pos [2] );
+		break;
+
+	case cmd_rf5c164:
+		if ( run_rf5c164( to_fm_time( vgm_time ) ) )
+			rf5c164->write( pos [0], pos [1] );
+		break;
+
+	case cmd_rf5c164_mem:
+		if ( run_rf5c164( to_fm_time( vgm_time ) ) )
+			rf5c164->write_mem( get_le16( pos ), pos [2] );
+		break;
+
+	case cmd_c140:
+		if ( get_le32( header().c140_rate ) > 0 )
+			if ( run_c140( to_fm_time( vgm_time ) ) )
+				c140->write( get_be16( pos ), pos [2] );
+		break;
+
+	case cmd_dacctl_setup:
+		if ( run_dac_control( vgm_time ) )
+		{
+			unsigned chip = pos [0];
+			if ( chip < 0xFF )
+			{
+				if ( ! DacCtrl [chip].Enable )
 				{
-					VGM_PCM_BANK * TempPCM = &PCMBank [DacCtrl [chip].Bank];
-					unsigned block_number = get_le16( pos + 1 );
-					if ( block_number >= TempPCM->BankCount )
-						block_number = 0;
-					VGM_PCM_DATA * TempBnk = &TempPCM->Bank [block_number];
-					unsigned flags = DCTRL_LMODE_BYTES | ((pos [4] & 1) << 7);
-					daccontrol_start( dac_control [DacCtrlMap [chip]], TempBnk->DataStart, flags, TempBnk->DataSize );
+					dac_control_grow( chip );
+					DacCtrl [chip].Enable = true;
 				}
+				daccontrol_setup_chip( dac_control [DacCtrlMap [chip]], pos [1] & 0x7F, ( pos [1] & 0x80 ) >> 7, get_be16( pos + 2 ) );
 			}
-			pos += 4;
-			break;
+		}
+		break;
 
-		case cmd_data_block: {
-			check( *pos == cmd_end );
-			int type = pos [1];
-			int size = get_le32( pos + 2 );
-			int chipid = 0;
-			if ( size & 0x80000000 )
+	case cmd_dacctl_data:
+		if ( run_dac_control( vgm_time ) )
+		{
+			unsigned chip = pos [0];
+			if ( chip < 0xFF && DacCtrl [chip].Enable )
 			{
-				size &= 0x7FFFFFFF;
-				chipid = 1;
+				DacCtrl [chip].Bank = pos [1];
+				if ( DacCtrl [chip].Bank >= 0x40 )
+					DacCtrl [chip].Bank = 0x00;
+
+				VGM_PCM_BANK * TempPCM = &PCMBank [DacCtrl [chip].Bank];
+				daccontrol_set_data( dac_control [DacCtrlMap [chip]], TempPCM->Data, TempPCM->DataSize, pos [2], pos [3] );
 			}
-			pos += 6;
-			switch ( type & 0xC0 )
+		}
+		break;
+	case cmd_dacctl_freq:
+		if ( run_dac_control( vgm_time ) )
+		{
+			unsigned chip = pos [0];
+			if ( chip < 0xFF && DacCtrl [chip].Enable )
 			{
-			case pcm_block_type:
-			case pcm_aux_block_type:
-				AddPCMData( type, size, pos );
-				break;
-
-			case rom_block_type:
-				if ( size >= 8 )
+				daccontrol_set_frequency( dac_control [DacCtrlMap [chip]], get_le32( pos + 1 ) );
+			}
+		}
+		break;
+	case cmd_dacctl_play:
+		if ( run_dac_control( vgm_time ) )
+		{
+			unsigned chip = pos [0];
+			if ( chip < 0xFF && DacCtrl [chip].Enable && PCMBank [DacCtrl [chip].Bank].BankCount )
+			{
+				daccontrol_start( dac_control [DacCtrlMap [chip]], get_le32( pos + 1 ), pos [5], get_le32( pos + 6 ) );
+			}
+		}
+		break;
+	case cmd_dacctl_stop:
+		if ( run_dac_control( vgm_time ) )
+		{
+			unsigned chip = pos [0];
+			if ( chip < 0xFF && DacCtrl [chip].Enable )
+			{
+				daccontrol_stop( dac_control [DacCtrlMap [chip]] );
+			}
+			else if ( chip == 0xFF )
+			{
+				for ( unsigned i = 0; i < DacCtrlUsed; i++ )
 				{
-					int rom_size = get_le32( pos );
-					int data_start = get_le32( pos + 4 );
-					int data_size = size - 8;
-					void * rom_data = ( void * ) ( pos + 8 );
-
-					switch ( type )
-					{
-					case rom_segapcm:
-						if ( segapcm.enabled() )
-							segapcm.write_rom( rom_size, data_start, data_size, rom_data );
-						break;
-
-					case rom_ym2608_deltat:
-						if ( ym2608[chipid].enabled() )
-						{
-							ym2608[chipid].write_rom( 0x02, rom_size, data_start, data_size, rom_data );
-						}
-						break;
-
-					case rom_ym2610_adpcm:
-					case rom_ym2610_deltat:
-						if ( ym2610[chipid].enabled() )
-						{
-							int rom_id = 0x01 + ( type - rom_ym2610_adpcm );
-							ym2610[chipid].write_rom( rom_id, rom_size, data_start, data_size, rom_data );
-						}
-						break;
-
-					case rom_ymz280b:
-						if ( ymz280b.enabled() )
-							ymz280b.write_rom( rom_size, data_start, data_size, rom_data );
-						break;
-
-					case rom_okim6295:
-						if ( okim6295[chipid].enabled() )
-							okim6295[chipid].write_rom( rom_size, data_start, data_size, rom_data );
-						break;
-
-					case rom_k054539:
-						if ( k054539.enabled() )
-							k054539.write_rom( rom_size, data_start, data_size, rom_data );
-						break;
-
-					case rom_c140:
-						if ( c140.enabled() )
-							c140.write_rom( rom_size, data_start, data_size, rom_data );
-						break;
-
-					case rom_k053260:
-						if ( k053260.enabled() )
-							k053260.write_rom( rom_size, data_start, data_size, rom_data );
-						break;
-
-                    case rom_qsound:
-                        if ( qsound[chipid].enabled() )
-                            qsound[chipid].write_rom( rom_size, data_start, data_size, rom_data );
-                        break;
-					}
+					daccontrol_stop( dac_control [i] );
 				}
-				break;
+			}
+		}
+		break;
+	case cmd_dacctl_playblock:
+		if ( run_dac_control( vgm_time ) )
+		{
+			unsigned chip = pos [0];
+			if ( chip < 0xFF && DacCtrl [chip].Enable && PCMBank [DacCtrl [chip].Bank].BankCount )
+			{
+				VGM_PCM_BANK * TempPCM = &PCMBank [DacCtrl [chip].Bank];
+				unsigned block_number = get_le16( pos + 1 );
+				if ( block_number >= TempPCM->BankCount )
+					block_number = 0;
+				VGM_PCM_DATA * TempBnk = &TempPCM->Bank [block_number];
+				unsigned flags = DCTRL_LMODE_BYTES | ((pos [4] & 1) << 7);
+				daccontrol_start( dac_control [DacCtrlMap [chip]], TempBnk->DataStart, flags, TempBnk->DataSize );
+			}
+		}
+		break;
+
+	case cmd_data_block: {
+		check( *pos == cmd_end );
+		int type = pos [1];
+		int size = get_le32( pos + 2 );
+		int chipid = 0;
+		if ( size & 0x80000000 )
+		{
+			size &= 0x7FFFFFFF;
+			chipid = 1;
+		}
+		pos += 6;
+		switch ( type & 0xC0 )
+		{
+		case pcm_block_type:
+		case pcm_aux_block_type:
+			AddPCMData( type, size, pos );
+			break;
+
+		case rom_block_type:
+			write_rom_block( type, chipid, size, pos );
+			break;
 
-			case ram_block_type:
-				if ( size >= 2 )
+		case ram_block_type:
+			if ( size >= 2 )
+			{
+				int data_start = get_le16( pos );
+				int data_size = size - 2;
+				void * ram_data = ( void * ) ( pos + 2 );
+
+				switch ( type )
 				{
-					int data_start = get_le16( pos );
-					int data_size = size - 2;
-					void * ram_data = ( void * ) ( pos + 2 );
+				case ram_rf5c68:
+					if ( rf5c68.enabled() )
+						rf5c68->write_ram( data_start, data_size, ram_data );
+					break;
 
-					switch ( type )
-					{
-					case ram_rf5c68:
-						if ( rf5c68.enabled() )
-							rf5c68.write_ram( data_start, data_size, ram_data );
-						break;
-
-					case ram_rf5c164:
-						if ( rf5c164.enabled() )
-							rf5c164.write_ram( data_start, data_size, ram_data );
-						break;
-					}
+				case ram_rf5c164:
+					if ( rf5c164.enabled() )
+						rf5c164->write_ram( data_start, data_size, ram_data );
+					break;
 				}
-				break;
 			}
-			pos += size;
 			break;
 		}
+		break;
+	}
 
-		case cmd_ram_block: {
-			check( *pos == cmd_end );
-			int type = pos[ 1 ];
-			int data_start = get_le24( pos + 2 );
-			int data_addr = get_le24( pos + 5 );
-			int data_size = get_le24( pos + 8 );
-			if ( !data_size ) data_size += 0x01000000;
-			void * data_ptr = (void *) GetPointerFromPCMBank( type, data_start );
-			switch ( type )
-			{
-			case rf5c68_ram_block:
-				if ( rf5c68.enabled() )
-					rf5c68.write_ram( data_addr, data_size, data_ptr );
-				break;
+	case cmd_ram_block: {
+		check( *pos == cmd_end );
+		int type = pos[ 1 ];
+		int data_start = get_le24( pos + 2 );
+		int data_addr = get_le24( pos + 5 );
+		int data_size = get_le24( pos + 8 );
+		if ( !data_size ) data_size += 0x01000000;
+		void * data_ptr = (void *) GetPointerFromPCMBank( type, data_start );
+		switch ( type )
+		{
+		case rf5c68_ram_block:
+			if ( rf5c68.enabled() )
+				rf5c68->write_ram( data_addr, data_size, data_ptr );
+			break;
 
-			case rf5c164_ram_block:
-				if ( rf5c164.enabled() )
-					rf5c164.write_ram( data_addr, data_size, data_ptr );
-				break;
-			}
-			pos += 11;
+		case rf5c164_ram_block:
+			if ( rf5c164.enabled() )
+				rf5c164->write_ram( data_addr, data_size, data_ptr );
 			break;
 		}
+		break;
+	}
+	
+	case cmd_pcm_seek:
+		pcm_pos = GetPointerFromPCMBank( 0, get_le32( pos ) );
+		break;
+	
+	}
+}
+
+blip_time_t Vgm_Core::run( vgm_time_t end_time )
+{
+	vgm_time_t vgm_time = this->vgm_time; 
+	vgm_time_t vgm_loop_time = ~0;
+	int const event_count = events.size();
+	int pos = this->pos;
+	
+	while ( vgm_time < end_time && pos < event_count )
+	{
+		event_t const& e = events [pos++];
+		switch ( e.kind )
+		{
+		case event_write:
+			chip_reg_write( vgm_time, e.chip_type, e.chip_id, e.port, e.reg, e.data );
+			break;
 		
-		case cmd_pcm_seek:
-			pcm_pos = GetPointerFromPCMBank( 0, get_le32( pos ) );
-			pos += 4;
+		case event_psg:
+		{
+			GME_PROFILE_CHIP( sn76489, true );
+			psg[e.chip_id].write_data( to_psg_time( vgm_time ), e.data );
 			break;
+		}
 		
-		default:
-			int cmd = pos [-1];
-			switch ( cmd & 0xF0 )
-			{
-				case cmd_pcm_delay:
-					chip_reg_write( vgm_time, 0x02, 0x00, 0x00, ym2612_dac_port, *pcm_pos++ );
-					vgm_time += cmd & 0x0F;
-					break;
-				
-				case cmd_short_delay:
-					vgm_time += (cmd & 0x0F) + 1;
-					break;
-				
-				case 0x50:
-					pos += 2;
-					break;
-				
-				default:
-					pos += command_len( cmd ) - 1;
-					set_warning( "Unknown stream event" );
-			}
+		case event_gg_stereo:
+		{
+			GME_PROFILE_CHIP( sn76489, true );
+			psg[e.chip_id].write_ggstereo( to_psg_time( vgm_time ), e.data );
+			break;
+		}
+		
+		case event_pcm_delay:
+			chip_reg_write( vgm_time, 0x02, 0x00, 0x00, ym2612_dac_port, *pcm_pos++ );
+			break;
+		
+		case event_end:
+			if ( vgm_loop_time == ~0 ) vgm_loop_time = vgm_time;
+			else if ( vgm_loop_time == vgm_time ) loop_begin = event_count; // XXX some files may loop forever on a region without any delay commands
+			pos = loop_begin; // if not looped, loop_begin == event_count
+			if ( pos != event_count ) has_looped = true;
+			break;
+		
+		case event_command:
+			run_command( file_begin() + e.offset, vgm_time );
+			break;
 		}
+		vgm_time += e.delay;
 	}
 	vgm_time -= end_time;
 	this->pos = pos;
@@ -2106,12 +2599,14 @@ blip_time_t Vgm_Core::run( vgm_time_t end_time )
 blip_time_t Vgm_Core::run_psg( int msec )
 {
 	blip_time_t t = run( msec * vgm_rate / 1000 );
+	GME_PROFILE_CHIP( sn76489, true );
 	psg[0].end_frame( t );
 	psg[1].end_frame( t );
 	return t;
 }
 
-int Vgm_Core::play_frame( blip_time_t blip_time, int sample_count, blip_sample_t out [] )
+int Vgm_Core::play_frame( blip_time_t blip_time, int sample_count, blip_sample_t out [],
+		blip_sample_t* const chip_out [] )
 {
 	// to do: timing is working mostly by luck
 	int min_pairs = (unsigned) sample_count / 2;
@@ -2124,179 +2619,84 @@ int Vgm_Core::play_frame( blip_time_t blip_time, int sample_count, blip_sample_t
 	
     memset( out, 0, pairs * stereo * sizeof *out );
 
-	if ( ymf262[0].enabled() )
+	if ( chip_out )
 	{
-		ymf262[0].begin_frame( out );
-		if ( ymf262[1].enabled() )
+		assert( chips_separate_ && bus_count == runner_count );
+		for ( int i = 0; i < bus_count; i++ )
 		{
-			ymf262[1].begin_frame( out );
+			memset( chip_out [i], 0, pairs * stereo * sizeof *out );
+			buses [i]->begin_frame( chip_out [i] );
 		}
 	}
-	if ( ym3812[0].enabled() )
-	{
-		ym3812[0].begin_frame( out );
-		if ( ym3812[1].enabled() )
-		{
-			ym3812[1].begin_frame( out );
-		}
-	}
-	if ( ym2612[0].enabled() )
-	{
-		ym2612[0].begin_frame( out );
-		if ( ym2612[1].enabled() )
-		{
-			ym2612[1].begin_frame( out );
-		}
-	}
-	if ( ym2610[0].enabled() )
-	{
-		ym2610[0].begin_frame( out );
-		if ( ym2610[1].enabled() )
-		{
-			ym2610[1].begin_frame( out );
-		}
-	}
-	if ( ym2608[0].enabled() )
-	{
-		ym2608[0].begin_frame( out );
-		if ( ym2608[1].enabled() )
-		{
-			ym2608[1].begin_frame( out );
-		}
-	}
-	if ( ym2413[0].enabled() )
-	{
-		ym2413[0].begin_frame( out );
-		if ( ym2413[1].enabled() )
-		{
-			ym2413[1].begin_frame( out );
-		}
-	}
-	if ( ym2203[0].enabled() )
-	{
-		ym2203[0].begin_frame( out );
-		if ( ym2203[1].enabled() )
-		{
-			ym2203[1].begin_frame( out );
-		}
-	}
-	if ( ym2151[0].enabled() )
+	else
 	{
-		ym2151[0].begin_frame( out );
-		if ( ym2151[1].enabled() )
-		{
-			ym2151[1].begin_frame( out );
-		}
+		for ( int i = 0; i < bus_count; i++ )
+			buses [i]->begin_frame( out );
 	}
 
-	if ( c140.enabled() )
-	{
-		c140.begin_frame( out );
-	}
-	if ( segapcm.enabled() )
-	{
-		segapcm.begin_frame( out );
-	}
-	if ( rf5c68.enabled() )
-	{
-		rf5c68.begin_frame( out );
-	}
-	if ( rf5c164.enabled() )
-	{
-		rf5c164.begin_frame( out );
-	}
-	if ( pwm.enabled() )
-	{
-		pwm.begin_frame( out );
-	}
-	if ( okim6258[0].enabled() )
+	run( vgm_time );
+
+	if ( DacCtrlUsed )
+		run_dac_control( vgm_time );
+
+	for ( int i = 0; i < runner_count; i++ )
 	{
-		okim6258[0].begin_frame( out );
-        if ( okim6258[1].enabled() )
-        {
-            okim6258[1].begin_frame( out );
-        }
+		runner_t const& r = runners [i];
+		if ( r.run )
+			(this->*r.run)( r.chip, pairs );
+		else
+			(this->*r.run_single)( pairs );
 	}
-	if ( okim6295[0].enabled() )
+	
+	if ( chip_out )
 	{
-		okim6295[0].begin_frame( out );
-		if ( okim6295[1].enabled() )
+		// mix is sum of chips, as if they'd shared a bus
+		for ( int i = 0; i < bus_count; i++ )
 		{
-			okim6295[1].begin_frame( out );
+			blip_sample_t const* in = chip_out [i];
+			for ( int n = 0; n < pairs * stereo; n++ )
+			{
+				int s = out [n] + in [n];
+				BLIP_CLAMP( s, s );
+				out [n] = (blip_sample_t) s;
+			}
 		}
 	}
-	if ( k051649.enabled() )
-	{
-		k051649.begin_frame( out );
-	}
-	if ( k053260.enabled() )
-	{
-		k053260.begin_frame( out );
-	}
-	if ( k054539.enabled() )
-	{
-		k054539.begin_frame( out );
-	}
-	if ( ymz280b.enabled() )
-	{
-		ymz280b.begin_frame( out );
-	}
-    if ( qsound[0].enabled() )
-    {
-        qsound[0].begin_frame( out );
-        if ( qsound[1].enabled() )
-        {
-            qsound[1].begin_frame( out );
-        }
-    }
-
-	run( vgm_time );
-
-	run_dac_control( vgm_time );
-
-	run_ymf262( 0, pairs ); run_ymf262( 1, pairs );
-	run_ym3812( 0, pairs ); run_ym3812( 1, pairs );
-	run_ym2612( 0, pairs ); run_ym2612( 1, pairs );
-	run_ym2610( 0, pairs ); run_ym2610( 1, pairs );
-	run_ym2608( 0, pairs ); run_ym2608( 1, pairs );
-	run_ym2413( 0, pairs ); run_ym2413( 1, pairs );
-	run_ym2203( 0, pairs ); run_ym2203( 1, pairs );
-	run_ym2151( 0, pairs ); run_ym2151( 1, pairs );
-	run_c140( pairs );
-	run_segapcm( pairs );
-	run_rf5c68( pairs );
-	run_rf5c164( pairs );
-	run_pwm( pairs );
-	run_okim6258( 0, pairs ); run_okim6258( 1, pairs );
-	run_okim6295( 0, pairs ); run_okim6295( 1, pairs );
-	run_k051649( pairs );
-	run_k053260( pairs );
-	run_k054539( pairs );
-	run_ymz280b( pairs );
-    run_qsound( 0, pairs ); run_qsound( 1, pairs );
 	
 	fm_time_offset = (vgm_time * fm_time_factor + fm_time_offset) - (pairs << fm_time_bits);
 	
-	psg[0].end_frame( blip_time );
-	psg[1].end_frame( blip_time );
+	{
+		GME_PROFILE_CHIP( sn76489, get_le32( header().psg_rate ) != 0 );
+		psg[0].end_frame( blip_time );
+		psg[1].end_frame( blip_time );
+	}
 
 	ay_time_offset = (vgm_time * blip_ay_time_factor + ay_time_offset) - (pairs << blip_time_bits);
 
 	blip_time_t ay_end_time = to_ay_time( vgm_time );
-	ay[0].end_frame( ay_end_time );
-	ay[1].end_frame( ay_end_time );
+	{
+		GME_PROFILE_CHIP( ay8910, get_le32( header().ay8910_rate ) != 0 );
+		ay[0].end_frame( ay_end_time );
+		ay[1].end_frame( ay_end_time );
+	}
 
     huc6280_time_offset = (vgm_time * blip_huc6280_time_factor + huc6280_time_offset) - (pairs << blip_time_bits);
 
     blip_time_t huc6280_end_time = to_huc6280_time( vgm_time );
-    huc6280[0].end_frame( huc6280_end_time );
-    huc6280[1].end_frame( huc6280_end_time );
+    {
+        GME_PROFILE_CHIP( huc6280, get_le32( header().huc6280_rate ) != 0 );
+        huc6280[0].end_frame( huc6280_end_time );
+        huc6280[1].end_frame( huc6280_end_time );
+    }
 
 	gbdmg_time_offset = (vgm_time * blip_gbdmg_time_factor + gbdmg_time_offset) - (pairs << blip_time_bits);
 
 	blip_time_t gbdmg_end_time = to_gbdmg_time( vgm_time );
-	gbdmg[0].end_frame( gbdmg_end_time );
-	gbdmg[1].end_frame( gbdmg_end_time );
+	{
+		GME_PROFILE_CHIP( gbdmg, get_le32( header().gbdmg_rate ) != 0 );
+		gbdmg[0].end_frame( gbdmg_end_time );
+		gbdmg[1].end_frame( gbdmg_end_time );
+	}
 
 	memset( DacCtrlTime, 0, sizeof(DacCtrlTime) );
 	
@@ -59,6 +59,43 @@
 		}
 	};
 
+	// Chip_Resampler_Emu that is only allocated when a file uses the chip, so
+	// that unused chips cost only a pointer
+	template<class Emu>
+	class Vgm_Chip {
+	public:
+		typedef Chip_Resampler_Emu<Emu> emu_t;
+		
+		Vgm_Chip()                      { emu = NULL; }
+		~Vgm_Chip()                     { delete emu; }
+		
+		// Allocates emulator if not already allocated
+		blargg_err_t alloc()
+		{
+			if ( !emu )
+				CHECK_ALLOC( emu = BLARGG_NEW emu_t );
+			return blargg_ok;
+		}
+		
+		// Frees emulator
+		void release()                  { delete emu; emu = NULL; }
+		
+		bool enabled() const            { return emu && emu->enabled(); }
+		
+		// Same as emulator's run_until(), but returns false if not allocated
+		int run_until( int time )       { return emu && emu->run_until( time ); }
+		
+		// Emulator. Must be allocated.
+		emu_t* operator -> () const     { assert( emu ); return emu; }
+	
+	private:
+		emu_t* emu;
+		
+		// noncopyable
+		Vgm_Chip( const Vgm_Chip& );
+		Vgm_Chip& operator = ( const Vgm_Chip& );
+	};
+
 class Vgm_Core : public Gme_Loader {
 public:
 
@@ -150,10 +187,7 @@ public:
 	
 	// True if any FM chips are used by file. Always false until init_fm()
 	// is called.
-	bool uses_fm() const                { return ym2612[0].enabled() || ym2413[0].enabled() || ym2151[0].enabled() || c140.enabled() ||
-		segapcm.enabled() || rf5c68.enabled() || rf5c164.enabled() || pwm.enabled() || okim6258[0].enabled() || okim6295[0].enabled() ||
-		k051649.enabled() || k053260.enabled() || k054539.enabled() || ym2203[0].enabled() || ym3812[0].enabled() || ymf262[0].enabled() ||
-        ymz280b.enabled() || ym2610[0].enabled() || ym2608[0].enabled() || qsound[0].enabled() ||
+	bool uses_fm() const                { return runner_count ||
         (header().ay8910_rate[0] | header().ay8910_rate[1] | header().ay8910_rate[2] | header().ay8910_rate[3]) ||
         (header().huc6280_rate[0] | header().huc6280_rate[1] | header().huc6280_rate[2] | header().huc6280_rate[3]) ||
 		(header().gbdmg_rate[0] | header().gbdmg_rate[1] | header().gbdmg_rate[2] | header().gbdmg_rate[3]); }
@@ -172,10 +206,31 @@ public:
 	
 	// Plays FM for at most count samples into *out, and returns number of
 	// samples actually generated (always even). Also runs PSG for blip_time.
-	int play_frame( blip_time_t blip_time, int count, blip_sample_t out [] );
+	// If chips are separate, also writes chip i's samples to chip_out [i].
+	int play_frame( blip_time_t blip_time, int count, blip_sample_t out [],
+			blip_sample_t* const chip_out [] = NULL );
+	
+	// Keeps each FM and PCM chip on its own bus, so that play_frame() can write
+	// their samples separately. Must be called before init_chips().
+	void separate_chips()               { chips_separate_ = true; }
+	bool chips_separate() const         { return chips_separate_; }
+	
+	// Number of FM and PCM chips used by file, in the order play_frame() writes
+	// them, and name of chip i
+	enum { max_chips = 32 };
+	int chip_count() const              { return runner_count; }
+	const char* chip_name( int i ) const { return runners [i].name; }
+	
+	// Mutes/unmutes chip i, which keeps running
+	void mute_chip( int i, bool mute )  { runners [i].input->muted = mute; }
 	
 	// True if all of file data has been played
-	bool track_ended() const            { return pos >= file_end(); }
+	bool track_ended() const            { return pos >= (int) events.size(); }
+	
+	// Saves/loads log position and state of sound chips and DAC stream
+	// control, but not of stereo_buf. ROM data isn't saved, but written again
+	// from file when loading. Must be called between frames.
+	blargg_err_t copy_state( State_Copier& );
 	
     // 0 for PSG and YM2612 DAC, 1 for AY, 2 for HuC6280, 3 for GB DMG
     Stereo_Buffer stereo_buf[4];
@@ -193,28 +248,28 @@ public:
 	Blip_Synth_Fast pcm;
 	
 	// FM sound chips
-	Chip_Resampler_Emu<Ymf262_Emu> ymf262[2];
-	Chip_Resampler_Emu<Ym3812_Emu> ym3812[2];
-	Chip_Resampler_Emu<Ym2612_Emu> ym2612[2];
-	Chip_Resampler_Emu<Ym2610b_Emu> ym2610[2];
-	Chip_Resampler_Emu<Ym2608_Emu> ym2608[2];
-	Chip_Resampler_Emu<Ym2413_Emu> ym2413[2];
-	Chip_Resampler_Emu<Ym2151_Emu> ym2151[2];
-	Chip_Resampler_Emu<Ym2203_Emu> ym2203[2];
+	Vgm_Chip<Ymf262_Emu> ymf262[2];
+	Vgm_Chip<Ym3812_Emu> ym3812[2];
+	Vgm_Chip<Ym2612_Emu> ym2612[2];
+	Vgm_Chip<Ym2610b_Emu> ym2610[2];
+	Vgm_Chip<Ym2608_Emu> ym2608[2];
+	Vgm_Chip<Ym2413_Emu> ym2413[2];
+	Vgm_Chip<Ym2151_Emu> ym2151[2];
+	Vgm_Chip<Ym2203_Emu> ym2203[2];
 
 	// PCM sound chips
-	Chip_Resampler_Emu<C140_Emu> c140;
-	Chip_Resampler_Emu<SegaPcm_Emu> segapcm;
-	Chip_Resampler_Emu<Rf5C68_Emu> rf5c68;
-	Chip_Resampler_Emu<Rf5C164_Emu> rf5c164;
-	Chip_Resampler_Emu<Pwm_Emu> pwm;
-	Chip_Resampler_Emu<Okim6258_Emu> okim6258[2]; int okim6258_hz[2];
-	Chip_Resampler_Emu<Okim6295_Emu> okim6295[2]; int okim6295_hz;
-	Chip_Resampler_Emu<K051649_Emu> k051649;
-	Chip_Resampler_Emu<K053260_Emu> k053260;
-	Chip_Resampler_Emu<K054539_Emu> k054539;
-	Chip_Resampler_Emu<Ymz280b_Emu> ymz280b; int ymz280b_hz;
-    Chip_Resampler_Emu<Qsound_Apu> qsound[2];
+	Vgm_Chip<C140_Emu> c140;
+	Vgm_Chip<SegaPcm_Emu> segapcm;
+	Vgm_Chip<Rf5C68_Emu> rf5c68;
+	Vgm_Chip<Rf5C164_Emu> rf5c164;
+	Vgm_Chip<Pwm_Emu> pwm;
+	Vgm_Chip<Okim6258_Emu> okim6258[2]; int okim6258_hz[2];
+	Vgm_Chip<Okim6295_Emu> okim6295[2]; int okim6295_hz;
+	Vgm_Chip<K051649_Emu> k051649;
+	Vgm_Chip<K053260_Emu> k053260;
+	Vgm_Chip<K054539_Emu> k054539;
+	Vgm_Chip<Ymz280b_Emu> ymz280b; int ymz280b_hz;
+    Vgm_Chip<Qsound_Apu> qsound[2];
 
 	// DAC control
 	typedef struct daccontrol_data
@@ -279,10 +334,29 @@ private:
 	int gbdmg_time_offset;
 	blip_time_t to_gbdmg_time( vgm_time_t ) const;
 	
-	// Current time and position in log
+	// Log is decoded into events when loaded, so that playing doesn't need to
+	// parse and check it
+	struct event_t
+	{
+		int delay;      // VGM time to wait after event
+		int offset;     // offset in file of command's operands
+		byte kind;
+		byte chip_type; // chip_reg_write() parameters
+		byte chip_id;
+		byte port;
+		byte reg;
+		byte data;
+	};
+	blargg_vector<event_t> events;
+	int decode_log( byte const* begin, event_t* out );
+	blargg_err_t decode_log();
+	byte const* log_begin() const;
+	void run_command( byte const* pos, vgm_time_t );
+	
+	// Current time and position in events
 	vgm_time_t vgm_time;
-	byte const* pos;
-	byte const* loop_begin;
+	int pos;
+	int loop_begin; // event to loop back to, or events.size() if not looped
 	bool has_looped;
 	
 	// PCM
@@ -320,6 +394,11 @@ private:
 	void AddPCMData(byte Type, unsigned DataSize, const byte* Data);
 	bool DecompressDataBlk(VGM_PCM_DATA* Bank, unsigned DataSize, const byte* Data);
 	const byte* GetPointerFromPCMBank(byte Type, unsigned DataPos);
+	void decode_pcm_blocks(); // decodes all PCM blocks in log
+	
+	// ROM data blocks
+	void write_rom_block( int type, int chipid, int size, byte const* data );
+	void rewrite_rom_blocks(); // writes ROM blocks in log before pos again
 
 	byte const* pcm_pos;    // current position in PCM data
 	int dac_amp[2];
@@ -347,6 +426,36 @@ private:
 	int run_k053260( int time );
 	int run_k054539( int time );
     int run_qsound( int chip, int time );
+	
+	// Chips used by file, in the order they are run at end of frame, so that
+	// play_frame() only visits those
+	typedef int (Vgm_Core::*run_func_t)( int chip, int time );
+	typedef int (Vgm_Core::*run_single_func_t)( int time );
+	struct runner_t
+	{
+		Chip_Bus_Input* input;
+		run_func_t run;                 // chips that can be dual
+		run_single_func_t run_single;   // chips that can't
+		int chip;
+		const char* name;
+	};
+	enum { max_runners = max_chips };
+	runner_t runners [max_runners];
+	int runner_count;
+	template<class Emu>
+	void add_runner( Vgm_Chip<Emu>&, run_func_t, run_single_func_t, const char* name, int chip = 0 );
+	void build_runners();
+	
+	// Chips with the same rate are mixed and resampled together, so there's one
+	// bus for each distinct rate, except for chips whose rate can change. If
+	// chips are separate, each has its own bus, in the same order as runners.
+	bool chips_separate_;
+	enum { max_buses = max_runners };
+	Chip_Bus* buses [max_buses];
+	int bus_count;
+	blargg_err_t build_buses();
+	void free_buses();
+	
 	void update_fm_rates( int* ym2151_rate, int* ym2413_rate, int* ym2612_rate ) const;
 };
 
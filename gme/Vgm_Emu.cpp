@@ -2,6 +2,7 @@
 
 #include "Vgm_Emu.h"
 
+#include "State_Copier.h"
 #include "blargg_endian.h"
 #include "blargg_common.h"
 
@@ -361,6 +362,18 @@ void Vgm_Emu::mute_voices_( int mask )
 	// TODO: silence PCM if FM isn't used?
 	if ( core.uses_fm() )
 	{
+		// channels within FM and PCM chips
+		int fm_mask = mask;
+		if ( core.chips_separate() )
+		{
+			// each chip is a voice, then last voice is everything else
+			int n = core.chip_count();
+			for ( int i = 0; i < n; i++ )
+				core.mute_chip( i, (mask >> i) & 1 );
+			mask    = ((mask >> n) & 1) ? ~0 : 0;
+			fm_mask = 0;
+		}
+		
 		core.psg[0].set_output( ( mask & 0x80 ) ? 0 : core.stereo_buf[0].center() );
 		core.psg[1].set_output( ( mask & 0x80 ) ? 0 : core.stereo_buf[0].center() );
 		core.ay[0].set_output( ( mask & 0x80 ) ? 0 : core.stereo_buf[1].center() );
@@ -384,28 +397,28 @@ void Vgm_Emu::mute_voices_( int mask )
 		if (core.ym2612[0].enabled())
 		{
 			core.pcm.volume( (mask & 0x40) ? 0.0 : 0.1115 / 256 * fm_gain * gain() );
-			core.ym2612[0].mute_voices( mask );
+			core.ym2612[0]->mute_voices( fm_mask );
 			if ( core.ym2612[1].enabled() )
-				core.ym2612[1].mute_voices( mask );
+				core.ym2612[1]->mute_voices( fm_mask );
 		}
 		
 		if ( core.ym2413[0].enabled() )
 		{
-			int m = mask & 0x3F;
-			if ( mask & 0x20 )
+			int m = fm_mask & 0x3F;
+			if ( fm_mask & 0x20 )
 				m |= 0x01E0; // channels 5-8
-			if ( mask & 0x40 )
+			if ( fm_mask & 0x40 )
 				m |= 0x3E00;
-			core.ym2413[0].mute_voices( m );
+			core.ym2413[0]->mute_voices( m );
 			if ( core.ym2413[1].enabled() )
-				core.ym2413[1].mute_voices( m );
+				core.ym2413[1]->mute_voices( m );
 		}
 
 		if ( core.ym2151[0].enabled() )
 		{
-			core.ym2151[0].mute_voices( mask );
+			core.ym2151[0]->mute_voices( fm_mask );
 			if ( core.ym2151[1].enabled() )
-				core.ym2151[1].mute_voices( mask );
+				core.ym2151[1]->mute_voices( fm_mask );
 		}
 
 		if ( core.c140.enabled() )
@@ -414,19 +427,19 @@ void Vgm_Emu::mute_voices_( int mask )
 			int m_add = 7;
 			for ( unsigned i = 0; i < 8; i++, m_add <<= 3 )
 			{
-				if ( mask & ( 1 << i ) ) m += m_add;
+				if ( fm_mask & ( 1 << i ) ) m += m_add;
 			}
-			core.c140.mute_voices( m );
+			core.c140->mute_voices( m );
 		}
 
 		if ( core.rf5c68.enabled() )
 		{
-			core.rf5c68.mute_voices( mask );
+			core.rf5c68->mute_voices( fm_mask );
 		}
 
 		if ( core.rf5c164.enabled() )
 		{
-			core.rf5c164.mute_voices( mask );
+			core.rf5c164->mute_voices( fm_mask );
 		}
 	}
 }
@@ -447,6 +460,17 @@ blargg_err_t Vgm_Emu::load_mem_( byte const data [], int size )
 	if ( core.uses_fm() )
 	{
 		set_voice_count( 8 );
+		if ( core.chips_separate() )
+		{
+			int n = core.chip_count();
+			if ( n + 1 > 32 ) // muting mask has 32 bits
+				return BLARGG_ERR( BLARGG_ERR_LIMITATION, "too many chips for voice output" );
+			for ( int i = 0; i < n; i++ )
+				chip_voice_names [i] = core.chip_name( i );
+			chip_voice_names [n] = "PSG & PCM";
+			set_voice_count( n + 1 );
+			RETURN_ERR( resampler.separate_voices( n ) );
+		}
 		RETURN_ERR( resampler.setup( fm_rate / sample_rate(), rolloff, gain() ) );
 		RETURN_ERR( resampler.reset( core.stereo_buf[0].length() * sample_rate() / 1000 ) );
 		core.psg[0].volume( 0.135 * fm_gain * psg_gain * gain() );
@@ -469,8 +493,10 @@ blargg_err_t Vgm_Emu::load_mem_( byte const data [], int size )
 	};
 	static const char* const psg_names [] = { "Square 1", "Square 2", "Square 3", "Noise" };
 	set_voice_names( core.uses_fm() ? fm_names : psg_names );
+	if ( core.uses_fm() && core.chips_separate() )
+		set_voice_names( chip_voice_names );
 	
-	static int const types [8] = {
+	static int const types [Vgm_Core::max_chips + 1] = {
 		wave_type+1, wave_type+2, wave_type+3, noise_type+1,
 		0, 0, 0, 0
 	};
@@ -518,8 +544,17 @@ blargg_err_t Vgm_Emu::run_clocks( blip_time_t& time_io, int msec )
 
 inline int Vgm_Emu::play_frame( blip_time_t blip_time, int sample_count, sample_t buf [] )
 {
+	GME_PROFILE_STAGE( emulate );
 	check_end();
-	int result = core.play_frame( blip_time, sample_count, buf );
+	sample_t* chip_bufs [Vgm_Core::max_chips];
+	sample_t** chip_out = NULL;
+	if ( core.uses_fm() && core.chips_separate() )
+	{
+		for ( int i = core.chip_count(); --i >= 0; )
+			chip_bufs [i] = resampler.voice_buffer( i );
+		chip_out = chip_bufs;
+	}
+	int result = core.play_frame( blip_time, sample_count, buf, chip_out );
 	check_warning();
 	return result;
 }
@@ -539,6 +574,49 @@ blargg_err_t Vgm_Emu::play_( int count, sample_t out [] )
 	return blargg_ok;
 }
 
+blargg_err_t Vgm_Emu::play_wide_( int count, wide_sample_t out [] )
+{
+	if ( !core.uses_fm() )
+		return Classic_Emu::play_wide_( count, out );
+	
+	// Dual_Resampler mixes FM and PSG to 16 bits
+	return Music_Emu::play_wide_( count, out );
+}
+
+blargg_err_t Vgm_Emu::separate_voices_()
+{
+	RETURN_ERR( Classic_Emu::separate_voices_() );
+	core.separate_chips();
+	return blargg_ok;
+}
+
+// FM chips mix their channels internally, so voices are whole chips, on their
+// own buses and resamplers
+blargg_err_t Vgm_Emu::set_voice_out_( sample_t* const out [] )
+{
+	if ( !core.uses_fm() )
+		return Classic_Emu::set_voice_out_( out );
+	
+	if ( !core.chips_separate() )
+		return BLARGG_ERR( BLARGG_ERR_CALLER, "emulator not created for voice output" );
+	
+	resampler.set_voice_out( out );
+	return blargg_ok;
+}
+
+blargg_err_t Vgm_Emu::copy_state_( State_Copier& copier )
+{
+	copier.tag( core.chips_separate() ? BLARGG_4CHAR('V','G','M','v') : BLARGG_4CHAR('V','G','M','s') );
+	RETURN_ERR( core.copy_state( copier ) );
+	if ( core.uses_fm() )
+	{
+		resampler.copy_state( copier );
+		for ( int i = 0; i < 4; i++ )
+			core.stereo_buf [i].copy_state( copier );
+	}
+	return copy_buffer_state( copier );
+}
+
 blargg_err_t Vgm_Emu::hash_( Hash_Function& out ) const
 {
 	byte const* p = file_begin() + header().size();
@@ -47,12 +47,16 @@ protected:
 	blargg_err_t set_sample_rate_( int sample_rate );
 	blargg_err_t start_track_( int );
 	blargg_err_t play_( int count, sample_t  []);
+	blargg_err_t play_wide_( int count, wide_sample_t [] );
+	blargg_err_t separate_voices_();
+	blargg_err_t set_voice_out_( sample_t* const [] );
 	blargg_err_t run_clocks( blip_time_t&, int );
 	virtual void set_tempo_( double );
 	virtual void mute_voices_( int mask );
 	virtual void set_voice( int, Blip_Buffer*, Blip_Buffer*, Blip_Buffer* );
 	virtual void update_eq( blip_eq_t const& );
 	virtual void unload();
+	virtual blargg_err_t copy_state_( State_Copier& );
 	
 private:
 	bool disable_oversampling_;
@@ -60,6 +64,10 @@ private:
 	Dual_Resampler resampler;
 	Vgm_Core core;
 	
+	// With separate voices, FM files have a voice for each FM and PCM chip,
+	// then one for everything else
+	const char* chip_voice_names [Vgm_Core::max_chips + 1];
+	
 	void check_end();
 	void check_warning();
 	int play_frame( blip_time_t blip_time, int sample_count, sample_t buf [] );
@@ -0,0 +1,201 @@
+// Game_Music_Emu $vers. http://www.slack.net/~ant/
+
+#include "Voice_Buffer.h"
+
+#include "State_Copier.h"
+#include <new>
+
+/* Copyright (C) 2008 Shay Green. This module is free software; you
+can redistribute it and/or modify it under the terms of the GNU Lesser
+General Public License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version. This
+module is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+details. You should have received a copy of the GNU Lesser General Public
+License along with this module; if not, write to the Free Software Foundation,
+Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA */
+
+#include "blargg_source.h"
+
+int const stereo = 2;
+
+Voice_Buffer::Voice_Buffer() : Multi_Buffer( stereo )
+{
+	bufs           = NULL;
+	bufs_size      = 0;
+	chan_out       = NULL;
+	chan_out_pos   = 0;
+	clock_rate_    = 0;
+	bass_freq_     = 90;
+}
+
+Voice_Buffer::~Voice_Buffer()
+{
+	delete_bufs();
+}
+
+// avoid using new []
+blargg_err_t Voice_Buffer::new_bufs( int size )
+{
+	bufs = (Stereo_Buffer*) malloc( size * sizeof *bufs );
+	CHECK_ALLOC( bufs || !size );
+	for ( int i = 0; i < size; i++ )
+		::new (bufs + i) Stereo_Buffer;
+	bufs_size = size;
+	return blargg_ok;
+}
+
+void Voice_Buffer::delete_bufs()
+{
+	if ( bufs )
+	{
+		for ( int i = bufs_size; --i >= 0; )
+			bufs [i].~Stereo_Buffer();
+		free( bufs );
+		bufs = NULL;
+	}
+	bufs_size = 0;
+}
+
+void Voice_Buffer::set_channel_out( blip_sample_t* const out [] )
+{
+	chan_out     = out;
+	chan_out_pos = 0;
+}
+
+blargg_err_t Voice_Buffer::set_sample_rate( int rate, int msec )
+{
+	for ( int i = bufs_size; --i >= 0; )
+		RETURN_ERR( bufs [i].set_sample_rate( rate, msec ) );
+	return Multi_Buffer::set_sample_rate( rate, msec );
+}
+
+blargg_err_t Voice_Buffer::set_channel_count( int count, int const types [] )
+{
+	RETURN_ERR( Multi_Buffer::set_channel_count( count, types ) );
+
+	delete_bufs();
+	RETURN_ERR( new_bufs( count ) );
+	channels_changed();
+
+	for ( int i = bufs_size; --i >= 0; )
+	{
+		Stereo_Buffer& b = bufs [i];
+		RETURN_ERR( b.set_sample_rate( sample_rate(), length() ) );
+		b.clock_rate( clock_rate_ );
+		b.bass_freq( bass_freq_ );
+
+		// all are read completely before more is added
+		b.disable_immediate_removal();
+	}
+	return blargg_ok;
+}
+
+void Voice_Buffer::clock_rate( int rate )
+{
+	clock_rate_ = rate;
+	for ( int i = bufs_size; --i >= 0; )
+		bufs [i].clock_rate( clock_rate_ );
+}
+
+void Voice_Buffer::bass_freq( int freq )
+{
+	bass_freq_ = freq;
+	for ( int i = bufs_size; --i >= 0; )
+		bufs [i].bass_freq( bass_freq_ );
+}
+
+
+void Voice_Buffer::clear()
+{
+	for ( int i = bufs_size; --i >= 0; )
+		bufs [i].clear();
+}
+
+Multi_Buffer::channel_t Voice_Buffer::channel( int i )
+{
+	if ( i < bufs_size )
+		return bufs [i].channel( 0 );
+
+	channel_t none = { NULL, NULL, NULL };
+	return none;
+}
+
+void Voice_Buffer::end_frame( blip_time_t time )
+{
+	for ( int i = bufs_size; --i >= 0; )
+		bufs [i].end_frame( time );
+}
+
+int Voice_Buffer::samples_avail() const
+{
+	// all buffers are ended and read together
+	return bufs_size ? bufs [0].samples_avail() : 0;
+}
+
+void Voice_Buffer::copy_state( State_Copier& copier )
+{
+	copier.tag( BLARGG_4CHAR('V','O','I','b') );
+
+	int count = bufs_size;
+	copier.copy( count );
+	if ( count != bufs_size )
+		copier.set_error( BLARGG_ERR( BLARGG_ERR_FILE_CORRUPT, "state" ) );
+
+	for ( int i = 0; i < bufs_size; i++ )
+		bufs [i].copy_state( copier );
+}
+
+int Voice_Buffer::read_samples( blip_sample_t out [], int out_size )
+{
+	return read_samples_( out, out_size );
+}
+
+int Voice_Buffer::read_samples_wide( blip_wide_sample_t out [], int out_size )
+{
+	return read_samples_( out, out_size );
+}
+
+template<class T>
+int Voice_Buffer::read_samples_( T out [], int out_size )
+{
+	require( (out_size & 1) == 0 ); // must read an even number of samples
+	out_size = min( out_size, samples_avail() );
+
+	// Each channel is read unclamped into chan, written to its own output,
+	// then added to mix. Mix is clamped only once, like a single Stereo_Buffer.
+	int const chunk_size = 512;
+	blip_wide_sample_t chan [chunk_size];
+	blip_wide_sample_t mix  [chunk_size];
+	for ( int pos = 0; pos < out_size; )
+	{
+		int const count = min( out_size - pos, chunk_size );
+		for ( int i = 0; i < bufs_size; i++ )
+		{
+			int n = bufs [i].read_samples_wide( chan, count );
+			assert( n == count );
+			(void) n;
+
+			if ( chan_out && chan_out [i] )
+			{
+				blip_sample_t* BLARGG_RESTRICT co = chan_out [i] + chan_out_pos;
+				for ( int j = 0; j < count; j++ )
+					blip_store( co [j], chan [j] );
+			}
+
+			if ( i == 0 )
+				memcpy( mix, chan, count * sizeof mix [0] );
+			else
+				for ( int j = 0; j < count; j++ )
+					mix [j] += chan [j];
+		}
+
+		for ( int j = 0; j < count; j++ )
+			blip_store( out [pos + j], mix [j] );
+
+		pos          += count;
+		chan_out_pos += count;
+	}
+	return out_size;
+}
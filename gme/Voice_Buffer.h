@@ -0,0 +1,48 @@
+// Multi-channel buffer that keeps each channel separate, so that their output
+// can be read individually along with the usual stereo mix
+
+// Game_Music_Emu $vers
+#ifndef VOICE_BUFFER_H
+#define VOICE_BUFFER_H
+
+#include "Multi_Buffer.h"
+
+class Voice_Buffer : public Multi_Buffer {
+public:
+	// Makes read_samples() also write each channel's own stereo samples to
+	// out [i], or not at all where out [i] is NULL. Writing starts at beginning
+	// of out [i] and continues from there with each read. Pass NULL to stop.
+	void set_channel_out( blip_sample_t* const out [] );
+
+// Implementation
+public:
+	Voice_Buffer();
+	~Voice_Buffer();
+	virtual blargg_err_t set_channel_count( int, int const types [] = NULL );
+	virtual blargg_err_t set_sample_rate( int, int msec = blip_default_length );
+	virtual void clock_rate( int );
+	virtual void bass_freq( int );
+	virtual void clear();
+	virtual channel_t channel( int );
+	virtual void end_frame( blip_time_t );
+	virtual int samples_avail() const;
+	virtual int read_samples( blip_sample_t [], int );
+	virtual int read_samples_wide( blip_wide_sample_t [], int );
+	virtual void copy_state( State_Copier& );
+
+private:
+	Stereo_Buffer* bufs;
+	int bufs_size;
+	blip_sample_t* const* chan_out; // NULL if not writing channels
+	int chan_out_pos;
+
+	// for setting up new buffers
+	int clock_rate_;
+	int bass_freq_;
+
+	blargg_err_t new_bufs( int size );
+	void delete_bufs();
+	template<class T> int read_samples_( T [], int );
+};
+
+#endif
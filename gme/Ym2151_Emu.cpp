@@ -3,6 +3,8 @@
 #include "Ym2151_Emu.h"
 #include "ym2151.h"
 
+#include "State_Copier.h"
+
 Ym2151_Emu::Ym2151_Emu() { PSG = 0; }
 
 Ym2151_Emu::~Ym2151_Emu()
@@ -73,3 +75,11 @@ void Ym2151_Emu::run( int pair_count, sample_t* out )
 		pair_count -= todo;
 	}
 }
+
+void Ym2151_Emu::copy_state( State_Copier& copier )
+{
+	int ptrs [YM2151_STATE_PTRS];
+	int ptr_count = ym2151_state_ptrs( PSG, ptrs );
+	copier.add_block( PSG, ym2151_state_size() );
+	copier.copy_with_ptrs( PSG, ym2151_state_size(), ptrs, ptr_count );
+}
@@ -4,6 +4,8 @@
 #ifndef YM2151_EMU_H
 #define YM2151_EMU_H
 
+class State_Copier;
+
 class Ym2151_Emu  {
 	void* PSG;
 public:
@@ -28,6 +30,9 @@ public:
 	typedef short sample_t;
 	enum { out_chan_count = 2 }; // stereo
 	void run( int pair_count, sample_t* out );
+	
+	// Saves/loads exact emulation state in place, including mute mask
+	void copy_state( State_Copier& );
 };
 
 #endif
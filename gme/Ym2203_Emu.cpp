@@ -4,6 +4,8 @@
 #include "fm.h"
 #include <string.h>
 
+#include "State_Copier.h"
+
 static void psg_set_clock(void *param, int clock)
 {
 	Ym2203_Emu *info = (Ym2203_Emu *)param;
@@ -153,3 +155,20 @@ void Ym2203_Emu::psg_reset()
 {
 	psg.reset();
 }
+
+void Ym2203_Emu::copy_state( State_Copier& copier )
+{
+	int ptrs [YM2203_STATE_PTRS];
+	int ptr_count = ym2203_state_ptrs( opn, ptrs );
+	int kept [YM2203_STATE_KEPT];
+	int kept_count = ym2203_state_kept( opn, kept );
+	copier.add_block( opn, ym2203_state_size() );
+	copier.copy_with_ptrs( opn, ym2203_state_size(), ptrs, ptr_count, kept, kept_count );
+	
+	unsigned old_psg_clock = psg_clock;
+	copier.copy( psg_clock );
+	if ( psg_clock != old_psg_clock )
+		buffer.clock_rate( psg_clock );
+	psg.copy_state( copier );
+	buffer.copy_state( copier );
+}
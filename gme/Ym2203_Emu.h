@@ -6,6 +6,8 @@
 
 #include "Ay_Apu.h"
 
+class State_Copier;
+
 class Ym2203_Emu  {
 	void* opn;
 	Ay_Apu psg;
@@ -40,6 +42,9 @@ public:
 	inline void psg_write( int addr, int data );
 	inline int psg_read();
 	inline void psg_reset();
+	
+	// Saves/loads exact emulation state in place, including mute mask
+	void copy_state( State_Copier& );
 };
 
 #endif
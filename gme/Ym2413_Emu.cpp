@@ -2,6 +2,7 @@
 
 #include "Ym2413_Emu.h"
 #include "ym2413.h"
+#include "State_Copier.h"
 
 Ym2413_Emu::Ym2413_Emu() { opll = 0; }
 
@@ -46,6 +47,14 @@ void Ym2413_Emu::mute_voices( int mask )
 	ym2413_set_mask( opll, mask );
 }
 
+void Ym2413_Emu::copy_state( State_Copier& copier )
+{
+	int ptrs [YM2413_STATE_PTRS];
+	int ptr_count = ym2413_state_ptrs( opll, ptrs );
+	copier.add_block( opll, ym2413_state_size() );
+	copier.copy_with_ptrs( opll, ym2413_state_size(), ptrs, ptr_count );
+}
+
 void Ym2413_Emu::run( int pair_count, sample_t* out )
 {
 	SAMP bufMO[ 1024 ];
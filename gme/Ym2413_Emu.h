@@ -5,6 +5,7 @@
 #define YM2413_EMU_H
 
 struct OPLL;
+class State_Copier;
 
 class Ym2413_Emu  {
 	void* opll;
@@ -28,6 +29,9 @@ public:
 	// Writes data to addr
 	void write( int addr, int data );
 	
+	// Saves/loads exact emulation state in place, including mute mask
+	void copy_state( State_Copier& );
+	
 	// Runs and writes pair_count*2 samples to output
 	typedef short sample_t;
 	enum { out_chan_count = 2 }; // stereo
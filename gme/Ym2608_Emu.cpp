@@ -4,6 +4,8 @@
 #include "fm.h"
 #include <string.h>
 
+#include "State_Copier.h"
+
 static void psg_set_clock(void *param, int clock)
 {
 	Ym2608_Emu *info = (Ym2608_Emu *)param;
@@ -165,3 +167,20 @@ void Ym2608_Emu::psg_reset()
 {
 	psg.reset();
 }
+
+void Ym2608_Emu::copy_state( State_Copier& copier )
+{
+	int ptrs [YM2608_STATE_PTRS];
+	int ptr_count = ym2608_state_ptrs( opn, ptrs );
+	int kept [YM2608_STATE_KEPT];
+	int kept_count = ym2608_state_kept( opn, kept );
+	copier.add_block( opn, ym2608_state_size() );
+	copier.copy_with_ptrs( opn, ym2608_state_size(), ptrs, ptr_count, kept, kept_count );
+	
+	unsigned old_psg_clock = psg_clock;
+	copier.copy( psg_clock );
+	if ( psg_clock != old_psg_clock )
+		buffer.clock_rate( psg_clock );
+	psg.copy_state( copier );
+	buffer.copy_state( copier );
+}
@@ -6,6 +6,8 @@
 
 #include "Ay_Apu.h"
 
+class State_Copier;
+
 class Ym2610b_Emu  {
 	void* opn;
 	Ay_Apu psg;
@@ -45,6 +47,10 @@ public:
 	inline void psg_write( int addr, int data );
 	inline int psg_read();
 	inline void psg_reset();
+	
+	// Saves/loads exact emulation state in place, including mute mask but
+	// not ROM
+	void copy_state( State_Copier& );
 };
 
 #endif
@@ -12,6 +12,8 @@ struct Ym2612_Impl;
 typedef void Ym2612_Impl;
 #endif
 
+class State_Copier;
+
 class Ym2612_Emu  {
 	Ym2612_Impl* impl;
 public:
@@ -35,6 +37,9 @@ public:
 	// Writes addr to register 2 then data to register 3
 	void write1( int addr, int data );
 	
+	// Saves/loads exact emulation state in place, including mute mask
+	void copy_state( State_Copier& );
+	
 	// Runs and adds pair_count*2 samples into current output buffer contents
 	typedef short sample_t;
 	enum { out_chan_count = 2 }; // stereo
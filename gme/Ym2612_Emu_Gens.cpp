@@ -4,6 +4,8 @@
 
 #include "Ym2612_Emu.h"
 
+#include "State_Copier.h"
+
 #include <assert.h>
 #include <stdlib.h>
 #include <string.h>
@@ -934,6 +936,29 @@ void Ym2612_Emu::write1( int addr, int data )
 
 void Ym2612_Emu::mute_voices( int mask ) { impl->mute_mask = mask; }
 
+void Ym2612_Emu::copy_state( State_Copier& copier )
+{
+	// Slots point into tables in impl
+	state_t& st = impl->YM2612;
+	int ptrs [channel_count * 4 * 5];
+	int n = 0;
+	for ( int c = 0; c < channel_count; c++ )
+	{
+		for ( int s = 0; s < 4; s++ )
+		{
+			slot_t const& sl = st.CHANNEL [c].SLOT [s];
+			ptrs [n++] = (int) ((char const*) &sl.DT - (char const*) &st);
+			ptrs [n++] = (int) ((char const*) &sl.AR - (char const*) &st);
+			ptrs [n++] = (int) ((char const*) &sl.DR - (char const*) &st);
+			ptrs [n++] = (int) ((char const*) &sl.SR - (char const*) &st);
+			ptrs [n++] = (int) ((char const*) &sl.RR - (char const*) &st);
+		}
+	}
+	copier.add_block( impl, sizeof *impl );
+	copier.copy_with_ptrs( &st, sizeof st, ptrs, n );
+	copier.copy( impl->mute_mask );
+}
+
 static void update_envelope_( slot_t* sl )
 {
 	switch ( sl->Ecurp )
@@ -3,6 +3,7 @@
 #include "Ym2612_Emu.h"
 #include "fm.h"
 
+#include "State_Copier.h"
 #include "blargg_errors.h"
 
 // Ym2612_Emu
@@ -57,6 +58,14 @@ void Ym2612_Emu::mute_voices( int mask )
 	ym2612_set_mutemask( impl, mask );
 }
 
+void Ym2612_Emu::copy_state( State_Copier& copier )
+{
+	int ptrs [YM2612_STATE_PTRS];
+	int ptr_count = ym2612_state_ptrs( impl, ptrs );
+	copier.add_block( impl, ym2612_state_size() );
+	copier.copy_with_ptrs( impl, ym2612_state_size(), ptrs, ptr_count );
+}
+
 void Ym2612_Emu::run( int pair_count, sample_t* out )
 {
 	stream_sample_t bufL[ 1024 ];
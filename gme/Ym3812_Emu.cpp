@@ -5,6 +5,8 @@
 #include <math.h>
 #include "dbopl.h"
 
+#include "State_Copier.h"
+
 Ym3812_Emu::Ym3812_Emu() { opl = 0; }
 
 Ym3812_Emu::~Ym3812_Emu()
@@ -64,3 +66,10 @@ void Ym3812_Emu::run( int pair_count, sample_t* out )
 		pair_count -= todo;
 	}
 }
+
+void Ym3812_Emu::copy_state( State_Copier& copier )
+{
+	// chip only points to static tables and handlers, which are the same
+	// for all chips
+	copier.copy( *opl );
+}
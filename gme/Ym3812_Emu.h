@@ -8,6 +8,8 @@ namespace DBOPL {
 	struct Chip;
 }
 
+class State_Copier;
+
 class Ym3812_Emu  {
 	DBOPL::Chip * opl;
 	unsigned sample_rate;
@@ -30,6 +32,9 @@ public:
 	typedef short sample_t;
 	enum { out_chan_count = 2 }; // stereo
 	void run( int pair_count, sample_t* out );
+	
+	// Saves/loads exact emulation state in place
+	void copy_state( State_Copier& );
 };
 
 #endif
@@ -5,6 +5,8 @@
 #include <math.h>
 #include "dbopl.h"
 
+#include "State_Copier.h"
+
 Ymf262_Emu::Ymf262_Emu() { opl = 0; }
 
 Ymf262_Emu::~Ymf262_Emu()
@@ -91,3 +93,10 @@ void Ymf262_Emu::run( int pair_count, sample_t* out )
 		pair_count -= todo;
 	}
 }
+
+void Ymf262_Emu::copy_state( State_Copier& copier )
+{
+	// chip only points to static tables and handlers, which are the same
+	// for all chips
+	copier.copy( *opl );
+}
@@ -3,6 +3,8 @@
 #include "Ymz280b_Emu.h"
 #include "ymz280b.h"
 
+#include "State_Copier.h"
+
 Ymz280b_Emu::Ymz280b_Emu() { chip = 0; }
 
 Ymz280b_Emu::~Ymz280b_Emu()
@@ -76,3 +78,10 @@ void Ymz280b_Emu::run( int pair_count, sample_t* out )
 		pair_count -= todo;
 	}
 }
+
+void Ymz280b_Emu::copy_state( State_Copier& copier )
+{
+	int kept [YMZ280B_STATE_KEPT];
+	int kept_count = ymz280b_state_kept( chip, kept );
+	copier.copy_with_ptrs( chip, ymz280b_state_size(), NULL, 0, kept, kept_count );
+}
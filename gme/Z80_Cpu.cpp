@@ -2,6 +2,8 @@
 
 #include "Z80_Cpu.h"
 
+#include "State_Copier.h"
+
 /* Copyright (C) 2006-2008 Shay Green. This module is free software; you
 can redistribute it and/or modify it under the terms of the GNU Lesser
 General Public License as published by the Free Software Foundation; either
@@ -68,6 +70,24 @@ void Z80_Cpu::reset( void* unmapped_write, void const* unmapped_read )
 	memset( &r, 0, sizeof r );
 }
 
+void Z80_Cpu::copy_state( State_Copier& copier )
+{
+	assert( cpu_state == &cpu_state_ );
+	copier.copy( r );
+	for ( int i = 0; i < page_count + 1; i++ )
+	{
+		int offset = Z80_CPU_OFFSET( i * page_size );
+		byte      * write = cpu_state_.write [i] + offset;
+		byte const* read  = cpu_state_.read  [i] + offset;
+		copier.copy_ptr( write );
+		copier.copy_ptr( read );
+		set_page( i, write, read );
+	}
+	copier.copy( cpu_state_.base );
+	copier.copy( cpu_state_.time );
+	copier.copy( end_time_ );
+}
+
 void Z80_Cpu::map_mem( addr_t start, int size, void* write, void const* read )
 {
 	// address range must begin and end on page boundaries
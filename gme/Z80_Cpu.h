@@ -5,6 +5,7 @@
 #define Z80_CPU_H
 
 #include "blargg_endian.h"
+class State_Copier;
 
 class Z80_Cpu {
 public:
@@ -72,6 +73,10 @@ public:
 	enum { page_padding = 4 };
 	
 	void set_end_time( time_t t );
+	
+	// Saves/loads registers, time, and memory map. Memory mapped must be within
+	// blocks already added to copier. Must not be called during emulation.
+	void copy_state( State_Copier& );
 public:
 	Z80_Cpu();
 	
@@ -129,6 +129,16 @@ global scope already. */
 	};
 #endif
 
+/* BLARGG_SSE2: 1 if SSE2 intrinsics (<emmintrin.h>) can be used, which is when
+the compiler targets SSE2 (always true for x86-64), unless BLARGG_NO_SIMD is
+defined. SSE2 code paths give output identical to the portable code. */
+#if !defined (BLARGG_NO_SIMD) && (defined (__SSE2__) || defined (_M_X64) || \
+		(defined (_M_IX86_FP) && _M_IX86_FP >= 2))
+	#define BLARGG_SSE2 1
+#else
+	#define BLARGG_SSE2 0
+#endif
+
 /* My code is not written with exceptions in mind, so either uses new (nothrow)
 OR overrides operator new in my classes. The former is best since clients
 creating objects will get standard exceptions on failure, but that causes it
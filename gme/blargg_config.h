@@ -42,9 +42,15 @@
 // Use faster, significantly lower quality sound synthesis for classic emulators.
 //#define BLIP_BUFFER_FAST 1
 
+// Don't use SSE2 code paths, even when compiler targets SSE2.
+//#define BLARGG_NO_SIMD 1
+
 // Reduce memory usage of gme.h by disabling gme_set_effects_config().
 //#define GME_DISABLE_EFFECTS 1
 
+// Time each stage of sound generation for gme_get_profile(). Requires C++11.
+//#define GME_PROFILE 1
+
 // Force library to use assume big-endian processor.
 //#define BLARGG_BIG_ENDIAN 1
 
@@ -589,6 +589,22 @@ void c140_set_mute_mask(void *chip, UINT32 MuteMask)
 	return;
 }
 
+int c140_state_size(void)
+{
+	return sizeof(c140_state);
+}
+
+int c140_state_kept(void *_chip, int *offsets)
+{
+	c140_state *info = (c140_state *) _chip;
+	int n = 0;
+	
+	offsets[n++] = (int)((char *)&info->mixer_buffer_left - (char *)info);
+	offsets[n++] = (int)((char *)&info->mixer_buffer_right - (char *)info);
+	offsets[n++] = (int)((char *)&info->pRom - (char *)info);
+	return n;
+}
+
 
 
 
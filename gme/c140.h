@@ -51,6 +51,16 @@ void c140_write_rom(void * chip, offs_t ROMSize, offs_t DataStart, offs_t DataLe
 
 void c140_set_mute_mask(void * chip, UINT32 MuteMask);
 
+/* size of the block returned by device_start_c140(); it can be copied to save
+state */
+int c140_state_size(void);
+
+/* byte offsets of pointers within that block to memory the chip allocated, in
+increasing order, which are kept when state is loaded into another chip;
+returns count, at most C140_STATE_KEPT */
+#define C140_STATE_KEPT 3
+int c140_state_kept(void *chip, int *offsets);
+
 #ifdef __cplusplus
 }
 #endif
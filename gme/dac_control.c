@@ -365,3 +365,24 @@ void daccontrol_stop(void *_chip)
 	
 	return;
 }
+
+int daccontrol_state_size(void)
+{
+	return sizeof(dac_control);
+}
+
+int daccontrol_state_ptrs(void *_chip, int *offsets)
+{
+	dac_control *chip = (dac_control *) _chip;
+	
+	offsets[0] = (int)((char *)&chip->Data - (char *)chip);
+	return 1;
+}
+
+int daccontrol_state_kept(void *_chip, int *offsets)
+{
+	dac_control *chip = (dac_control *) _chip;
+	
+	offsets[0] = (int)((char *)&chip->context - (char *)chip);
+	return 1;
+}
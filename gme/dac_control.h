@@ -31,6 +31,21 @@ void daccontrol_set_frequency(void *chip, UINT32 Frequency);
 void daccontrol_start(void *chip, UINT32 DataPos, UINT8 LenMode, UINT32 Length);
 void daccontrol_stop(void *chip);
 
+/* size of the block returned by device_start_daccontrol(); it can be copied to
+save state */
+int daccontrol_state_size(void);
+
+/* byte offsets of pointers within that block, in increasing order, so they can
+be relocated when state is loaded into another chip; returns count, at most
+DACCONTROL_STATE_PTRS */
+#define DACCONTROL_STATE_PTRS 1
+int daccontrol_state_ptrs(void *chip, int *offsets);
+
+/* byte offsets of pointers within that block to its owner, which are kept when
+state is loaded; returns count, at most DACCONTROL_STATE_KEPT */
+#define DACCONTROL_STATE_KEPT 1
+int daccontrol_state_kept(void *chip, int *offsets);
+
 #define DCTRL_LMODE_IGNORE	0x00
 #define DCTRL_LMODE_CMDS	0x01
 #define DCTRL_LMODE_MSEC	0x02
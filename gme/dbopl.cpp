@@ -1335,11 +1335,7 @@ void Chip::Setup( Bit32u clock, Bit32u rate ) {
 	}
 }
 
-static bool doneTables = false;
-void InitTables( void ) {
-	if ( doneTables )
-		return;
-	doneTables = true;
+static void BuildTables( void ) {
 #if ( DBOPL_WAVE == WAVE_HANDLER ) || ( DBOPL_WAVE == WAVE_TABLELOG )
 	//Exponential volume table, same as the real adlib
 	for ( int i = 0; i < 256; i++ ) {
@@ -1491,6 +1487,12 @@ void InitTables( void ) {
 #endif
 }
 
+//Tables are shared by all chips and built only once; C++11 makes the local static thread-safe
+void InitTables( void ) {
+	static bool const done = ( BuildTables(), true );
+	(void) done;
+}
+
 /*Bit32u Handler::WriteAddr( Bit32u port, Bit8u val ) {
 	return chip.WriteAddr( port, val );
 
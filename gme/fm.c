@@ -1541,7 +1541,7 @@ static void reset_channels( FM_ST *ST , FM_CH *CH , int num )
 }
 
 /* initialize generic tables */
-static int init_tables(void)
+static void build_tables(void)
 {
 	signed int i,x;
 	signed int n;
@@ -1651,9 +1651,15 @@ static int init_tables(void)
 #ifdef SAVE_SAMPLE
 	sample[0]=fopen("sampsum.pcm","wb");
 #endif
+}
 
-	return 1;
+/* tables are built when first chip is created, then shared by all chips */
+static int tables_built = 0;
 
+static int init_tables(void)
+{
+	mame_init_once( &tables_built, build_tables );
+	return 1;
 }
 
 
@@ -2047,6 +2053,29 @@ static void OPNWriteReg(FM_OPN *OPN, int r, int v)
 	}
 }
 
+#define STATE_OFFSET(field) (int)((char *)&(field) - base)
+
+/* offsets of pointers within state of OPN and its channels, which all point
+   into the chip; base is the start of the chip's state */
+static int OPN_state_ptrs(FM_OPN *OPN, FM_CH *CH, int ch_count, char *base, int *offsets)
+{
+	int n = 0;
+	int c, s;
+
+	offsets[n++] = STATE_OFFSET(OPN->P_CH);
+	for (c = 0; c < ch_count; c++)
+	{
+		for (s = 0; s < 4; s++)
+			offsets[n++] = STATE_OFFSET(CH[c].SLOT[s].DT);
+		offsets[n++] = STATE_OFFSET(CH[c].connect1);
+		offsets[n++] = STATE_OFFSET(CH[c].connect3);
+		offsets[n++] = STATE_OFFSET(CH[c].connect2);
+		offsets[n++] = STATE_OFFSET(CH[c].connect4);
+		offsets[n++] = STATE_OFFSET(CH[c].mem_connect);
+	}
+	return n;
+}
+
 #endif /* BUILD_OPN */
 
 #if BUILD_OPN_PRESCALER
@@ -2373,6 +2402,28 @@ void ym2203_set_mutemask(void *chip, UINT32 MuteMask)
 	
 	return;
 }
+
+int ym2203_state_size(void)
+{
+	return sizeof(YM2203);
+}
+
+int ym2203_state_ptrs(void *chip, int *offsets)
+{
+	YM2203 *F2203 = (YM2203 *)chip;
+	
+	return OPN_state_ptrs(&F2203->OPN, F2203->CH, 3, (char *)F2203, offsets);
+}
+
+int ym2203_state_kept(void *chip, int *offsets)
+{
+	YM2203 *F2203 = (YM2203 *)chip;
+	char *base = (char *)F2203;
+	
+	offsets[0] = STATE_OFFSET(F2203->OPN.ST.param);
+	offsets[1] = STATE_OFFSET(F2203->OPN.ST.SSG);
+	return 2;
+}
 #endif /* BUILD_YM2203 */
 
 
@@ -2452,7 +2503,7 @@ static const int step_inc[8] = { -1*16, -1*16, -1*16, -1*16, 2*16, 5*16, 7*16, 9
 static int jedi_table[ 49*16 ];
 
 
-static void Init_ADPCMATable(void)
+static void build_ADPCMATable(void)
 {
 	int step, nib;
 
@@ -2467,6 +2518,13 @@ static void Init_ADPCMATable(void)
 	}
 }
 
+static int jedi_table_built = 0;
+
+static void Init_ADPCMATable(void)
+{
+	mame_init_once( &jedi_table_built, build_ADPCMATable );
+}
+
 /* ADPCM A (Non control type) : calculate one channel output */
 INLINE void ADPCMA_calc_chan( YM2610 *F2610, ADPCM_CH *ch )
 {
@@ -2678,6 +2736,34 @@ static void FMsave_state_adpcma(const device_config *device,ADPCM_CH *adpcm)
 }
 #endif /* _STATE_H */
 
+/* YM2608 and YM2610 share state layout */
+static int YM2610_state_ptrs(YM2610 *F2610, int *offsets)
+{
+	char *base = (char *)F2610;
+	int n = OPN_state_ptrs(&F2610->OPN, F2610->CH, 6, base, offsets);
+	int c;
+
+	for (c = 0; c < 6; c++)
+		offsets[n++] = STATE_OFFSET(F2610->adpcm[c].pan);
+	offsets[n++] = STATE_OFFSET(F2610->deltaT.output_pointer);
+	offsets[n++] = STATE_OFFSET(F2610->deltaT.pan);
+	offsets[n++] = STATE_OFFSET(F2610->deltaT.status_change_which_chip);
+	return n;
+}
+
+/* ADPCM-A and Delta-T ROMs are owned by the chip, and YM2608's built-in
+   ADPCM-A ROM is static */
+static int YM2610_state_kept(YM2610 *F2610, int *offsets)
+{
+	char *base = (char *)F2610;
+
+	offsets[0] = STATE_OFFSET(F2610->OPN.ST.param);
+	offsets[1] = STATE_OFFSET(F2610->OPN.ST.SSG);
+	offsets[2] = STATE_OFFSET(F2610->pcmbuf);
+	offsets[3] = STATE_OFFSET(F2610->deltaT.memory);
+	return 4;
+}
+
 #endif /* (BUILD_YM2608||BUILD_YM2610||BUILD_YM2610B) */
 
 
@@ -3809,6 +3895,21 @@ void ym2608_set_mutemask(void *chip, UINT32 MuteMask)
 	
 	return;
 }
+
+int ym2608_state_size(void)
+{
+	return sizeof(YM2608);
+}
+
+int ym2608_state_ptrs(void *chip, int *offsets)
+{
+	return YM2610_state_ptrs((YM2608 *)chip, offsets);
+}
+
+int ym2608_state_kept(void *chip, int *offsets)
+{
+	return YM2610_state_kept((YM2608 *)chip, offsets);
+}
 #endif /* BUILD_YM2608 */
 
 
@@ -4498,4 +4599,19 @@ void ym2610_set_mutemask(void *chip, UINT32 MuteMask)
 	
 	return;
 }
+
+int ym2610_state_size(void)
+{
+	return sizeof(YM2610);
+}
+
+int ym2610_state_ptrs(void *chip, int *offsets)
+{
+	return YM2610_state_ptrs((YM2610 *)chip, offsets);
+}
+
+int ym2610_state_kept(void *chip, int *offsets)
+{
+	return YM2610_state_kept((YM2610 *)chip, offsets);
+}
 #endif /* (BUILD_YM2610||BUILD_YM2610B) */
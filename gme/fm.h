@@ -114,6 +114,18 @@ int ym2203_timer_over(void *chip, int c);
 void ym2203_postload(void *chip);
 
 void ym2203_set_mutemask(void *chip, UINT32 MuteMask);
+
+/*
+** State copying: size of the chip's block, and byte offsets within it of
+** pointers into the block, which must be relocated, and of pointers the
+** chip or its owner set up, which must be kept. Offsets are in increasing
+** order; returns count.
+*/
+#define YM2203_STATE_PTRS (1 + 3*9)
+#define YM2203_STATE_KEPT 2
+int ym2203_state_size(void);
+int ym2203_state_ptrs(void *chip, int *offsets);
+int ym2203_state_kept(void *chip, int *offsets);
 #endif /* BUILD_YM2203 */
 
 #if BUILD_YM2608
@@ -132,6 +144,13 @@ void ym2608_write_pcmrom(void *chip, UINT8 rom_id, offs_t ROMSize, offs_t DataSt
 	offs_t DataLength, const UINT8* ROMData);
 
 void ym2608_set_mutemask(void *chip, UINT32 MuteMask);
+
+/* state copying, as for YM2203 */
+#define YM2608_STATE_PTRS (1 + 6*9 + 6 + 3)
+#define YM2608_STATE_KEPT 4
+int ym2608_state_size(void);
+int ym2608_state_ptrs(void *chip, int *offsets);
+int ym2608_state_kept(void *chip, int *offsets);
 #endif /* BUILD_YM2608 */
 
 #if (BUILD_YM2610||BUILD_YM2610B)
@@ -156,6 +175,13 @@ void ym2610_write_pcmrom(void *chip, UINT8 rom_id, offs_t ROMSize, offs_t DataSt
 	offs_t DataLength, const UINT8* ROMData);
 
 void ym2610_set_mutemask(void *chip, UINT32 MuteMask);
+
+/* state copying, as for YM2203 */
+#define YM2610_STATE_PTRS (1 + 6*9 + 6 + 3)
+#define YM2610_STATE_KEPT 4
+int ym2610_state_size(void);
+int ym2610_state_ptrs(void *chip, int *offsets);
+int ym2610_state_kept(void *chip, int *offsets);
 #endif /* (BUILD_YM2610||BUILD_YM2610B) */
 
 #if (BUILD_YM2612||BUILD_YM3438)
@@ -171,6 +197,15 @@ unsigned char ym2612_read(void *chip,int a);
 
 void ym2612_set_mutemask(void *chip, UINT32 MuteMask);
 void ym2612_setoptions(void *chip, UINT8 Flags);
+
+/* size of the block returned by ym2612_init(); it can be copied to save state */
+int ym2612_state_size(void);
+
+/* byte offsets of pointers within that block, in increasing order, so they can
+be relocated when state is loaded into another chip; returns count, at most
+YM2612_STATE_PTRS */
+#define YM2612_STATE_PTRS 55
+int ym2612_state_ptrs(void *chip, int *offsets);
 #endif /* (BUILD_YM2612||BUILD_YM3438) */
 
 #ifdef __cplusplus
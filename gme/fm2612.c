@@ -2099,7 +2099,7 @@ static void reset_channels( FM_ST *ST , FM_CH *CH , int num )
 }
 
 /* initialize generic tables */
-static void init_tables(void)
+static void build_tables(void)
 {
 	signed int i,x;
 	signed int n;
@@ -2202,6 +2202,14 @@ static void init_tables(void)
 #endif
 }
 
+/* tables are built when first chip is created, then shared by all chips */
+static int tables_built = 0;
+
+static void init_tables(void)
+{
+	mame_init_once( &tables_built, build_tables );
+}
+
 #endif /* BUILD_OPN */
 
 #if (BUILD_YM2612||BUILD_YM3438)
@@ -2624,6 +2632,32 @@ void ym2612_set_mutemask(void *chip, UINT32 MuteMask)
 	return;
 }
 
+int ym2612_state_size(void)
+{
+	return sizeof(YM2612);
+}
+
+int ym2612_state_ptrs(void *chip, int *offsets)
+{
+	YM2612 *F2612 = (YM2612 *)chip;
+	int n = 0;
+	int c, s;
+
+	offsets[n++] = (int)((char *)&F2612->OPN.P_CH - (char *)F2612);
+	for (c = 0; c < 6; c++)
+	{
+		FM_CH *CH = &F2612->CH[c];
+		for (s = 0; s < 4; s++)
+			offsets[n++] = (int)((char *)&CH->SLOT[s].DT - (char *)F2612);
+		offsets[n++] = (int)((char *)&CH->connect1    - (char *)F2612);
+		offsets[n++] = (int)((char *)&CH->connect3    - (char *)F2612);
+		offsets[n++] = (int)((char *)&CH->connect2    - (char *)F2612);
+		offsets[n++] = (int)((char *)&CH->connect4    - (char *)F2612);
+		offsets[n++] = (int)((char *)&CH->mem_connect - (char *)F2612);
+	}
+	return n;
+}
+
 void ym2612_setoptions(void *chip, UINT8 Flags)
 {
 	YM2612 *F2612 = (YM2612 *)chip;
@@ -1151,7 +1151,7 @@ INLINE void OPL_CALC_RH( FM_OPL *OPL, OPL_CH *CH, unsigned int noise )
 
 
 /* generic table initialize */
-static int init_tables(void)
+static void build_tables(void)
 {
 	signed int i,x;
 	signed int n;
@@ -1253,8 +1253,14 @@ static int init_tables(void)
 #ifdef SAVE_SAMPLE
 	sample[0]=fopen("sampsum.pcm","wb");
 #endif
+}
 
-	return 1;
+/* tables are built when first chip is created, then shared by all chips
+(initialization of a local static is thread-safe in C++11) */
+static int init_tables(void)
+{
+	static int const built = (build_tables(), 1);
+	return built;
 }
 
 static void OPLCloseTable( void )
@@ -2035,6 +2041,35 @@ static void OPLDestroy(FM_OPL *OPL)
 	free(OPL);
 }
 
+int opl_state_ptrs(void *chip, int *offsets)
+{
+	FM_OPL *OPL = (FM_OPL *)chip;
+	int n = 0;
+	int c, s;
+
+	for (c = 0; c < 9; c++)
+		for (s = 0; s < 2; s++)
+			offsets[n++] = (int)((char *)&OPL->P_CH[c].SLOT[s].connect1 - (char *)OPL);
+#if BUILD_Y8950
+	offsets[n++] = (int)((char *)&OPL->deltat  - (char *)OPL);
+#endif
+	offsets[n++] = (int)((char *)&OPL->SLOT7_1 - (char *)OPL);
+	offsets[n++] = (int)((char *)&OPL->SLOT7_2 - (char *)OPL);
+	offsets[n++] = (int)((char *)&OPL->SLOT8_1 - (char *)OPL);
+	offsets[n++] = (int)((char *)&OPL->SLOT8_2 - (char *)OPL);
+#if BUILD_Y8950
+	if (OPL->deltat)
+	{
+		YM_DELTAT *DELTAT = OPL->deltat;
+		offsets[n++] = (int)((char *)&DELTAT->memory                   - (char *)OPL);
+		offsets[n++] = (int)((char *)&DELTAT->output_pointer           - (char *)OPL);
+		offsets[n++] = (int)((char *)&DELTAT->pan                      - (char *)OPL);
+		offsets[n++] = (int)((char *)&DELTAT->status_change_which_chip - (char *)OPL);
+	}
+#endif
+	return n;
+}
+
 /* Optional handlers */
 
 /*static void OPLSetTimerHandler(FM_OPL *OPL,OPL_TIMERHANDLER timer_handler,void *param)
@@ -2194,6 +2229,10 @@ void ym3812_shutdown(void *chip)
 	/* emulator shutdown */
 	OPLDestroy(YM3812);
 }
+int ym3812_state_size(void)
+{
+	return sizeof(FM_OPL);
+}
 void ym3812_reset_chip(void *chip)
 {
 	FM_OPL *YM3812 = (FM_OPL *)chip;
@@ -2326,6 +2365,10 @@ void ym3526_shutdown(void *chip)
 	/* emulator shutdown */
 	OPLDestroy(YM3526);
 }
+int ym3526_state_size(void)
+{
+	return sizeof(FM_OPL);
+}
 void ym3526_reset_chip(void *chip)
 {
 	FM_OPL *YM3526 = (FM_OPL *)chip;
@@ -2480,6 +2523,10 @@ void y8950_shutdown(void *chip)
 	/* emulator shutdown */
 	OPLDestroy(Y8950);
 }
+int y8950_state_size(void)
+{
+	return sizeof(FM_OPL) + sizeof(YM_DELTAT);
+}
 void y8950_reset_chip(void *chip)
 {
 	FM_OPL *Y8950 = (FM_OPL *)chip;
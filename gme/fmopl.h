@@ -38,6 +38,12 @@ typedef INT8 OPLSAMPLE;
 //typedef void (*OPL_TIMERHANDLER)(void *param,int timer,attotime period);
 typedef void (*OPL_IRQHANDLER)(void *param,int irq);
 typedef void (*OPL_UPDATEHANDLER)(void *param,int min_interval_us);
+
+/* byte offsets of pointers within block of any chip below, whose size is given
+by its *_state_size(), in increasing order, so they can be relocated when state
+is loaded into another chip; returns count, at most OPL_STATE_PTRS */
+#define OPL_STATE_PTRS 27
+int opl_state_ptrs(void *chip, int *offsets);
 typedef void (*OPL_PORTHANDLER_W)(void *param,unsigned char data);
 typedef unsigned char (*OPL_PORTHANDLER_R)(void *param);
 
@@ -46,6 +52,7 @@ typedef unsigned char (*OPL_PORTHANDLER_R)(void *param);
 
 void *ym3812_init(UINT32 clock, UINT32 rate);
 void ym3812_shutdown(void *chip);
+int  ym3812_state_size(void);
 void ym3812_reset_chip(void *chip);
 int  ym3812_write(void *chip, int a, int v);
 unsigned char ym3812_read(void *chip, int a);
@@ -71,6 +78,7 @@ void ym3812_set_update_handler(void *chip, OPL_UPDATEHANDLER UpdateHandler, void
 void *ym3526_init(UINT32 clock, UINT32 rate);
 /* shutdown the YM3526 emulators*/
 void ym3526_shutdown(void *chip);
+int  ym3526_state_size(void);
 void ym3526_reset_chip(void *chip);
 int  ym3526_write(void *chip, int a, int v);
 unsigned char ym3526_read(void *chip, int a);
@@ -100,6 +108,7 @@ void y8950_set_delta_t_memory(void *chip, void * deltat_mem_ptr, int deltat_mem_
 
 void * y8950_init(UINT32 clock, UINT32 rate);
 void y8950_shutdown(void *chip);
+int  y8950_state_size(void);
 void y8950_reset_chip(void *chip);
 int  y8950_write(void *chip, int a, int v);
 unsigned char y8950_read (void *chip, int a);
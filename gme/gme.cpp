@@ -212,6 +212,24 @@ Music_Emu* gme_new_emu( gme_type_t type, int rate )
 	return NULL;
 }
 
+Music_Emu* gme_new_emu_voices( gme_type_t type, int rate )
+{
+	if ( type && rate != gme_info_only )
+	{
+		Music_Emu* gme = type->new_emu();
+		if ( gme )
+		{
+			if ( !gme->separate_voices_() && !gme->set_sample_rate( rate ) )
+			{
+				check( gme->type() == type );
+				return gme;
+			}
+			delete gme;
+		}
+	}
+	return NULL;
+}
+
 gme_err_t gme_load_file( Music_Emu* gme, const char path [] ) { return gme->load_file( path ); }
 
 gme_err_t gme_load_data( Music_Emu* gme, void const* data, long size )
@@ -351,16 +369,40 @@ void      gme_set_user_cleanup(Music_Emu* gme, gme_user_cleanup_t func ){ gme->s
 
 gme_err_t gme_start_track    ( Music_Emu* gme, int index )              { return gme->start_track( index ); }
 gme_err_t gme_play           ( Music_Emu* gme, int n, short p [] )      { return gme->play( n, p ); }
+gme_err_t gme_play_s32       ( Music_Emu* gme, int n, int p [] )        { return gme->play( n, p ); }
+
+gme_err_t gme_play_f32( Music_Emu* gme, int n, float out [] )
+{
+	// play in chunks into local buffer, then convert into out
+	float const scale = 1.0f / 32768;
+	int buf [1024];
+	for ( int pos = 0; pos < n; )
+	{
+		int count = min( n - pos, (int) (sizeof buf / sizeof *buf) );
+		RETURN_ERR( gme->play( count, buf ) );
+		for ( int i = 0; i < count; i++ )
+			out [pos + i] = buf [i] * scale;
+		pos += count;
+	}
+	return blargg_ok;
+}
 void      gme_set_fade       ( Music_Emu* gme, int start_msec, int length_msec ) { gme->set_fade( start_msec, length_msec ); }
 gme_bool  gme_track_ended    ( Music_Emu const* gme )                   { return gme->track_ended(); }
 int       gme_tell           ( Music_Emu const* gme )                   { return gme->tell(); }
 gme_err_t gme_seek           ( Music_Emu* gme, int msec )               { return gme->seek( msec ); }
 gme_err_t gme_skip           ( Music_Emu* gme, int samples )            { return gme->skip( samples ); }
+void      gme_set_checkpoint_interval( Music_Emu* gme, int msec )       { gme->set_checkpoint_interval( msec ); }
+int       gme_state_size     ( Music_Emu* gme )                         { return gme->state_size(); }
+gme_err_t gme_save_state     ( Music_Emu* gme, void* out, int size, int* size_out ) { return gme->save_state( out, size, size_out ); }
+gme_err_t gme_load_state     ( Music_Emu* gme, void const* in, int size ) { return gme->load_state( in, size ); }
 int       gme_voice_count    ( Music_Emu const* gme )                   { return gme->voice_count(); }
 void      gme_ignore_silence ( Music_Emu* gme, gme_bool disable )       { gme->ignore_silence( disable != 0 ); }
 void      gme_set_tempo      ( Music_Emu* gme, double t )               { gme->set_tempo( t ); }
+void      gme_set_quality    ( Music_Emu* gme, int level )              { gme->set_quality( level ); }
+void      gme_set_frame_length( Music_Emu* gme, int msec )              { gme->set_frame_length( msec ); }
 void      gme_mute_voice     ( Music_Emu* gme, int index, gme_bool mute ){ gme->mute_voice( index, mute != 0 ); }
 void      gme_mute_voices    ( Music_Emu* gme, int mask )               { gme->mute_voices( mask ); }
+gme_err_t gme_play_voices    ( Music_Emu* gme, int n, short p [], short* const v [] ) { return gme->play_voices( n, p, v ); }
 void      gme_set_equalizer  ( Music_Emu* gme, gme_equalizer_t const* eq ) { gme->set_equalizer( *eq ); }
 void      gme_equalizer      ( Music_Emu const* gme, gme_equalizer_t* o )  { *o = gme->equalizer(); }
 const char* gme_voice_name   ( Music_Emu const* gme, int i )            { return gme->voice_name( i ); }
@@ -424,6 +466,51 @@ void gme_set_stereo_depth( Music_Emu* gme, double depth )
 	#endif
 }
 
+gme_err_t gme_get_profile( Music_Emu const* gme, gme_profile_t* out )
+{
+	memset( out, 0, sizeof *out );
+	
+	#if GME_PROFILE
+	{
+		BLARGG_STATIC_ASSERT( (int) Gme_Profiler::stage_count == (int) gme_profile_stage_count );
+		BLARGG_STATIC_ASSERT( (int) Gme_Profiler::chip_count <= (int) gme_profile_max_chips );
+		
+		Gme_Profiler const& p = gme->profiler;
+		for ( int i = 0; i < Gme_Profiler::stage_count; i++ )
+		{
+			gme_profile_counter_t& c = out->stages [i];
+			c.name  = Gme_Profiler::stage_names [i];
+			c.nsec  = (double) p.stages [i].nsec;
+			c.calls = p.stages [i].calls;
+		}
+		
+		for ( int i = 0; i < Gme_Profiler::chip_count; i++ )
+		{
+			if ( p.chips [i].calls )
+			{
+				gme_profile_counter_t& c = out->chips [out->chip_count++];
+				c.name  = Gme_Profiler::chip_names [i];
+				c.nsec  = (double) p.chips [i].nsec;
+				c.calls = p.chips [i].calls;
+			}
+		}
+		return blargg_ok;
+	}
+	#else
+		(void) gme;
+		return BLARGG_ERR( BLARGG_ERR_LIMITATION, "library built without GME_PROFILE" );
+	#endif
+}
+
+void gme_reset_profile( Music_Emu* gme )
+{
+	#if GME_PROFILE
+		gme->profiler.reset();
+	#else
+		(void) gme;
+	#endif
+}
+
 #define ENTRY( name ) { blargg_err_##name, gme_err_##name }
 static blargg_err_to_code_t const gme_codes [] =
 {
@@ -36,6 +36,17 @@ gme_err_t gme_start_track( gme_t*, int index );
 must be even. */
 gme_err_t gme_play( gme_t*, int count, short out [] );
 
+/* Same as gme_play(), but generates 32-bit samples that aren't clamped to 16 bits,
+so loud mixes keep their peaks. Full scale is still -32768 to 32767. Limitation:
+SPC, SFM, GYM, and VGM with FM sound clamp to 16 bits internally (SPC/SFM in the
+DSP and its output filter, GYM/VGM where FM chips are mixed and resampled), so for
+them this gives gme_play() samples widened to 32 bits, with the same clipping. */
+gme_err_t gme_play_s32( gme_t*, int count, int out [] );
+
+/* Same as gme_play_s32(), but generates float samples where full scale is -1.0
+to 1.0. Samples can exceed that range. */
+gme_err_t gme_play_f32( gme_t*, int count, float out [] );
+
 /* Closes file and frees memory. OK to pass NULL. */
 void gme_delete( gme_t* );
 
@@ -52,12 +63,35 @@ gme_bool gme_track_ended( const gme_t* );
 /* Number of milliseconds played since beginning of track (1000 = one second) */
 int gme_tell( const gme_t* );
 
-/* Seeks to new time in track. Seeking backwards or far forward can take a while. */
+/* Seeks to new time in track. Seeking backwards or far forward can take a while,
+unless checkpoints are enabled. */
 gme_err_t gme_seek( gme_t*, int msec );
 
+/* Records emulator state every msec milliseconds of playback, so that seeking
+backwards resumes from the nearest earlier checkpoint instead of restarting track.
+Uses memory for each checkpoint (about 75K for SPC). 0 disables and frees checkpoints.
+Has no effect on types that don't support saving state. */
+void gme_set_checkpoint_interval( gme_t*, int msec );
+
 /* Skips the specified number of samples. */
 gme_err_t gme_skip( gme_t*, int samples );
 
+/* Size of buffer needed to save state of current track, or 0 if emulator type doesn't
+support saving state or no track has been started. */
+int gme_state_size( gme_t* );
+
+/* Saves current emulator state into out, which has room for size bytes, and sets
+*size_out to the number of bytes used (unless it's NULL). State can be loaded into any
+gme_t in this process with the same file, track, tempo, and sample rate; it can't be kept
+in a file, since its layout depends on the build. Muting, equalization, and effects are
+not part of state, so they can be changed between loads to compare settings. */
+gme_err_t gme_save_state( gme_t*, void* out, int size, int* size_out );
+
+/* Restores state saved by gme_save_state(), including current time in track. If state
+is for a different file, track, tempo, or sample rate, returns error and leaves emulator
+unchanged. */
+gme_err_t gme_load_state( gme_t*, void const* in, int size );
+
 
 /******** Informational ********/
 
@@ -122,6 +156,27 @@ void gme_ignore_silence( gme_t*, gme_bool ignore );
 Track length as returned by track_info() ignores tempo (assumes it's 1.0). */
 void gme_set_tempo( gme_t*, double tempo );
 
+/* Limits amount of sound emulated at once to msec milliseconds, or 0 for the
+default of emulating as much as the internal sound buffer holds (50 msec).
+Smaller values, such as 5 or 10, spread CPU use evenly across gme_play() calls
+and let muting, tempo, and equalizer changes be heard sooner, at some cost in
+throughput (see gme.txt). Has no effect on SPC, which only emulates as much as
+is asked for, or on GYM and VGM with FM sound, which use their own frames. */
+void gme_set_frame_length( gme_t*, int msec );
+
+/* Sound synthesis quality levels, for gme_set_quality() */
+enum gme_quality_t
+{
+	gme_quality_fast = 0, /* Linear interpolation; faster, but allows some aliasing */
+	gme_quality_full = 1  /* Band-limited synthesis (default) */
+};
+
+/* Sets sound synthesis quality of emulators whose sound chips use Blip_Buffer
+(everything but SPC and the FM chips of GYM and VGM). For SPC and SFM, selects a
+narrower, faster resampling filter when sample rate isn't 32000 Hz. Can be changed
+at any time; SPC/SFM saved state only loads back at the same quality. */
+void gme_set_quality( gme_t*, int level );
+
 /* Number of voices used by currently loaded file */
 int gme_voice_count( const gme_t* );
 
@@ -135,6 +190,14 @@ void gme_mute_voice( gme_t*, int index, gme_bool mute );
 voices, 0 unmutes them all, 0x01 mutes just the first voice, etc. */
 void gme_mute_voices( gme_t*, int muting_mask );
 
+/* Same as gme_play(), but also writes each voice's own stereo samples to
+voice_out[i], for i from 0 to gme_voice_count() - 1, skipping any that are NULL,
+so that all voices are separated in a single pass. Each voice_out[i] must have room
+for count samples. Voices have no fade, effects, or stereo depth applied. Emulator
+must be created with gme_new_emu_voices(), and silence must be ignored (before
+starting track) and no fade set; otherwise returns error. */
+gme_err_t gme_play_voices( gme_t*, int count, short out [], short* const voice_out [] );
+
 /* Frequency equalizer parameters (see gme.txt) */
 typedef struct gme_equalizer_t
 {
@@ -181,6 +244,52 @@ void gme_set_effects( gme_t*, gme_effects_t const* );
 void gme_effects( const gme_t*, gme_effects_t* out );
 
 
+/******** Profiling ********/
+
+/* Time spent generating sound, broken down by stage. Only available if library
+was built with GME_PROFILE defined (see blargg_config.h). Times of a stage don't
+include time spent in other stages it uses, so for example the emulate time of a
+VGM file doesn't include its sound chips, which are listed separately. */
+
+/* Stages of sound generation */
+enum gme_profile_stage_t
+{
+	gme_profile_emulate  = 0, /* CPU and sound chip emulation, including synthesis */
+	gme_profile_buffer   = 1, /* Ending frames in and reading from sound buffers, mixing */
+	gme_profile_effects  = 2, /* Echo and stereo effects (see gme_set_effects()) */
+	gme_profile_resample = 3, /* Sample rate conversion of SPC, GYM, and VGM with FM */
+	gme_profile_filter   = 4, /* SPC output filter */
+	gme_profile_track    = 5, /* Silence detection, fading, and everything else */
+	gme_profile_stage_count = 6
+};
+
+typedef struct gme_profile_counter_t
+{
+	const char* name; /* Name of stage or sound chip, or NULL if unused */
+	double nsec;      /* Nanoseconds spent */
+	long calls;       /* Number of times stage or chip was run */
+} gme_profile_counter_t;
+
+enum { gme_profile_max_chips = 32 };
+
+typedef struct gme_profile_t
+{
+	gme_profile_counter_t stages [gme_profile_stage_count]; /* Indexed by gme_profile_stage_t */
+	gme_profile_counter_t chips [gme_profile_max_chips];    /* VGM sound chips that have been run */
+	int chip_count;
+	
+	int i1,i2,i3,i4,i5,i6,i7; /* reserved */
+} gme_profile_t;
+
+/* Passes back time spent generating sound since emulator was created or
+gme_reset_profile() was last called. Returns error if library was built without
+GME_PROFILE. */
+gme_err_t gme_get_profile( const gme_t*, gme_profile_t* out );
+
+/* Clears times passed back by gme_get_profile() */
+void gme_reset_profile( gme_t* );
+
+
 /******** Game music types ********/
 
 /* Music file type identifier. Can also hold NULL. */
@@ -224,6 +333,11 @@ gme_err_t gme_identify_file( const char path [], gme_type_t* type_out );
 track information, pass gme_info_only for sample_rate. */
 gme_t* gme_new_emu( gme_type_t, int sample_rate );
 
+/* Same as gme_new_emu(), but emulator keeps each voice separate for
+gme_play_voices(), at some cost in speed and memory, and has no effects processor.
+Returns NULL if out of memory or type can't separate its voices (GYM). */
+gme_t* gme_new_emu_voices( gme_type_t, int sample_rate );
+
 /* Loads music file into emulator */
 gme_err_t gme_load_file( gme_t*, const char path [] );
 
@@ -5,6 +5,10 @@
 #include "blargg_endian.h"
 #include <string.h>
 
+#if BLARGG_SSE2
+	#include <emmintrin.h>
+#endif
+
 /* Copyright (C) 2007 Shay Green. This module is free software; you
 can redistribute it and/or modify it under the terms of the GNU Lesser
 General Public License as published by the Free Software Foundation; either
@@ -70,30 +74,38 @@ static BOOST::uint8_t const initial_regs [SPC_DSP::register_count] =
 
 #define WRITE_SAMPLES( l, r, out ) \
 {\
-	if ( out >= m.out_end )\
-	{\
-		int count = sample_count();\
-		m.out_begin = (SPC_DSP::sample_t *) realloc( m.out_begin, (count ? count * 2 : 8192) * sizeof(SPC_DSP::sample_t) );\
-		out = m.out_begin + count;\
-		m.out_end = m.out_begin + count * 2;\
-	}\
 	out [0] = l;\
 	out [1] = r;\
 	out += 2;\
+	if ( out >= m.out_end )\
+	{\
+		check( out == m.out_end );\
+		check( m.out_end != &m.extra [extra_size] || \
+			(m.extra <= m.out_begin && m.extra < &m.extra [extra_size]) );\
+		out       = m.extra;\
+		m.out_end = &m.extra [extra_size];\
+	}\
 }\
 
 void SPC_DSP::set_output( sample_t* out, int size )
 {
 	require( (size & 1) == 0 ); // must be even
-	if ( !out )
+	if ( !out || !size )
 	{
-		size = 0;
+		out  = m.extra;
+		size = extra_size;
 	}
 	m.out_begin = out;
 	m.out       = out;
 	m.out_end   = out + size;
 }
 
+void SPC_DSP::set_voice_output( sample_t* const out [] )
+{
+	for ( int i = 0; i < voice_count; i++ )
+		m.voice_out [i] = (out ? out [i] : NULL);
+}
+
 // Volume registers and efb are signed! Easy to forget int8_t cast.
 // Prefixes are to avoid accidental use of locals with same names.
 
@@ -135,42 +147,140 @@ static short const gauss [512] =
 1299,1300,1300,1301,1302,1302,1303,1303,1303,1304,1304,1304,1304,1304,1305,1305,
 };
 
-static short const cubic [514] =
+// Cubic and sinc interpolation tables hold the taps for each of the 256
+// fractional positions together, in the order of the input samples they
+// multiply, so they can be read with a single load
+
+static short const cubic [1024] =
 {
-   0,  -4,  -8, -12, -16, -20, -23, -27, -30, -34, -37, -41, -44, -47, -50, -53,
- -56, -59, -62, -65, -68, -71, -73, -76, -78, -81, -84, -87, -89, -91, -93, -95,
- -98,-100,-102,-104,-106,-109,-110,-112,-113,-116,-117,-119,-121,-122,-123,-125,
--126,-128,-129,-131,-132,-134,-134,-136,-136,-138,-138,-140,-141,-141,-142,-143,
--144,-144,-145,-146,-147,-148,-147,-148,-148,-149,-149,-150,-150,-150,-150,-151,
--151,-151,-151,-151,-152,-152,-151,-152,-151,-152,-151,-151,-151,-151,-150,-150,
--150,-149,-149,-149,-149,-148,-147,-147,-146,-146,-145,-145,-144,-144,-143,-142,
--141,-141,-140,-139,-139,-138,-137,-136,-135,-135,-133,-133,-132,-131,-130,-129,
--128,-127,-126,-125,-124,-123,-121,-121,-119,-118,-117,-116,-115,-114,-112,-111,
--110,-109,-107,-106,-105,-104,-102,-102,-100, -99, -97, -97, -95, -94, -92, -91,
- -90, -88, -87, -86, -85, -84, -82, -81, -79, -78, -76, -76, -74, -73, -71, -70,
- -68, -67, -66, -65, -63, -62, -60, -60, -58, -57, -55, -55, -53, -52, -50, -49,
- -48, -46, -45, -44, -43, -42, -40, -39, -38, -37, -36, -35, -34, -32, -31, -30,
- -29, -28, -27, -26, -25, -24, -23, -22, -21, -20, -19, -19, -17, -16, -15, -14,
- -14, -13, -12, -11, -11, -10,  -9,  -9,  -8,  -8,  -7,  -7,  -6,  -5,  -4,  -4,
-  -3,  -3,  -3,  -2,  -2,  -2,  -1,  -1,   0,  -1,   0,  -1,   0,   0,   0,   0,
-   0,
-2048,2048,2048,2048,2047,2047,2046,2045,2043,2042,2041,2039,2037,2035,2033,2031,
-2028,2026,2024,2021,2018,2015,2012,2009,2005,2002,1999,1995,1991,1987,1982,1978,
-1974,1969,1965,1960,1955,1951,1946,1940,1934,1929,1924,1918,1912,1906,1900,1895,
-1888,1882,1875,1869,1862,1856,1849,1842,1835,1828,1821,1814,1806,1799,1791,1783,
-1776,1768,1760,1753,1744,1737,1728,1720,1711,1703,1695,1686,1677,1668,1659,1651,
-1641,1633,1623,1614,1605,1596,1587,1577,1567,1559,1549,1539,1529,1520,1510,1499,
-1490,1480,1470,1460,1450,1440,1430,1420,1408,1398,1389,1378,1367,1357,1346,1336,
-1325,1315,1304,1293,1282,1272,1261,1250,1239,1229,1218,1207,1196,1185,1174,1163,
-1152,1141,1130,1119,1108,1097,1086,1075,1063,1052,1042,1030,1019,1008, 997, 986,
- 974, 964, 952, 941, 930, 919, 908, 897, 886, 875, 864, 853, 842, 831, 820, 809,
- 798, 787, 776, 765, 754, 744, 733, 722, 711, 700, 690, 679, 668, 658, 647, 637,
- 626, 616, 605, 595, 584, 574, 564, 554, 543, 534, 524, 514, 503, 494, 483, 473,
- 464, 454, 444, 435, 425, 416, 407, 397, 387, 378, 370, 360, 351, 342, 333, 325,
- 315, 307, 298, 290, 281, 273, 265, 256, 248, 241, 233, 225, 216, 209, 201, 193,
- 186, 178, 171, 164, 157, 150, 143, 137, 129, 123, 117, 110, 103,  97,  91,  85,
-  79,  74,  68,  62,  56,  51,  46,  41,  35,  31,  27,  22,  17,  13,   8,   4,
-   0
+    0, 2048,    0,    0,   -4, 2048,    4,    0,
+   -8, 2048,    8,    0,  -12, 2048,   13,    0,
+  -16, 2047,   17,    0,  -20, 2047,   22,   -1,
+  -23, 2046,   27,    0,  -27, 2045,   31,   -1,
+  -30, 2043,   35,    0,  -34, 2042,   41,   -1,
+  -37, 2041,   46,   -1,  -41, 2039,   51,   -2,
+  -44, 2037,   56,   -2,  -47, 2035,   62,   -2,
+  -50, 2033,   68,   -3,  -53, 2031,   74,   -3,
+  -56, 2028,   79,   -3,  -59, 2026,   85,   -4,
+  -62, 2024,   91,   -4,  -65, 2021,   97,   -5,
+  -68, 2018,  103,   -6,  -71, 2015,  110,   -7,
+  -73, 2012,  117,   -7,  -76, 2009,  123,   -8,
+  -78, 2005,  129,   -8,  -81, 2002,  137,   -9,
+  -84, 1999,  143,   -9,  -87, 1995,  150,  -10,
+  -89, 1991,  157,  -11,  -91, 1987,  164,  -11,
+  -93, 1982,  171,  -12,  -95, 1978,  178,  -13,
+  -98, 1974,  186,  -14, -100, 1969,  193,  -14,
+ -102, 1965,  201,  -15, -104, 1960,  209,  -16,
+ -106, 1955,  216,  -17, -109, 1951,  225,  -19,
+ -110, 1946,  233,  -19, -112, 1940,  241,  -20,
+ -113, 1934,  248,  -21, -116, 1929,  256,  -22,
+ -117, 1924,  265,  -23, -119, 1918,  273,  -24,
+ -121, 1912,  281,  -25, -122, 1906,  290,  -26,
+ -123, 1900,  298,  -27, -125, 1895,  307,  -28,
+ -126, 1888,  315,  -29, -128, 1882,  325,  -30,
+ -129, 1875,  333,  -31, -131, 1869,  342,  -32,
+ -132, 1862,  351,  -34, -134, 1856,  360,  -35,
+ -134, 1849,  370,  -36, -136, 1842,  378,  -37,
+ -136, 1835,  387,  -38, -138, 1828,  397,  -39,
+ -138, 1821,  407,  -40, -140, 1814,  416,  -42,
+ -141, 1806,  425,  -43, -141, 1799,  435,  -44,
+ -142, 1791,  444,  -45, -143, 1783,  454,  -46,
+ -144, 1776,  464,  -48, -144, 1768,  473,  -49,
+ -145, 1760,  483,  -50, -146, 1753,  494,  -52,
+ -147, 1744,  503,  -53, -148, 1737,  514,  -55,
+ -147, 1728,  524,  -55, -148, 1720,  534,  -57,
+ -148, 1711,  543,  -58, -149, 1703,  554,  -60,
+ -149, 1695,  564,  -60, -150, 1686,  574,  -62,
+ -150, 1677,  584,  -63, -150, 1668,  595,  -65,
+ -150, 1659,  605,  -66, -151, 1651,  616,  -67,
+ -151, 1641,  626,  -68, -151, 1633,  637,  -70,
+ -151, 1623,  647,  -71, -151, 1614,  658,  -73,
+ -152, 1605,  668,  -74, -152, 1596,  679,  -76,
+ -151, 1587,  690,  -76, -152, 1577,  700,  -78,
+ -151, 1567,  711,  -79, -152, 1559,  722,  -81,
+ -151, 1549,  733,  -82, -151, 1539,  744,  -84,
+ -151, 1529,  754,  -85, -151, 1520,  765,  -86,
+ -150, 1510,  776,  -87, -150, 1499,  787,  -88,
+ -150, 1490,  798,  -90, -149, 1480,  809,  -91,
+ -149, 1470,  820,  -92, -149, 1460,  831,  -94,
+ -149, 1450,  842,  -95, -148, 1440,  853,  -97,
+ -147, 1430,  864,  -97, -147, 1420,  875,  -99,
+ -146, 1408,  886, -100, -146, 1398,  897, -102,
+ -145, 1389,  908, -102, -145, 1378,  919, -104,
+ -144, 1367,  930, -105, -144, 1357,  941, -106,
+ -143, 1346,  952, -107, -142, 1336,  964, -109,
+ -141, 1325,  974, -110, -141, 1315,  986, -111,
+ -140, 1304,  997, -112, -139, 1293, 1008, -114,
+ -139, 1282, 1019, -115, -138, 1272, 1030, -116,
+ -137, 1261, 1042, -117, -136, 1250, 1052, -118,
+ -135, 1239, 1063, -119, -135, 1229, 1075, -121,
+ -133, 1218, 1086, -121, -133, 1207, 1097, -123,
+ -132, 1196, 1108, -124, -131, 1185, 1119, -125,
+ -130, 1174, 1130, -126, -129, 1163, 1141, -127,
+ -128, 1152, 1152, -128, -127, 1141, 1163, -129,
+ -126, 1130, 1174, -130, -125, 1119, 1185, -131,
+ -124, 1108, 1196, -132, -123, 1097, 1207, -133,
+ -121, 1086, 1218, -133, -121, 1075, 1229, -135,
+ -119, 1063, 1239, -135, -118, 1052, 1250, -136,
+ -117, 1042, 1261, -137, -116, 1030, 1272, -138,
+ -115, 1019, 1282, -139, -114, 1008, 1293, -139,
+ -112,  997, 1304, -140, -111,  986, 1315, -141,
+ -110,  974, 1325, -141, -109,  964, 1336, -142,
+ -107,  952, 1346, -143, -106,  941, 1357, -144,
+ -105,  930, 1367, -144, -104,  919, 1378, -145,
+ -102,  908, 1389, -145, -102,  897, 1398, -146,
+ -100,  886, 1408, -146,  -99,  875, 1420, -147,
+  -97,  864, 1430, -147,  -97,  853, 1440, -148,
+  -95,  842, 1450, -149,  -94,  831, 1460, -149,
+  -92,  820, 1470, -149,  -91,  809, 1480, -149,
+  -90,  798, 1490, -150,  -88,  787, 1499, -150,
+  -87,  776, 1510, -150,  -86,  765, 1520, -151,
+  -85,  754, 1529, -151,  -84,  744, 1539, -151,
+  -82,  733, 1549, -151,  -81,  722, 1559, -152,
+  -79,  711, 1567, -151,  -78,  700, 1577, -152,
+  -76,  690, 1587, -151,  -76,  679, 1596, -152,
+  -74,  668, 1605, -152,  -73,  658, 1614, -151,
+  -71,  647, 1623, -151,  -70,  637, 1633, -151,
+  -68,  626, 1641, -151,  -67,  616, 1651, -151,
+  -66,  605, 1659, -150,  -65,  595, 1668, -150,
+  -63,  584, 1677, -150,  -62,  574, 1686, -150,
+  -60,  564, 1695, -149,  -60,  554, 1703, -149,
+  -58,  543, 1711, -148,  -57,  534, 1720, -148,
+  -55,  524, 1728, -147,  -55,  514, 1737, -148,
+  -53,  503, 1744, -147,  -52,  494, 1753, -146,
+  -50,  483, 1760, -145,  -49,  473, 1768, -144,
+  -48,  464, 1776, -144,  -46,  454, 1783, -143,
+  -45,  444, 1791, -142,  -44,  435, 1799, -141,
+  -43,  425, 1806, -141,  -42,  416, 1814, -140,
+  -40,  407, 1821, -138,  -39,  397, 1828, -138,
+  -38,  387, 1835, -136,  -37,  378, 1842, -136,
+  -36,  370, 1849, -134,  -35,  360, 1856, -134,
+  -34,  351, 1862, -132,  -32,  342, 1869, -131,
+  -31,  333, 1875, -129,  -30,  325, 1882, -128,
+  -29,  315, 1888, -126,  -28,  307, 1895, -125,
+  -27,  298, 1900, -123,  -26,  290, 1906, -122,
+  -25,  281, 1912, -121,  -24,  273, 1918, -119,
+  -23,  265, 1924, -117,  -22,  256, 1929, -116,
+  -21,  248, 1934, -113,  -20,  241, 1940, -112,
+  -19,  233, 1946, -110,  -19,  225, 1951, -109,
+  -17,  216, 1955, -106,  -16,  209, 1960, -104,
+  -15,  201, 1965, -102,  -14,  193, 1969, -100,
+  -14,  186, 1974,  -98,  -13,  178, 1978,  -95,
+  -12,  171, 1982,  -93,  -11,  164, 1987,  -91,
+  -11,  157, 1991,  -89,  -10,  150, 1995,  -87,
+   -9,  143, 1999,  -84,   -9,  137, 2002,  -81,
+   -8,  129, 2005,  -78,   -8,  123, 2009,  -76,
+   -7,  117, 2012,  -73,   -7,  110, 2015,  -71,
+   -6,  103, 2018,  -68,   -5,   97, 2021,  -65,
+   -4,   91, 2024,  -62,   -4,   85, 2026,  -59,
+   -3,   79, 2028,  -56,   -3,   74, 2031,  -53,
+   -3,   68, 2033,  -50,   -2,   62, 2035,  -47,
+   -2,   56, 2037,  -44,   -2,   51, 2039,  -41,
+   -1,   46, 2041,  -37,   -1,   41, 2042,  -34,
+    0,   35, 2043,  -30,   -1,   31, 2045,  -27,
+    0,   27, 2046,  -23,   -1,   22, 2047,  -20,
+    0,   17, 2047,  -16,    0,   13, 2048,  -12,
+    0,    8, 2048,   -8,    0,    4, 2048,   -4,
 };
 
 static short const sinc [2048] =
@@ -455,17 +565,25 @@ inline int SPC_DSP::interpolate( voice_t const* v )
 
 inline int SPC_DSP::interpolate_cubic( voice_t const* v )
 {
-        // Make pointers into cubic based on fractional position between samples
-        int offset = v->interp_pos >> 4 & 0xFF;
-        short const* fwd = cubic       + offset;
-        short const* rev = cubic + 256 - offset; // mirror left half of cubic
+        // Make pointer into cubic based on fractional position between samples
+        short const* filt = &cubic [v->interp_pos >> 2 & 0x3FC];
         
         int const* in = &v->buf [(v->interp_pos >> 12) + v->buf_pos];
         int out;
-        out  = fwd [  0] * in [0];
-        out += fwd [257] * in [1];
-        out += rev [257] * in [2];
-        out += rev [  0] * in [3];
+        #if BLARGG_SSE2
+        // Samples are always within int16 range, so packing doesn't saturate
+        // and multiply-add gives the same sums as below
+        __m128i s = _mm_loadu_si128( (__m128i const*) in );
+        s = _mm_madd_epi16( _mm_packs_epi32( s, s ),
+                        _mm_loadl_epi64( (__m128i const*) filt ) );
+        s = _mm_add_epi32( s, _mm_shuffle_epi32( s, 0x55 ) );
+        out = _mm_cvtsi128_si32( s );
+        #else
+        out  = filt [0] * in [0];
+        out += filt [1] * in [1];
+        out += filt [2] * in [2];
+        out += filt [3] * in [3];
+        #endif
         out >>= 11;
         
         CLAMP16( out );
@@ -475,12 +593,19 @@ inline int SPC_DSP::interpolate_cubic( voice_t const* v )
 
 inline int SPC_DSP::interpolate_sinc( voice_t const* v )
 {
-        // Make pointers into cubic based on fractional position between samples
-        int offset = v->interp_pos & 0xFF0;
-        short const* filt = (short const*) (((char const*)sinc) + offset);
+        // Make pointer into sinc based on fractional position between samples
+        short const* filt = &sinc [v->interp_pos >> 1 & 0x7F8];
         
         int const* in = &v->buf [(v->interp_pos >> 12) + v->buf_pos];
         int out;
+        #if BLARGG_SSE2
+        __m128i s = _mm_packs_epi32( _mm_loadu_si128( (__m128i const*) in ),
+                        _mm_loadu_si128( (__m128i const*) (in + 4) ) );
+        s = _mm_madd_epi16( s, _mm_loadu_si128( (__m128i const*) filt ) );
+        s = _mm_add_epi32( s, _mm_shuffle_epi32( s, 0x4E ) );
+        s = _mm_add_epi32( s, _mm_shuffle_epi32( s, 0xB1 ) );
+        out = _mm_cvtsi128_si32( s );
+        #else
         out  = filt [0] * in [0];
         out += filt [1] * in [1];
         out += filt [2] * in [2];
@@ -489,6 +614,7 @@ inline int SPC_DSP::interpolate_sinc( voice_t const* v )
         out += filt [5] * in [5];
         out += filt [6] * in [6];
         out += filt [7] * in [7];
+        #endif
         out >>= 14;
         
         CLAMP16( out );
@@ -655,6 +781,9 @@ inline void SPC_DSP::run_envelope( voice_t* const v )
 
 //// BRR Decoding
 
+// Decoding is only a few operations per sample, less than looking up already
+// decoded blocks would cost. It also reads RAM exactly when the hardware does,
+// so samples changed by SMP or echo writes never need invalidating.
 inline void SPC_DSP::decode_brr( voice_t* v )
 {
 	// Arrange the four input nybbles in 0xABCD order for easy decoding
@@ -815,6 +944,7 @@ VOICE_CLOCK( V3c )
 	}
 	
 	// Gaussian interpolation
+	if ( !m.skip_output || ((m.t_eon | m.t_pmon >> 1) & v->vbit) )
 	{
 		int output;
 
@@ -848,8 +978,12 @@ VOICE_CLOCK( V3c )
 		
 		// Apply envelope
 		m.t_output = (output * v->env) >> 11 & ~1;
-		v->t_envx_out = (uint8_t) (v->env >> 4);
 	}
+	else
+	{
+		m.t_output = 0;
+	}
+	v->t_envx_out = (uint8_t) (v->env >> 4);
 	
 	// Immediate silence due to end of sample or soft reset
 	if ( REG(flg) & 0x80 || (m.t_brr_header & 3) == 1 )
@@ -876,8 +1010,41 @@ VOICE_CLOCK( V3c )
 	if ( !v->kon_delay )
 		run_envelope( v );
 }
+// Writes voice's share of sample that main output will next receive
+void SPC_DSP::separate_voice_output( voice_t const* v, int ch, int amp )
+{
+	int i = v - m.voices;
+	sample_t* out;
+	if ( m.out_end == &m.extra [extra_size] )
+		out = &m.voice_extra [i] [m.out - m.extra];
+	else if ( m.voice_out [i] )
+		out = &m.voice_out [i] [m.out - m.out_begin];
+	else
+		return;
+	
+	// Same volume and surround removal as echo_output() applies to main total
+	int vol = (int8_t) REG(mvoll + ch * 0x10);
+	int voln = (int8_t) REG(mvoll + ch * 0x10 ^ 0x10);
+	if ( vol * voln < m.surround_threshold )
+		vol ^= vol >> 7;
+	
+	int s = (amp * vol) >> 7;
+	CLAMP16( s );
+	if ( REG(flg) & 0x40 )
+		s = 0;
+	out [ch] = (sample_t) s;
+}
+
 inline void SPC_DSP::voice_output( voice_t const* v, int ch )
 {
+	// Silent voice adds nothing and can't raise max level
+	if ( !m.t_output )
+	{
+		if ( m.separate_voices )
+			separate_voice_output( v, ch, 0 );
+		return;
+	}
+	
     // Check surround removal
     int vol = (int8_t) VREG(v->regs,voll + ch);
     int voln = (int8_t) VREG(v->regs,voll + ch ^ 1);
@@ -891,6 +1058,9 @@ inline void SPC_DSP::voice_output( voice_t const* v, int ch )
 	if ( abs_amp > m.max_level[v - (const SPC_DSP::voice_t *)&m.voices][ch] )
 		m.max_level[v - (const SPC_DSP::voice_t *)&m.voices][ch] = abs_amp;
 
+	if ( m.separate_voices )
+		separate_voice_output( v, ch, amp );
+	
 	// Add to output total
 	m.t_main_out [ch] += amp;
 	CLAMP16( m.t_main_out [ch] );
@@ -1223,7 +1393,10 @@ void SPC_DSP::init( void* ram_64k )
 	mute_voices( 0 );
 	disable_surround( false );
 	interpolation_level( 0 );
+	skip_output( false );
 	set_output( 0, 0 );
+	separate_voices( false );
+	set_voice_output( NULL );
 	reset();
 	
 	#ifndef NDEBUG
@@ -1252,6 +1425,9 @@ void SPC_DSP::soft_reset_common()
 	m.echo_offset        = 0;
 	m.phase              = 0;
 	
+	// voices that run before the first sample's output add nothing to it
+	memset( m.voice_extra, 0, sizeof m.voice_extra );
+	
 	init_counter();
 }
 
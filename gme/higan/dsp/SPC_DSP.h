@@ -19,7 +19,7 @@ public:
 	void init( void* ram_64k );
 
 	// Sets destination for output samples. If out is NULL or out_size is 0,
-	// doesn't generate any.
+	// samples go to extra() instead.
 	typedef short sample_t;
 	void set_output( sample_t* out, int out_size );
 	sample_t* get_output();
@@ -28,6 +28,25 @@ public:
 	// a multiple of 2. Undefined if more samples were generated than
 	// output buffer could hold.
 	int sample_count() const;
+	
+	// Once output is full, further samples go to extra(), wrapping around
+	// after extra_size of them
+	enum { extra_size = 16 };
+	sample_t* extra()               { return m.extra; }
+	
+	// If true, each voice's share of the output, after main volume and without
+	// echo, is also written to a separate output. Voice output position follows
+	// main output, going to voice_extra( i ) where main output goes to extra().
+	// Voices write their share of a pair before main output receives it, so
+	// voice_extra( i ) holds one more pair than extra().
+	void separate_voices( bool separate = true ) { m.separate_voices = separate; }
+	bool voices_separate() const    { return m.separate_voices; }
+	
+	// Sets destinations for separate voice output, matching the current output
+	// set with set_output(). Samples for a voice with a NULL pointer, or all if
+	// out is NULL, are discarded.
+	void set_voice_output( sample_t* const out [] );
+	sample_t* voice_extra( int i )  { return m.voice_extra [i]; }
 
 // Emulation
 
@@ -93,8 +112,14 @@ public:
 
 public:
 	sample_t const* out_pos() const { return m.out; }
+	void set_sample_count( int n ) { m.out = m.out_begin + n; }
 	void disable_surround( bool disable = true );
 	void interpolation_level( int level = 0 ) { m.interpolation_level = level; }
+	
+	// If true, voice output is only calculated where more than the generated
+	// samples depend on it: voices sent to echo or modulating the next voice.
+	// Other voices' OUTX reads as zero. For use while output is discarded.
+	void skip_output( bool skip = true ) { m.skip_output = skip; }
 public:
 	BLARGG_DISABLE_NOTHROW
 	
@@ -183,9 +208,14 @@ public:
 		int mute_mask;
         int surround_threshold;
 		int interpolation_level;
+		bool skip_output;
 		sample_t* out;
 		sample_t* out_end;
 		sample_t* out_begin;
+		sample_t extra [extra_size];
+		bool separate_voices;
+		sample_t* voice_out [voice_count];
+		sample_t voice_extra [voice_count] [extra_size + 2];
 
 		int max_level[voice_count][2];
 	};
@@ -210,6 +240,7 @@ public:
 	void misc_30();
 
 	void voice_output( voice_t const* v, int ch );
+	void separate_voice_output( voice_t const* v, int ch, int amp );
 	void voice_V1( voice_t* const );
 	void voice_V2( voice_t* const );
 	void voice_V3( voice_t* const );
@@ -1,38 +1,73 @@
 #include "../smp/smp.hpp"
 #include "dsp.hpp"
 
+#include "State_Copier.h"
+#include "blargg_errors.h"
+#include <string.h>
+
 namespace SuperFamicom {
 
-void DSP::step(uint64_t clocks) {
-  clock += clocks;
+void DSP::enter() {
+  if(clock < 0) defer();
+  if(deferred_clocks < 1) return;
+
+  spc_dsp.run(deferred_clocks);
+  deferred_clocks = 0;
 }
 
-void DSP::enter() {
-  int64_t dsp_clocks = (-clock) / (24 * 4096) + 1;
-  if (dsp_clocks < 1) return;
-
-  spc_dsp.run(dsp_clocks);
-  step(dsp_clocks * 24 * 4096);
-
-  samplebuffer = spc_dsp.get_output();
-  signed count = spc_dsp.sample_count();
-  if(count > removed_samples) {
-    for(unsigned n = removed_samples; n < count; n += 2) {
-      if (!smp.sample(samplebuffer[n + 0], samplebuffer[n + 1])) {
-        removed_samples = n;
-        return;
-      }
+//Moves the first samples generated past the end of the previous output to
+//out, or drops them if out is NULL
+static void take_pending(int16_t* out, int16_t* extra, unsigned pending, unsigned size) {
+  if(size > pending) size = pending;
+  if(out) memcpy(out, extra, size * sizeof *out);
+  memmove(extra, extra + size, (pending - size) * sizeof *out);
+}
+
+//Has the DSP write samples directly to out, starting with any it generated
+//past the end of the previous output. When voices are separate, each also
+//goes to voice_out[i] at the same positions.
+void DSP::set_output(int16_t* out, unsigned size, int16_t* const voice_out[]) {
+  unsigned pending = pending_samples();
+  take_pending(out, spc_dsp.extra(), pending, size);
+  if(spc_dsp.voices_separate()) {
+    for(unsigned i = 0; i < 8; i++) {
+      take_pending(voice_out ? voice_out[i] : 0, spc_dsp.voice_extra(i), pending + 2, size);
     }
-    spc_dsp.set_output(samplebuffer, 8192);
-    removed_samples = 0;
+  }
+  spc_dsp.set_voice_output(voice_out);
+  if(pending < size) {
+    spc_dsp.set_output(out, size);
+    spc_dsp.set_sample_count(pending);
+    output_end = out + size;
+  }
+  else {
+    spc_dsp.set_output(0, 0);
+    spc_dsp.set_sample_count(pending - size);
+    output_end = 0;
   }
 }
 
+//Samples still to be generated before output is full
+unsigned DSP::output_remain() {
+  int16_t const* pos = spc_dsp.out_pos();
+  if(!output_end || pos < spc_dsp.get_output() || pos >= output_end) return 0;
+  return output_end - pos;
+}
+
+//Once output is full, SPC_DSP continues at the beginning of its extra buffer
+unsigned DSP::pending_samples() {
+  int16_t const* pos = spc_dsp.out_pos();
+  if(output_end && pos >= spc_dsp.get_output() && pos <= output_end) return 0;
+  return pos - spc_dsp.extra();
+}
+
 bool DSP::mute() {
   return spc_dsp.mute();
 }
 
 uint8_t DSP::read(uint8_t addr) {
+  //if skipping, this read is too late, so SMP::skip() runs the chunk again
+  if((addr & 0x0f) == SPC_DSP::v_outx && !outx_read) set_reads_outx();
   return spc_dsp.read(addr);
 }
 
@@ -41,16 +76,19 @@ void DSP::write(uint8_t addr, uint8_t data) {
 }
 
 void DSP::power() {
+  deferred_clocks = 0;
+  skipping = false;
+  outx_read = false;
   spc_dsp.init(smp.apuram);
   spc_dsp.reset();
   spc_dsp.set_output(0, 0);
-  removed_samples = 0;
+  output_end = 0;
 }
 
 void DSP::reset() {
   spc_dsp.soft_reset();
   spc_dsp.set_output(0, 0);
-  removed_samples = 0;
+  output_end = 0;
 }
 
 void DSP::channel_enable(unsigned channel, bool enable) {
@@ -66,13 +104,66 @@ void DSP::disable_surround(bool disable) {
   spc_dsp.disable_surround(disable);
 }
 
-DSP::DSP(struct SMP & p_smp)
-    : smp( p_smp ), clock( 0 ), removed_samples( 0 ), samplebuffer( 0 ) {
-  for(unsigned i = 0; i < 8; i++) channel_enabled[i] = true;
+void DSP::skip_output(bool skip) {
+  skipping = skip;
+  spc_dsp.skip_output(skip && !outx_read);
+}
+
+void DSP::set_reads_outx() {
+  outx_read = true;
+  skip_output(skipping);
+}
+
+void DSP::separate_voices(bool separate) {
+  spc_dsp.separate_voices(separate);
+}
+
+static void save_dsp_state(unsigned char** io, void* state, size_t size) {
+  memcpy(*io, state, size);
+  *io += size;
+}
+
+static void load_dsp_state(unsigned char** io, void* state, size_t size) {
+  memcpy(state, *io, size);
+  *io += size;
 }
 
-DSP::~DSP() {
-  if ( samplebuffer ) free( samplebuffer );
+void DSP::copy_state(State_Copier& copier) {
+  copier.copy(clock);
+  copier.copy(outx_read);
+
+  unsigned char* p = copier.reserve(SPC_DSP::state_size);
+  if(p) spc_dsp.copy_state(&p, copier.loading() ? load_dsp_state : save_dsp_state);
+
+  int pending = 0;
+  if(!copier.loading()) pending = pending_samples();
+  copier.copy(pending);
+  if(copier.loading() && (unsigned)pending > SPC_DSP::extra_size) {
+    copier.set_error(BLARGG_ERR(BLARGG_ERR_FILE_CORRUPT, "state"));
+    return;
+  }
+
+  int16_t* extra = spc_dsp.extra();
+  copier.copy_var(extra, pending * sizeof *extra, max_pending_samples * sizeof *extra);
+  if(spc_dsp.voices_separate()) {
+    for(unsigned i = 0; i < 8; i++) {
+      int16_t* voice_extra = spc_dsp.voice_extra(i);
+      copier.copy_var(voice_extra, (pending + 2) * sizeof *extra, (max_pending_samples + 2) * sizeof *extra);
+    }
+  }
+
+  if(copier.loading() && !copier.error()) {
+    skip_output(skipping);
+    spc_dsp.set_output(0, 0);
+    spc_dsp.set_sample_count(pending);
+    output_end = 0;
+  }
+}
+
+DSP::DSP(struct SMP & p_smp)
+    : smp( p_smp ), clock( 0 ), deferred_clocks( 0 ), output_end( 0 ),
+      skipping( false ), outx_read( false ) {
+  for(unsigned i = 0; i < 8; i++) channel_enabled[i] = true;
 }
 
 }
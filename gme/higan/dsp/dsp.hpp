@@ -4,14 +4,16 @@
 #include "SPC_DSP.h"
 
 #include "blargg_common.h"
+class State_Copier;
 
 namespace SuperFamicom {
 
 struct DSP {
   int64_t clock;
-  unsigned long removed_samples;
+  int deferred_clocks;  //counted but not yet run
 
   inline void step(uint64_t clocks);
+  inline void defer();
 
   bool mute();
   uint8_t read(uint8_t addr);
@@ -21,20 +23,46 @@ struct DSP {
   void power();
   void reset();
 
+  void set_output(int16_t* out, unsigned size, int16_t* const voice_out[] = 0);
+  unsigned output_remain();
+
   void channel_enable(unsigned channel, bool enable);
   void disable_surround(bool disable = true);
+  void skip_output(bool skip = true);
+  bool reads_outx() const { return outx_read; }
+  void set_reads_outx();
+  void separate_voices(bool separate = true);
+
+  void copy_state(State_Copier&);
 
   DSP(struct SMP&);
-  ~DSP();
 
   SPC_DSP spc_dsp;
 
 private:
   struct SMP & smp;
-  int16_t * samplebuffer;
+  int16_t const* output_end;  //NULL if output is only to extra buffer
   bool channel_enabled[8];
+  bool skipping;
+  bool outx_read;  //program reads OUTX, so voice output can't be skipped
+
+  //samples generated past end of output are never more than SPC_DSP::extra_size,
+  //so that's all the room saved state needs for them
+  enum { max_pending_samples = SPC_DSP::extra_size };
+  unsigned pending_samples();
 };
 
+inline void DSP::step(uint64_t clocks) {
+  clock += clocks;
+}
+
+//Counts the clocks enter() would run now, leaving them for the next enter()
+inline void DSP::defer() {
+  int64_t dsp_clocks = (-clock) / (24 * 4096) + 1;
+  step(dsp_clocks * 24 * 4096);
+  deferred_clocks += (int)dsp_clocks;
+}
+
 };
 
 #endif
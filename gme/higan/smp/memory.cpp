@@ -8,7 +8,12 @@ inline uint8_t SMP::ram_read(uint16_t addr) {
 
 inline void SMP::ram_write(uint16_t addr, uint8_t data) {
   //writes to $ffc0-$ffff always go to apuram, even if the iplrom is enabled
-  if(status.ram_writable && !status.ram_disable) apuram[addr] = data;
+  if(status.ram_writable && !status.ram_disable) {
+    //DSP may read any address, so it must not see a change early, and a
+    //pending echo write may still change the one being written
+    if(apuram[addr] != data || in_echo_window(addr)) synchronize_dsp();
+    apuram[addr] = data;
+  }
 }
 
 uint8_t SMP::port_read(uint8_t port) const {
@@ -34,6 +39,7 @@ uint8_t SMP::op_busread(uint16_t addr) {
 
   case 0xf3:  //DSPDATA
     //0x80-0xff are read-only mirrors of 0x00-0x7f
+    synchronize_dsp();
     return dsp.read(status.dsp_addr & 0x7f);
 
   case 0xf4:  //CPUIO0
@@ -76,6 +82,7 @@ uint8_t SMP::op_busread(uint16_t addr) {
     return result;
   }
 
+  if(in_echo_window(addr)) synchronize_dsp();
   return ram_read(addr);
 }
 
@@ -136,7 +143,9 @@ void SMP::op_buswrite(uint16_t addr, uint8_t data) {
 
   case 0xf3:  //DSPDATA
     if(status.dsp_addr & 0x80) break;  //0x80-0xff are read-only mirrors of 0x00-0x7f
+    synchronize_dsp();
     dsp.write(status.dsp_addr & 0x7f, data);
+    update_echo_window();
     break;
 
   case 0xf4:  //CPUIO0
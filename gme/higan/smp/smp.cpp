@@ -1,5 +1,6 @@
 #include "smp.hpp"
 
+#include "State_Copier.h"
 #include <cstdlib>
 
 #define SMP_CPP
@@ -13,54 +14,135 @@ void SMP::step(unsigned clocks) {
   dsp.clock -= clocks * dsp_clock_step;
 }
 
+//Runs the DSP clocks counted since the last call. Called before the SMP
+//accesses DSP registers or RAM the DSP may read or write, and at the end of
+//each enter(), so output is the same as running both in lockstep.
 void SMP::synchronize_dsp() {
-  while(dsp.clock < 0) dsp.enter();
+  if(dsp.clock >= 0 && !dsp.deferred_clocks) return;
+  dsp.enter();
+  update_echo_window();
+}
+
+//Echo writes are the only RAM the DSP changes. Until the SMP next writes a
+//DSP register, they can only land at latched or register ESA, within the
+//longer of the latched and register EDL, or at the pointer already computed
+//for the current sample.
+void SMP::update_echo_window() {
+  SPC_DSP::state_t const& m = dsp.spc_dsp.m;
+  unsigned size = 0;
+  if(!(m.t_echo_enabled & 0x20) || !(m.regs[SPC_DSP::r_flg] & 0x20)) {
+    size = (m.regs[SPC_DSP::r_edl] & 0x0f) * 0x800;
+    if(size < (unsigned)m.echo_length) size = m.echo_length;
+    if(size < 4) size = 4;
+  }
+  echo_window[0].begin = m.t_esa * 0x100;
+  echo_window[0].size  = size;
+  echo_window[1].begin = m.regs[SPC_DSP::r_esa] * 0x100;
+  echo_window[1].size  = size;
+  echo_window[2].begin = m.t_echo_ptr;
+  echo_window[2].size  = size ? 4 : 0;
+}
+
+bool SMP::in_echo_window(uint16_t addr) const {
+  for(unsigned i = 0; i < 3; i++) {
+    if((uint16_t)(addr - echo_window[i].begin) < echo_window[i].size) return true;
+  }
+  return false;
 }
 
 void SMP::enter() {
-  while(sample_buffer < sample_buffer_end) {
-    clock -= (int64_t)((double)(sample_buffer_end - sample_buffer) * 24.0 * 16.0 * tempo);
+  update_echo_window();
+  while(unsigned remain = dsp.output_remain()) {
+    clock -= (int64_t)((double)remain * 24.0 * 16.0 * tempo);
     while(status.clock_speed != 2 && clock < 0) op_step();
     if(status.clock_speed == 2) step(-clock);
     synchronize_dsp();
   }
 }
 
-void SMP::render(int16_t * buffer, unsigned count) {
+//The DSP writes samples directly to buffer, and to voice_out[i] for voices
+//kept separate
+void SMP::render(int16_t * buffer, unsigned count, int16_t* const voice_out[]) {
+  int16_t* voices[8];
+  for(unsigned i = 0; i < 8; i++) voices[i] = voice_out ? voice_out[i] : 0;
   while (count > 4096) {
-    sample_buffer = buffer;
-    sample_buffer_end = buffer + 4096;
+    dsp.set_output(buffer, 4096, voices);
     buffer += 4096;
+    for(unsigned i = 0; i < 8; i++) if(voices[i]) voices[i] += 4096;
     count -= 4096;
     enter();
   }
-  sample_buffer = buffer;
-  sample_buffer_end = buffer + count;
+  dsp.set_output(buffer, count, voices);
   enter();
 }
 
 void SMP::skip(unsigned count) {
+  int16_t buffer[4096];
+  //voice output is only needed in the last chunk, since samples generated
+  //past its end are kept for the next render
+  dsp.skip_output(true);
   while (count > 4096) {
-    sample_buffer = 0;
-    sample_buffer_end = ((const int16_t *)0) + 4096;
-    count -= 4096;
+    //until the program reads OUTX, each chunk starts from saved state, so if
+    //the first read was during it and saw skipped output, it can be run again
+    bool saved = !dsp.reads_outx() && save_skip_state();
+    if(!saved) dsp.skip_output(false);
+    dsp.set_output(buffer, 4096);
     enter();
+    if(saved && dsp.reads_outx()) {
+      load_skip_state();
+      dsp.set_output(buffer, 4096);
+      enter();
+    }
+    count -= 4096;
   }
-  sample_buffer = 0;
-  sample_buffer_end = ((const int16_t *)0) + count;
+  dsp.skip_output(false);
+  dsp.set_output(buffer, count);
   enter();
 }
 
-bool SMP::sample(int16_t left, int16_t right) {
-  if ( sample_buffer_end - sample_buffer < 2 ) return false;
-  if ( sample_buffer > ((const int16_t *)0) + 4096 ) {
-    *sample_buffer++ = left;
-    *sample_buffer++ = right;
+bool SMP::save_skip_state() {
+  if(!skip_state.size()) {
+    State_Copier measure(State_Copier::mode_measure);
+    copy_state(measure);
+    if(skip_state.resize(measure.size())) return false;
   }
-  else {
-    sample_buffer += 2;
-  }
-  return true;
+  State_Copier copier(State_Copier::mode_save, skip_state.begin(), (int)skip_state.size());
+  copy_state(copier);
+  return !copier.error();
+}
+
+//Goes back to saved state, except that OUTX stays known to be read
+void SMP::load_skip_state() {
+  State_Copier copier(State_Copier::mode_load, skip_state.begin(), (int)skip_state.size());
+  copy_state(copier);
+  assert(!copier.error());
+  dsp.set_reads_outx();
+}
+
+template<unsigned frequency>
+static void copy_timer(State_Copier& copier, SMP::Timer<frequency>& timer) {
+  copier.copy(timer.stage0_ticks);
+  copier.copy(timer.stage1_ticks);
+  copier.copy(timer.stage2_ticks);
+  copier.copy(timer.stage3_ticks);
+  copier.copy(timer.current_line);
+  copier.copy(timer.enable);
+  copier.copy(timer.target);
+}
+
+void SMP::copy_state(State_Copier& copier) {
+  copier.copy(clock);
+  copier.copy(regs);
+  copier.copy(opcode);
+  copier.copy(status);
+  copier.copy(apuram);
+  copier.copy(iplrom);
+  copy_timer(copier, timer0);
+  copy_timer(copier, timer1);
+  copy_timer(copier, timer2);
+  copier.copy(sfm_last);
+  copier.copy(sfm_queue);
+  dsp.copy_state(copier);
 }
 
 void SMP::power() {
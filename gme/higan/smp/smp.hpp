@@ -22,6 +22,11 @@ struct SMP : Processor::SPC700 {
   inline void step(unsigned clocks);
   inline void synchronize_dsp();
 
+  //RAM the DSP may write echo to before it is next synchronized
+  struct echo_window_t { uint16_t begin, size; } echo_window[3];
+  void update_echo_window();
+  inline bool in_echo_window(uint16_t addr) const;
+
   uint8_t port_read(uint8_t port) const;
   void port_write(uint8_t port, uint8_t data);
 
@@ -31,11 +36,17 @@ struct SMP : Processor::SPC700 {
 
   void set_tempo(double);
 
-  void render(int16_t * buffer, unsigned count);
+  void render(int16_t * buffer, unsigned count, int16_t* const voice_out[] = 0);
   void skip(unsigned count);
+
+  void copy_state(State_Copier&);
   
   uint8_t sfm_last[4];
 private:
+  blargg_vector<unsigned char> skip_state;  //state at start of skip chunk
+  bool save_skip_state();
+  void load_skip_state();
+
   uint8_t const* sfm_queue;
   uint8_t const* sfm_queue_end;
   uint8_t const* sfm_queue_repeat;
@@ -45,12 +56,6 @@ public:
   const uint8_t* get_sfm_queue() const;
   size_t get_sfm_queue_remain() const;
     
-private:
-  int16_t * sample_buffer;
-  int16_t const* sample_buffer_end;
-public:
-  bool sample( int16_t, int16_t );
-    
   SMP();
   ~SMP();
 
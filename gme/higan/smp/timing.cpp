@@ -2,7 +2,9 @@
 
 void SMP::add_clocks(unsigned clocks) {
   step(clocks);
-  synchronize_dsp();
+  //DSP clocks are counted as before but only run where the SMP could tell
+  //the difference; see synchronize_dsp()
+  if(dsp.clock < 0) dsp.defer();
 }
 
 void SMP::cycle_edge() {
@@ -296,3 +296,19 @@ void k051649_set_mute_mask(void *chip, UINT32 MuteMask)
 	for (CurChn = 0; CurChn < 5; CurChn ++)
 		info->channel_list[CurChn].Muted = (MuteMask >> CurChn) & 0x01;
 }
+
+int k051649_state_size(void)
+{
+	return sizeof(k051649_state);
+}
+
+int k051649_state_kept(void *_chip, int *offsets)
+{
+	k051649_state *info = (k051649_state *) _chip;
+	int n = 0;
+	
+	offsets[n++] = (int)((char *)&info->mixer_table - (char *)info);
+	offsets[n++] = (int)((char *)&info->mixer_lookup - (char *)info);
+	offsets[n++] = (int)((char *)&info->mixer_buffer - (char *)info);
+	return n;
+}
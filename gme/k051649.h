@@ -38,6 +38,16 @@ void k051649_w(void *, offs_t offset, UINT8 data);
 
 void k051649_set_mute_mask(void *, UINT32 MuteMask);
 
+/* size of the block returned by device_start_k051649(); it can be copied to
+save state */
+int k051649_state_size(void);
+
+/* byte offsets of pointers within that block to memory the chip allocated, in
+increasing order, which are kept when state is loaded into another chip;
+returns count, at most K051649_STATE_KEPT */
+#define K051649_STATE_KEPT 3
+int k051649_state_kept(void *chip, int *offsets);
+
 //#endif /* __K051649_H__ */
 
 #ifdef __cplusplus
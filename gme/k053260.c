@@ -505,3 +505,18 @@ void k053260_set_mute_mask(void *chip, UINT32 MuteMask)
 	for (CurChn = 0; CurChn < 4; CurChn ++)
 		info->channels[CurChn].Muted = (MuteMask >> CurChn) & 0x01;
 }
+
+int k053260_state_size(void)
+{
+	return sizeof(k053260_state);
+}
+
+int k053260_state_kept(void *_chip, int *offsets)
+{
+	k053260_state *ic = (k053260_state *) _chip;
+	int n = 0;
+	
+	offsets[n++] = (int)((char *)&ic->rom - (char *)ic);
+	offsets[n++] = (int)((char *)&ic->delta_table - (char *)ic);
+	return n;
+}
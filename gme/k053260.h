@@ -35,6 +35,16 @@ void k053260_write_rom(void *, offs_t ROMSize, offs_t DataStart, offs_t DataLeng
 					   const UINT8* ROMData);
 void k053260_set_mute_mask(void *, UINT32 MuteMask);
 
+/* size of the block returned by device_start_k053260(); it can be copied to
+save state */
+int k053260_state_size(void);
+
+/* byte offsets of pointers within that block to memory the chip allocated, in
+increasing order, which are kept when state is loaded into another chip;
+returns count, at most K053260_STATE_KEPT */
+#define K053260_STATE_KEPT 2
+int k053260_state_kept(void *chip, int *offsets);
+
 //DECLARE_LEGACY_SOUND_DEVICE(K053260, k053260);
 
 #ifdef __cplusplus
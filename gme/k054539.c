@@ -786,3 +786,32 @@ void k054539_set_mute_mask(void *chip, UINT32 MuteMask)
 	
 	return;
 }
+
+int k054539_state_size(void)
+{
+	return sizeof(k054539_state);
+}
+
+int k054539_state_kept(void *_chip, int *offsets)
+{
+	k054539_state *info = (k054539_state *) _chip;
+	int n = 0;
+	
+	offsets[n++] = (int)((char *)&info->ram - (char *)info);
+	offsets[n++] = (int)((char *)&info->cur_zone - (char *)info);
+	offsets[n++] = (int)((char *)&info->rom - (char *)info);
+	return n;
+}
+
+UINT8 *k054539_state_ram(void *_chip, int *size)
+{
+	k054539_state *info = (k054539_state *) _chip;
+	
+	*size = 0x4000 * 2 + info->clock / 50 * 2;
+	return info->ram;
+}
+
+void k054539_state_loaded(void *chip)
+{
+	reset_zones((k054539_state *) chip);
+}
@@ -62,6 +62,22 @@ void k054539_write_rom(void *, offs_t ROMSize, offs_t DataStart, offs_t DataLeng
 					   const UINT8* ROMData);
 void k054539_set_mute_mask(void *, UINT32 MuteMask);
 
+/* size of the block returned by device_start_k054539(); it can be copied to
+save state */
+int k054539_state_size(void);
+
+/* byte offsets of pointers within that block to memory the chip allocated, in
+increasing order, which are kept when state is loaded into another chip;
+returns count, at most K054539_STATE_KEPT */
+#define K054539_STATE_KEPT 3
+int k054539_state_kept(void *chip, int *offsets);
+
+/* RAM, which is part of state but not in that block */
+UINT8 *k054539_state_ram(void *chip, int *size);
+
+/* updates pointers that depend on copied registers, after loading state */
+void k054539_state_loaded(void *chip);
+
 
 //DECLARE_LEGACY_SOUND_DEVICE(K054539, k054539);
 
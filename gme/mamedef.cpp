@@ -0,0 +1,29 @@
+// Game_Music_Emu $vers. http://www.slack.net/~ant/
+
+#include "mamedef.h"
+
+#include <mutex>
+
+/* This module is free software; you can redistribute it and/or modify it
+under the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation; either version 2.1 of the License, or (at your
+option) any later version. This module is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General
+Public License for more details. You should have received a copy of the GNU
+Lesser General Public License along with this module; if not, write to the
+Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+02110-1301 USA */
+
+// Only taken when a chip is created, so one lock for all tables is enough
+static std::mutex init_mutex;
+
+void mame_init_once( int* done, void (*build)( void ) )
+{
+	std::lock_guard<std::mutex> lock( init_mutex );
+	if ( !*done )
+	{
+		build();
+		*done = 1;
+	}
+}
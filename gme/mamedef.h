@@ -51,5 +51,14 @@ typedef INT32 stream_sample_t;
 
 #define logerror
 
+/* Calls build() unless it has already been called for the same done flag, which
+must be a static variable initialized to 0. If another thread is in build(),
+waits for it to finish. Used by the chips to build their tables once, and share
+them read-only. */
+#ifdef __cplusplus
+extern "C"
+#endif
+void mame_init_once( int* done, void (*build)( void ) );
+
 
 #endif
@@ -84,7 +84,7 @@ static int tables_computed = 0;
 
 ***********************************************************************************************/
 
-static void compute_tables(void)
+static void build_tables(void)
 {
 	/* nibble to bit map */
 	static const int nbl2bit[16][4] =
@@ -97,9 +97,6 @@ static void compute_tables(void)
 
 	int step, nib;
 
-	if (tables_computed)
-		return;
-	
 	/* loop over all possible steps */
 	for (step = 0; step <= 48; step++)
 	{
@@ -116,8 +113,11 @@ static void compute_tables(void)
 				 stepval/8);
 		}
 	}
+}
 
-	tables_computed = 1;
+static void compute_tables(void)
+{
+	mame_init_once( &tables_computed, build_tables );
 }
 
 
@@ -538,3 +538,8 @@ void okim6258_write(void *chip, UINT8 Port, UINT8 Data)
 		break;
 	}
 }
+
+int okim6258_state_size(void)
+{
+	return sizeof(okim6258_state);
+}
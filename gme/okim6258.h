@@ -50,6 +50,10 @@ void okim6258_data_w(void *, offs_t offset, UINT8 data);
 void okim6258_ctrl_w(void *, offs_t offset, UINT8 data);
 void okim6258_write(void *, UINT8 Port, UINT8 Data);
 
+/* size of the block returned by device_start_okim6258(); it can be copied to
+save state */
+int okim6258_state_size(void);
+
 //DECLARE_LEGACY_SOUND_DEVICE(OKIM6258, okim6258);
 
 #ifdef __cplusplus
@@ -127,7 +127,7 @@ ADDRESS_MAP_END*/
 
 ***********************************************************************************************/
 
-static void compute_tables(void)
+static void build_tables(void)
 {
 	/* nibble to bit map */
 	static const int nbl2bit[16][4] =
@@ -156,8 +156,11 @@ static void compute_tables(void)
 				 stepval/8);
 		}
 	}
+}
 
-	tables_computed = 1;
+static void compute_tables(void)
+{
+	mame_init_once( &tables_computed, build_tables );
 }
 
 
@@ -171,8 +174,7 @@ static void compute_tables(void)
 void reset_adpcm(struct adpcm_state *state)
 {
 	/* make sure we have our tables */
-	if (!tables_computed)
-		compute_tables();
+	compute_tables();
 
 	/* reset the signal/step */
 	state->signal = -2;
@@ -707,3 +709,17 @@ void okim6295_set_mute_mask(void *_chip, UINT32 MuteMask)
 	for (CurChn = 0; CurChn < OKIM6295_VOICES; CurChn ++)
 		chip->voice[CurChn].Muted = (MuteMask >> CurChn) & 0x01;
 }
+
+int okim6295_state_size(void)
+{
+	return sizeof(okim6295_state);
+}
+
+int okim6295_state_kept(void *_chip, int *offsets)
+{
+	okim6295_state *chip = (okim6295_state *) _chip;
+	int n = 0;
+	
+	offsets[n++] = (int)((char *)&chip->ROM - (char *)chip);
+	return n;
+}
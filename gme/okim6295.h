@@ -39,6 +39,15 @@ void okim6295_write_rom(void *, offs_t ROMSize, offs_t DataStart, offs_t DataLen
 						const UINT8* ROMData);
 void okim6295_set_mute_mask(void *, UINT32 MuteMask);
 
+/* size of the block returned by device_start_okim6295(); it can be copied to
+save state */
+int okim6295_state_size(void);
+
+/* byte offsets of pointers within that block to memory the chip allocated, in
+increasing order, which are kept when state is loaded into another chip;
+returns count, at most OKIM6295_STATE_KEPT */
+#define OKIM6295_STATE_KEPT 1
+int okim6295_state_kept(void *chip, int *offsets);
 
 /*
     To help the various custom ADPCM generators out there,
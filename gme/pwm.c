@@ -442,3 +442,8 @@ void pwm_chn_w(void *_chip, UINT8 Channel, UINT16 data)
 	
 	return;
 }
+
+int pwm_state_size(void)
+{
+	return sizeof(pwm_chip);
+}
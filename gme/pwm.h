@@ -66,6 +66,10 @@ void device_reset_pwm(void *chip);
 
 void pwm_chn_w(void *chip, UINT8 Channel, UINT16 data);
 
+/* size of the block returned by device_start_pwm(); it can be copied to save
+state */
+int pwm_state_size(void);
+
 #ifdef __cplusplus
 }
 #endif
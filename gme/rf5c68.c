@@ -418,6 +418,37 @@ void rf5c68_set_mute_mask(void *_chip, UINT32 MuteMask)
 	return;
 }
 
+int rf5c68_state_size(void)
+{
+	return sizeof(rf5c68_state);
+}
+
+int rf5c68_state_ptrs(void *_chip, int *offsets)
+{
+	rf5c68_state *chip = (rf5c68_state *) _chip;
+	int n = 0;
+	
+	offsets[n++] = (int)((char *)&chip->memstrm.MemPnt - (char *)chip);
+	return n;
+}
+
+int rf5c68_state_kept(void *_chip, int *offsets)
+{
+	rf5c68_state *chip = (rf5c68_state *) _chip;
+	int n = 0;
+	
+	offsets[n++] = (int)((char *)&chip->data - (char *)chip);
+	return n;
+}
+
+UINT8 *rf5c68_state_ram(void *_chip, int *size)
+{
+	rf5c68_state *chip = (rf5c68_state *) _chip;
+	
+	*size = chip->datasize;
+	return chip->data;
+}
+
 
 
 /**************************************************************************
@@ -33,6 +33,25 @@ void rf5c68_write_ram(void *chip, offs_t DataStart, offs_t DataLength, const UIN
 
 void rf5c68_set_mute_mask(void *chip, UINT32 MuteMask);
 
+/* size of the block returned by device_start_rf5c68(); it can be copied to
+save state */
+int rf5c68_state_size(void);
+
+/* byte offsets of pointers within that block, in increasing order, so they can
+be relocated when state is loaded into another chip; returns count, at most
+RF5C68_STATE_PTRS */
+#define RF5C68_STATE_PTRS 1
+int rf5c68_state_ptrs(void *chip, int *offsets);
+
+/* byte offsets of pointers within that block to memory the chip allocated, in
+increasing order, which are kept when state is loaded into another chip;
+returns count, at most RF5C68_STATE_KEPT */
+#define RF5C68_STATE_KEPT 1
+int rf5c68_state_kept(void *chip, int *offsets);
+
+/* RAM, which is part of state but not in that block */
+UINT8 *rf5c68_state_ram(void *chip, int *size);
+
 #ifdef __cplusplus
 }
 #endif
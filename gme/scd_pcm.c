@@ -21,8 +21,6 @@ int  PCM_Update(void *chip, int **buf, int Length);
 
 #define PCM_STEP_SHIFT 11
 
-static unsigned char VolTabIsInit = 0x00;
-static int PCM_Volume_Tab[256 * 256];
 
 //unsigned char Ram_PCM[64 * 1024];
 //int PCM_Enable;
@@ -36,29 +34,7 @@ static int PCM_Volume_Tab[256 * 256];
 int PCM_Init(void *_chip, int Rate)
 {
 	struct pcm_chip_ *chip = (struct pcm_chip_ *) _chip;
-	int i, j, out;
-	
-	if (! VolTabIsInit)
-	{
-		for (i = 0; i < 0x100; i++)
-		{
-			for (j = 0; j < 0x100; j++)
-			{
-				if (i & 0x80)
-				{
-					out = -(i & 0x7F);
-					out *= j;
-					PCM_Volume_Tab[(j << 8) + i] = out;
-				}
-				else
-				{
-					out = i * j;
-					PCM_Volume_Tab[(j << 8) + i] = out;
-				}
-			}
-		}
-		VolTabIsInit = 0x01;
-	}
+	int i;
 	
 	for (i = 0; i < 8; i ++)
 		chip->Channel[i].Muted = 0x00;
@@ -363,8 +339,6 @@ int PCM_Update(void *_chip, int **buf, int Length)
 		if (CH->Enable && ! CH->Muted)
 		{
 			Addr = CH->Addr >> PCM_STEP_SHIFT;
-			//volL = &(PCM_Volume_Tab[CH->MUL_L << 8]);
-			//volR = &(PCM_Volume_Tab[CH->MUL_R << 8]);
 			
 			for (j = 0; j < Length; j++)
 			{
@@ -496,3 +470,25 @@ void rf5c164_set_mute_mask(void *_chip, UINT32 MuteMask)
 	
 	return;
 }
+
+int rf5c164_state_size(void)
+{
+	return sizeof(struct pcm_chip_);
+}
+
+int rf5c164_state_kept(void *_chip, int *offsets)
+{
+	struct pcm_chip_ *chip = (struct pcm_chip_ *) _chip;
+	int n = 0;
+	
+	offsets[n++] = (int)((char *)&chip->RAM - (char *)chip);
+	return n;
+}
+
+UINT8 *rf5c164_state_ram(void *_chip, int *size)
+{
+	struct pcm_chip_ *chip = (struct pcm_chip_ *) _chip;
+	
+	*size = (int) chip->RAMSize;
+	return chip->RAM;
+}
@@ -52,6 +52,19 @@ void rf5c164_write_ram(void *chip, offs_t DataStart, offs_t DataLength, const UI
 
 void rf5c164_set_mute_mask(void *chip, UINT32 MuteMask);
 
+/* size of the block returned by device_start_rf5c164(); it can be copied to
+save state */
+int rf5c164_state_size(void);
+
+/* byte offsets of pointers within that block to memory the chip allocated, in
+increasing order, which are kept when state is loaded into another chip;
+returns count, at most RF5C164_STATE_KEPT */
+#define RF5C164_STATE_KEPT 1
+int rf5c164_state_kept(void *chip, int *offsets);
+
+/* RAM, which is part of state but not in that block */
+UINT8 *rf5c164_state_ram(void *chip, int *size);
+
 #ifdef __cplusplus
 }
 #endif
@@ -262,6 +262,7 @@ void device_reset_segapcm(void *chip)
 	segapcm_state *spcm = (segapcm_state *) chip;
 	
 	memset(spcm->ram, 0xFF, 0x800);
+	memset(spcm->low, 0x00, sizeof(spcm->low));
 	
 	return;
 }
@@ -357,6 +358,32 @@ void segapcm_set_mute_mask(void *chip, UINT32 MuteMask)
 	return;
 }
 
+int segapcm_state_size(void)
+{
+	return sizeof(segapcm_state);
+}
+
+int segapcm_state_kept(void *chip, int *offsets)
+{
+	segapcm_state *spcm = (segapcm_state *) chip;
+	int n = 0;
+	
+	offsets[n++] = (int)((char *)&spcm->ram - (char *)spcm);
+	offsets[n++] = (int)((char *)&spcm->rom - (char *)spcm);
+#ifdef _DEBUG
+	offsets[n++] = (int)((char *)&spcm->romusage - (char *)spcm);
+#endif
+	return n;
+}
+
+UINT8 *segapcm_state_ram(void *chip, int *size)
+{
+	segapcm_state *spcm = (segapcm_state *) chip;
+	
+	*size = 0x800;
+	return spcm->ram;
+}
+
 
 /**************************************************************************
  * Generic get_info
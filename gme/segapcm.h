@@ -43,6 +43,19 @@ void sega_pcm_write_rom(void *chip, offs_t ROMSize, offs_t DataStart, offs_t Dat
 //void sega_pcm_fwrite_romusage(UINT8 ChipID);
 void segapcm_set_mute_mask(void *chip, UINT32 MuteMask);
 
+/* size of the block returned by device_start_segapcm(); it can be copied to
+save state */
+int segapcm_state_size(void);
+
+/* byte offsets of pointers within that block to memory the chip allocated,
+in increasing order, which are kept when state is loaded into another chip;
+returns count, at most SEGAPCM_STATE_KEPT */
+#define SEGAPCM_STATE_KEPT 3
+int segapcm_state_kept(void *chip, int *offsets);
+
+/* RAM, which is part of state but not in that block */
+UINT8 *segapcm_state_ram(void *chip, int *size);
+
 #ifdef __cplusplus
 }
 #endif
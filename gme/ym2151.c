@@ -463,7 +463,7 @@ static FILE *sample[9];
 
 
 
-static void init_tables(void)
+static void build_tables(void)
 {
 	signed int i,x,n;
 	double o,m;
@@ -551,6 +551,14 @@ static void init_tables(void)
 #endif
 }
 
+/* tables are built when first chip is created, then shared by all chips */
+static int tables_built = 0;
+
+static void init_tables(void)
+{
+	mame_init_once( &tables_built, build_tables );
+}
+
 
 static void init_chip_tables(YM2151 *chip)
 {
@@ -1162,6 +1170,25 @@ void * ym2151_init(int clock, int rate)
 
 
 
+int ym2151_state_size(void)
+{
+	return sizeof(YM2151);
+}
+
+int ym2151_state_ptrs(void *_chip, int *offsets)
+{
+	YM2151 *chip = (YM2151 *)_chip;
+	int n = 0;
+	int i;
+
+	for (i = 0; i < 32; i++)
+	{
+		offsets[n++] = (int)((char *)&chip->oper[i].connect     - (char *)chip);
+		offsets[n++] = (int)((char *)&chip->oper[i].mem_connect - (char *)chip);
+	}
+	return n;
+}
+
 void ym2151_shutdown(void *_chip)
 {
 	YM2151 *chip = (YM2151 *)_chip;
@@ -62,6 +62,15 @@ extern "C" {
 */
 void *ym2151_init(int clock, int rate);
 
+/* size of the block returned by ym2151_init(); it can be copied to save state */
+int ym2151_state_size(void);
+
+/* byte offsets of pointers within that block, in increasing order, so they can
+be relocated when state is loaded into another chip; returns count, at most
+YM2151_STATE_PTRS */
+#define YM2151_STATE_PTRS 64
+int ym2151_state_ptrs(void *chip, int *offsets);
+
 /* shutdown the YM2151 emulators*/
 void ym2151_shutdown(void *chip);
 
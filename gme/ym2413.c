@@ -1126,7 +1126,7 @@ INLINE void rhythm_calc( YM2413 *chip, OPLL_CH *CH, unsigned int noise )
 
 
 /* generic table initialize */
-static int init_tables(void)
+static void build_tables(void)
 {
 	signed int i,x;
 	signed int n;
@@ -1212,7 +1212,14 @@ static int init_tables(void)
 #ifdef SAVE_SAMPLE
 	sample[0]=fopen("sampsum.pcm","wb");
 #endif
+}
+
+/* tables are built when first chip is created, then shared by all chips */
+static int tables_built = 0;
 
+static int init_tables(void)
+{
+	mame_init_once( &tables_built, build_tables );
 	return 1;
 }
 
@@ -2106,3 +2113,19 @@ void ym2413_set_mask(void *_chip, UINT32 mask)
 
 	chip->mask = mask;
 }
+
+int ym2413_state_size(void)
+{
+	return sizeof(YM2413);
+}
+
+int ym2413_state_ptrs(void *_chip, int *offsets)
+{
+	YM2413 *chip = (YM2413 *)_chip;
+
+	offsets[0] = (int)((char *)&chip->SLOT7_1 - (char *)chip);
+	offsets[1] = (int)((char *)&chip->SLOT7_2 - (char *)chip);
+	offsets[2] = (int)((char *)&chip->SLOT8_1 - (char *)chip);
+	offsets[3] = (int)((char *)&chip->SLOT8_2 - (char *)chip);
+	return 4;
+}
@@ -39,6 +39,15 @@ void * ym2413_get_inst0(void *chip);
 
 void ym2413_set_mask(void *chip, UINT32 mask);
 
+/* size of the block returned by ym2413_init(); it can be copied to save state */
+int ym2413_state_size(void);
+
+/* byte offsets of pointers within that block, in increasing order, so they can
+be relocated when state is loaded into another chip; returns count, at most
+YM2413_STATE_PTRS */
+#define YM2413_STATE_PTRS 4
+int ym2413_state_ptrs(void *chip, int *offsets);
+
 typedef void (*OPLL_UPDATEHANDLER)(void *param,int min_interval_us);
 
 void ym2413_set_update_handler(void *chip, OPLL_UPDATEHANDLER UpdateHandler, void *param);
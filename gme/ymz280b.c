@@ -131,7 +131,7 @@ static const int index_scale[8] = { 0x0e6, 0x0e6, 0x0e6, 0x0e6, 0x133, 0x199, 0x
 
 /* lookup table for the precomputed difference */
 static int diff_lookup[16];
-static unsigned char lookup_init = 0x00;	/* lookup-table is initialized */
+static int lookup_init = 0;	/* lookup-table is initialized */
 
 /* timer callback */
 /*static TIMER_CALLBACK( update_irq_state_timer_0 );
@@ -272,21 +272,21 @@ static TIMER_CALLBACK( update_irq_state_timer_7 ) { update_irq_state_timer_commo
 
 ***********************************************************************************************/
 
-static void compute_tables(void)
+static void build_tables(void)
 {
 	int nib;
 
-	if (lookup_init)
-		return;
-
 	/* loop over all nibbles and compute the difference */
 	for (nib = 0; nib < 16; nib++)
 	{
 		int value = (nib & 0x07) * 2 + 1;
 		diff_lookup[nib] = (nib & 0x08) ? -value : value;
 	}
-	
-	lookup_init = 0x01;
+}
+
+static void compute_tables(void)
+{
+	mame_init_once( &lookup_init, build_tables );
 }
 
 
@@ -1301,3 +1301,21 @@ void ymz280b_set_mute_mask(void *_chip, UINT32 MuteMask)
 	
 	return;
 }
+
+int ymz280b_state_size(void)
+{
+	return sizeof(ymz280b_state);
+}
+
+int ymz280b_state_kept(void *_chip, int *offsets)
+{
+	ymz280b_state *chip = (ymz280b_state *) _chip;
+	int n = 0;
+	
+	offsets[n++] = (int)((char *)&chip->region_base - (char *)chip);
+#if MAKE_WAVS
+	offsets[n++] = (int)((char *)&chip->wavresample - (char *)chip);
+#endif
+	offsets[n++] = (int)((char *)&chip->scratch - (char *)chip);
+	return n;
+}
@@ -42,6 +42,16 @@ void ymz280b_write_rom(void *, offs_t ROMSize, offs_t DataStart, offs_t DataLeng
 
 void ymz280b_set_mute_mask(void *, UINT32 MuteMask);
 
+/* size of the block returned by device_start_ymz280b(); it can be copied to
+save state */
+int ymz280b_state_size(void);
+
+/* byte offsets of pointers within that block to memory the chip allocated, in
+increasing order, which are kept when state is loaded into another chip;
+returns count, at most YMZ280B_STATE_KEPT */
+#define YMZ280B_STATE_KEPT 3
+int ymz280b_state_kept(void *chip, int *offsets);
+
 #ifdef __cplusplus
 }
 #endif
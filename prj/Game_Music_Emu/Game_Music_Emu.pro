@@ -34,10 +34,12 @@ SOURCES += \
     ../../gme/Ym2203_Emu.cpp \
     ../../gme/ym2151.c \
     ../../gme/Ym2151_Emu.cpp \
+    ../../gme/Voice_Buffer.cpp \
     ../../gme/Vgm_Emu.cpp \
     ../../gme/Vgm_Core.cpp \
     ../../gme/Upsampler.cpp \
     ../../gme/Track_Filter.cpp \
+    ../../gme/State_Copier.cpp \
     ../../gme/Spc_Filter.cpp \
     ../../gme/Spc_Emu.cpp \
     ../../gme/Sms_Fm_Apu.cpp \
@@ -103,6 +105,7 @@ SOURCES += \
     ../../gme/Gym_Emu.cpp \
     ../../gme/gme.cpp \
     ../../gme/Gme_Loader.cpp \
+    ../../gme/Gme_Profiler.cpp \
     ../../gme/Gme_File.cpp \
     ../../gme/Gbs_Emu.cpp \
     ../../gme/Gbs_Cpu.cpp \
@@ -118,10 +121,12 @@ SOURCES += \
     ../../gme/Dual_Resampler.cpp \
     ../../gme/Downsampler.cpp \
     ../../gme/dbopl.cpp \
+    ../../gme/mamedef.cpp \
     ../../gme/dac_control.c \
     ../../gme/Classic_Emu.cpp \
     ../../gme/c140.c \
     ../../gme/C140_Emu.cpp \
+    ../../gme/Chip_Resampler.cpp \
     ../../gme/Blip_Buffer.cpp \
     ../../gme/blargg_errors.cpp \
     ../../gme/blargg_common.cpp \
@@ -154,10 +159,12 @@ HEADERS += \
     ../../gme/Ym2203_Emu.h \
     ../../gme/ym2151.h \
     ../../gme/Ym2151_Emu.h \
+    ../../gme/Voice_Buffer.h \
     ../../gme/Vgm_Emu.h \
     ../../gme/Vgm_Core.h \
     ../../gme/Upsampler.h \
     ../../gme/Track_Filter.h \
+    ../../gme/State_Copier.h \
     ../../gme/Spc_Filter.h \
     ../../gme/Spc_Emu.h \
     ../../gme/Sms_Fm_Apu.h \
@@ -228,6 +235,7 @@ HEADERS += \
     ../../gme/Gym_Emu.h \
     ../../gme/gme.h \
     ../../gme/Gme_Loader.h \
+    ../../gme/Gme_Profiler.h \
     ../../gme/Gme_File.h \
     ../../gme/Gbs_Emu.h \
     ../../gme/Gbs_Core.h \
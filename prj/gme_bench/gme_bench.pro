@@ -0,0 +1,27 @@
+#-------------------------------------------------
+#
+# Benchmark and output hash checker. Build Game_Music_Emu first, with the
+# same DEFINES, e.g. qmake "DEFINES += BLIP_BUFFER_FAST=1" for both.
+#
+#-------------------------------------------------
+
+QT       -= core gui
+
+TARGET = gme_bench
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+QMAKE_CXXFLAGS += -std=c++11
+macx:QMAKE_CXXFLAGS += -mmacosx-version-min=10.7 -stdlib=libc++
+
+DEFINES += NDEBUG HAVE_STDINT_H HAVE_ZLIB_H
+
+INCLUDEPATH += ../../gme ../../../File_Extractor/fex
+
+SOURCES += \
+    ../../bench/gme_bench.cpp
+
+LIBS += -L$$OUT_PWD/../Game_Music_Emu -lGame_Music_Emu -lz
+win32:LIBS += -lpsapi
+PRE_TARGETDEPS += $$OUT_PWD/../Game_Music_Emu/libGame_Music_Emu.a